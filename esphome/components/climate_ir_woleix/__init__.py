@@ -2,8 +2,19 @@
 
 import esphome.codegen as cg
 import esphome.config_validation as cv
+import esphome.final_validate as fv
 from esphome.components import climate_ir, sensor
-from esphome.const import CONF_ID, CONF_HUMIDITY_SENSOR
+from esphome.components.remote_base import CONF_TRANSMITTER_ID
+from esphome.const import (
+    CONF_ID,
+    CONF_HUMIDITY_SENSOR,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_MILLISECOND,
+    UNIT_SECOND,
+)
+from esphome.core import CORE
 
 # Component metadata
 CODEOWNERS = ["@ok11"]
@@ -13,14 +24,178 @@ AUTO_LOAD = []
 # C++ namespace and class reference
 climate_ir_woleix_ns = cg.esphome_ns.namespace("climate_ir_woleix")
 WoleixClimate = climate_ir_woleix_ns.class_("WoleixClimate", climate_ir.ClimateIR)
+WoleixPlanning = climate_ir_woleix_ns.enum("WoleixPlanning", is_class=True)
+WoleixMetric = climate_ir_woleix_ns.enum("WoleixMetric", is_class=True)
+WoleixReading = climate_ir_woleix_ns.enum("WoleixReading", is_class=True)
+
+# Command planning strategies
+CONF_PLANNING = "planning"
+CONF_SHORTEST_PATH_PLANNING = "shortest_path_planning"
+CONF_MAX_BURST_PRESSES = "max_burst_presses"
+CONF_SPECULATIVE_SETTING_MODE = "speculative_setting_mode"
+CONF_WAIT_FOR_TRANSMIT_COMPLETE = "wait_for_transmit_complete"
+CONF_EXECUTOR = "executor"
+EXECUTOR_OPTIONS = ["main_loop", "dedicated"]
+CONF_NON_BLOCKING = "non_blocking"
+CONF_PROTOCOL_HANDLER = "protocol_handler"
+PROTOCOL_HANDLER_OPTIONS = ["callbacks", "coroutine"]
+PLANNING_OPTIONS = {
+    "queued": WoleixPlanning.QUEUED,
+    "just_in_time": WoleixPlanning.JUST_IN_TIME,
+}
+
+# Protocol timing profile, compiled into the firmware as defines
+CONF_TIMING = "timing"
+CONF_SETTING_MODE_TIMEOUT = "setting_mode_timeout"
+CONF_SETTING_MODE_ENTER_DELAY = "setting_mode_enter_delay"
+CONF_COMMAND_GAP = "command_gap"
+CONF_COMMAND_GAPS = "command_gaps"
+COMMAND_GAP_DEFINES = {
+    "power": "WOLEIX_POWER_GAP_MS",
+    "mode": "WOLEIX_MODE_GAP_MS",
+    "temp_up": "WOLEIX_TEMP_UP_GAP_MS",
+    "temp_down": "WOLEIX_TEMP_DOWN_GAP_MS",
+    "fan_speed": "WOLEIX_FAN_SPEED_GAP_MS",
+}
+# Gaps are measured from the start of a frame, so they cannot be shorter than the frame
+NEC_FRAME_DURATION = cv.TimePeriod(milliseconds=68)
+validate_command_gap = cv.All(
+    cv.positive_time_period_milliseconds, cv.Range(min=NEC_FRAME_DURATION)
+)
+
+
+def validate_timing(config):
+    if config[CONF_SETTING_MODE_ENTER_DELAY] >= config[CONF_SETTING_MODE_TIMEOUT]:
+        raise cv.Invalid(
+            f"{CONF_SETTING_MODE_ENTER_DELAY} must be shorter than {CONF_SETTING_MODE_TIMEOUT}"
+        )
+    return config
+
+
+TIMING_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Optional(CONF_SETTING_MODE_TIMEOUT, default="5000ms"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_SETTING_MODE_ENTER_DELAY, default="150ms"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_COMMAND_GAP, default="200ms"): validate_command_gap,
+            cv.Optional(CONF_COMMAND_GAPS, default={}): cv.Schema(
+                {cv.Optional(name): validate_command_gap for name in COMMAND_GAP_DEFINES}
+            ),
+        }
+    ),
+    validate_timing,
+)
+
+# Debouncing of state changes, e.g. while a thermostat slider is dragged
+CONF_DEBOUNCE = "debounce"
+CONF_WINDOW = "window"
+CONF_MAX_LATENCY = "max_latency"
+
+
+def validate_debounce(config):
+    if config[CONF_MAX_LATENCY] < config[CONF_WINDOW]:
+        raise cv.Invalid(f"{CONF_MAX_LATENCY} must not be shorter than {CONF_WINDOW}")
+    return config
+
+
+DEBOUNCE_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Optional(CONF_WINDOW, default="300ms"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_MAX_LATENCY, default="1s"): cv.positive_time_period_milliseconds,
+        }
+    ),
+    validate_debounce,
+)
+
+# Publishing policy for current temperature and humidity readings
+CONF_READING_PUBLISHING = "reading_publishing"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_TEMPERATURE_DELTA = "temperature_delta"
+CONF_HUMIDITY_DELTA = "humidity_delta"
+CONF_MAX_STALENESS = "max_staleness"
+
+READING_PUBLISHING_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_MIN_INTERVAL, default="10s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_TEMPERATURE_DELTA, default=0.1): cv.positive_float,
+        cv.Optional(CONF_HUMIDITY_DELTA, default=1.0): cv.positive_float,
+        cv.Optional(CONF_MAX_STALENESS, default="5min"): cv.positive_time_period_milliseconds,
+    }
+)
+
+# Pipeline metrics, each one an optional sensor published every metrics_update_interval
+CONF_METRICS_UPDATE_INTERVAL = "metrics_update_interval"
+UNIT_COMMANDS_PER_MINUTE = "cmd/min"
+METRICS_SENSORS = {
+    "queue_depth": (WoleixMetric.QUEUE_DEPTH, STATE_CLASS_MEASUREMENT, None),
+    "peak_queue_depth": (WoleixMetric.PEAK_QUEUE_DEPTH, STATE_CLASS_MEASUREMENT, None),
+    "commands_per_minute": (WoleixMetric.COMMANDS_PER_MINUTE, STATE_CLASS_MEASUREMENT, UNIT_COMMANDS_PER_MINUTE),
+    "rejected_plans": (WoleixMetric.REJECTED_PLANS, STATE_CLASS_TOTAL_INCREASING, None),
+    "setting_mode_entries": (WoleixMetric.SETTING_MODE_ENTRIES, STATE_CLASS_TOTAL_INCREASING, None),
+    "setting_mode_reuses": (WoleixMetric.SETTING_MODE_REUSES, STATE_CLASS_TOTAL_INCREASING, None),
+    "airtime": (WoleixMetric.AIRTIME, STATE_CLASS_TOTAL_INCREASING, UNIT_SECOND),
+    "latency_p50": (WoleixMetric.LATENCY_P50, STATE_CLASS_MEASUREMENT, UNIT_MILLISECOND),
+    "latency_p95": (WoleixMetric.LATENCY_P95, STATE_CLASS_MEASUREMENT, UNIT_MILLISECOND),
+    "latency_max": (WoleixMetric.LATENCY_MAX, STATE_CLASS_MEASUREMENT, UNIT_MILLISECOND),
+}
+
+
+def metrics_sensor_schema(state_class, unit):
+    options = {
+        "accuracy_decimals": 0,
+        "state_class": state_class,
+        "entity_category": ENTITY_CATEGORY_DIAGNOSTIC,
+    }
+    if unit is not None:
+        options["unit_of_measurement"] = unit
+    return sensor.sensor_schema(**options)
+
+
+METRICS_SCHEMA = {
+    cv.Optional(name): metrics_sensor_schema(state_class, unit)
+    for name, (_, state_class, unit) in METRICS_SENSORS.items()
+}
 
 # Configuration schema - extends climate_ir's schema with humidity sensor support
 CONFIG_SCHEMA = climate_ir.climate_ir_with_receiver_schema(WoleixClimate).extend(
     {
         cv.Optional(CONF_HUMIDITY_SENSOR): cv.use_id(sensor.Sensor),
+        cv.Optional(CONF_PLANNING, default="queued"): cv.enum(PLANNING_OPTIONS, lower=True),
+        cv.Optional(CONF_SHORTEST_PATH_PLANNING, default=False): cv.boolean,
+        cv.Optional(CONF_MAX_BURST_PRESSES, default=1): cv.int_range(min=1, max=16),
+        cv.Optional(CONF_SPECULATIVE_SETTING_MODE, default=False): cv.boolean,
+        cv.Optional(CONF_WAIT_FOR_TRANSMIT_COMPLETE, default=False): cv.boolean,
+        cv.Optional(CONF_EXECUTOR, default="main_loop"): cv.one_of(*EXECUTOR_OPTIONS, lower=True),
+        cv.Optional(CONF_PROTOCOL_HANDLER, default="callbacks"): cv.one_of(*PROTOCOL_HANDLER_OPTIONS, lower=True),
+        cv.Optional(CONF_TIMING): TIMING_SCHEMA,
+        cv.Optional(CONF_DEBOUNCE): DEBOUNCE_SCHEMA,
+        cv.Optional(CONF_READING_PUBLISHING): READING_PUBLISHING_SCHEMA,
+        cv.Optional(CONF_METRICS_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        **METRICS_SCHEMA,
     }
 )
 
+
+def final_validate_executor(config):
+    """The dedicated executor transmits from its own task, with the main loop waiting on it."""
+    if config[CONF_EXECUTOR] != "dedicated":
+        return config
+    if not CORE.is_esp32:
+        raise cv.Invalid(f"{CONF_EXECUTOR}: dedicated is only available on ESP32")
+    full_config = fv.full_config.get()
+    path = full_config.get_path_for_id(config[CONF_TRANSMITTER_ID])[:-1]
+    transmitter = full_config.get_config_for_path(path)
+    if not transmitter.get(CONF_NON_BLOCKING, False):
+        raise cv.Invalid(
+            f"{CONF_EXECUTOR}: dedicated requires the remote_transmitter to set {CONF_NON_BLOCKING}: true"
+        )
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = final_validate_executor
+
+
 # Code generation function
 async def to_code(config):
     """Generate code for Woleix climate component."""
@@ -31,3 +206,34 @@ async def to_code(config):
     if humidity_sensor_id := config.get(CONF_HUMIDITY_SENSOR):
         humidity_sens = await cg.get_variable(humidity_sensor_id)
         cg.add(var.set_humidity_sensor(humidity_sens))
+
+    cg.add(var.set_planning(config[CONF_PLANNING]))
+    cg.add(var.set_shortest_path_planning(config[CONF_SHORTEST_PATH_PLANNING]))
+    cg.add(var.set_max_burst_presses(config[CONF_MAX_BURST_PRESSES]))
+    cg.add(var.set_speculative_setting_mode(config[CONF_SPECULATIVE_SETTING_MODE]))
+    cg.add(var.set_wait_for_transmit_complete(config[CONF_WAIT_FOR_TRANSMIT_COMPLETE]))
+    cg.add(var.set_dedicated_executor(config[CONF_EXECUTOR] == "dedicated"))
+    if config[CONF_PROTOCOL_HANDLER] == "coroutine":
+        cg.add_define("USE_WOLEIX_COROUTINE_HANDLER")
+
+    if debounce := config.get(CONF_DEBOUNCE):
+        cg.add(var.set_debounce(debounce[CONF_WINDOW], debounce[CONF_MAX_LATENCY]))
+
+    if publishing := config.get(CONF_READING_PUBLISHING):
+        cg.add(var.set_reading_publishing(publishing[CONF_MIN_INTERVAL], publishing[CONF_MAX_STALENESS]))
+        cg.add(var.set_reading_delta(WoleixReading.CURRENT_TEMPERATURE, publishing[CONF_TEMPERATURE_DELTA]))
+        cg.add(var.set_reading_delta(WoleixReading.CURRENT_HUMIDITY, publishing[CONF_HUMIDITY_DELTA]))
+
+    for name, (metric, _, _) in METRICS_SENSORS.items():
+        if name in config:
+            sens = await sensor.new_sensor(config[name])
+            cg.add(var.set_metrics_sensor(metric, sens))
+    cg.add(var.set_metrics_update_interval(config[CONF_METRICS_UPDATE_INTERVAL]))
+
+    if timing := config.get(CONF_TIMING):
+        cg.add_define("WOLEIX_SETTING_MODE_TIMEOUT_MS", timing[CONF_SETTING_MODE_TIMEOUT].total_milliseconds)
+        cg.add_define("WOLEIX_SETTING_MODE_ENTER_DELAY_MS", timing[CONF_SETTING_MODE_ENTER_DELAY].total_milliseconds)
+        cg.add_define("WOLEIX_INTER_COMMAND_DELAY_MS", timing[CONF_COMMAND_GAP].total_milliseconds)
+        for name, define in COMMAND_GAP_DEFINES.items():
+            if name in timing[CONF_COMMAND_GAPS]:
+                cg.add_define(define, timing[CONF_COMMAND_GAPS][name].total_milliseconds)
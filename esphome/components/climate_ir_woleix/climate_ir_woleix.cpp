@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <memory>
 
 #include "esphome/core/log.h"
@@ -22,28 +24,33 @@ using esphome::climate::ClimateTraits;
  * 
  * Initializes the climate controller with the Woleix-specific temperature range,
  * creates a command queue, and sets up the state manager and protocol handler.
- * It also registers itself as a producer for the command queue and resets the state.
+ * It also registers itself as a producer for the command queue and as the
+ * observer of the status bus, and resets the state.
  */
 WoleixClimate::WoleixClimate()
   : ClimateIR(WOLEIX_TEMP_MIN, WOLEIX_TEMP_MAX),
-    command_queue_(std::make_unique<WoleixCommandQueue>(QUEUE_MAX_CAPACITY)),
     WoleixStateManager(),
-    WoleixProtocolHandler
-    (
-        [this](const std::string& name, uint32_t delay_ms, std::function<void()> callback)
-        {
-            this->set_timeout(name, delay_ms, std::move(callback));
-        },
-        [this](const std::string& name)
-        {
-            this->cancel_timeout(name);
-        }
-    )
+    WoleixHandler(this)
 {
-    command_queue_->register_producer(this);
+    command_queue_.register_producer(this);
+
+    // Both reporters publish on the component's status bus, observed by the component itself
+    WoleixStateManager::set_status_bus(&status_bus_);
+    WoleixHandler::set_status_bus(&status_bus_);
+    status_bus_.subscribe(this);
+
     reset_state();
 }
 
+/**
+ * @brief Destroy the WoleixClimate object.
+ */
+WoleixClimate::~WoleixClimate()
+{
+    executor_.stop();
+    WoleixHandler::set_scheduler(this);
+}
+
 /**
  * Reset the state manager to default values.
  * 
@@ -57,10 +64,12 @@ WoleixClimate::WoleixClimate()
  */
 void WoleixClimate::reset_state()
 {
-    command_queue_->reset();
+    auto lock = lock_protocol_();
+    command_queue_.reset();
 
     WoleixStateManager::reset();
-    WoleixProtocolHandler::reset();
+    WoleixHandler::reset();
+    target_mailbox_.reset(current_state_);
     
     target_temperature = WOLEIX_TEMP_DEFAULT;
     mode = climate::CLIMATE_MODE_OFF;
@@ -71,23 +80,59 @@ void WoleixClimate::reset_state()
  * Setup method called once during initialization.
  * 
  * Logs component version, calls parent ClimateIR::setup(), and initializes
- * the humidity sensor callback if configured. This allows the climate
- * controller to track and publish current humidity levels.
+ * the temperature and humidity sensor callbacks. This allows the climate
+ * controller to track and publish current temperature and humidity levels.
+ * 
+ * The temperature sensor is taken over from ClimateIR before its setup runs,
+ * so that both readings go through the same publishing policy instead of
+ * ClimateIR publishing the whole state on every temperature reading.
  */
 void WoleixClimate::setup()
 {
     // Print out current version
     ESP_LOGI(TAG, "Version: %s", VERSION);
 
-    // Call parent setup first
+    // Take over the temperature sensor, then call parent setup
+    temperature_sensor_ = sensor_;
+    sensor_ = nullptr;
     ClimateIR::setup();
 
-    WoleixStateManager::setup();
-    WoleixProtocolHandler::setup(command_queue_.get());
+    // Move the protocol timers off the main loop, if requested
+    if (dedicated_executor_)
+    {
+        if (executor_.start())
+        {
+            WoleixHandler::set_scheduler(&executor_);
+        }
+        else
+        {
+            ESP_LOGW(TAG, "Dedicated executor unavailable, running on the main loop");
+            dedicated_executor_ = false;
+        }
+    }
 
-    WoleixStateManager::register_observer(this);
-    WoleixProtocolHandler::register_observer(this);
+    auto lock = lock_protocol_();
+    WoleixStateManager::setup();
+    target_mailbox_.reset(current_state_);
+    WoleixHandler::setup(command_source_());
     
+    // Set up callback to update the current temperature from sensor
+    if (temperature_sensor_ != nullptr)
+    {
+        temperature_sensor_->add_on_state_callback([this](float state)
+        {
+            if (!std::isnan(state))
+            {
+                on_reading_(WoleixReading::CURRENT_TEMPERATURE, state);
+            }
+            else
+            {
+                ESP_LOGW(TAG, "Received NaN temperature reading");
+            }
+        });
+        current_temperature = temperature_sensor_->state;
+    }
+
     // Set up callback to update humidity from sensor
     if (humidity_sensor_ != nullptr)
     {
@@ -95,8 +140,7 @@ void WoleixClimate::setup()
         {
             if (!std::isnan(state))
             {
-                current_humidity = state;
-                publish_state();
+                on_reading_(WoleixReading::CURRENT_HUMIDITY, state);
                 ESP_LOGD(TAG, "Updated humidity: %.1f%%", state);
             }
             else
@@ -105,6 +149,39 @@ void WoleixClimate::setup()
             }
         });
     }
+
+    // Publish the metrics sensors in batches, if any is configured
+    if (std::any_of(metrics_sensors_.begin(), metrics_sensors_.end(), [](sensor::Sensor* s) { return s != nullptr; }))
+    {
+        schedule_timer(WoleixTimerId::METRICS, metrics_update_interval_ms_, [this]() { publish_metrics_(); });
+    }
+}
+
+/**
+ * Main loop hook.
+ * 
+ * Sets the error and warning states raised on the dedicated executor's
+ * task since the previous iteration.
+ */
+void WoleixClimate::loop()
+{
+    if (status_error_raised_.exchange(false)) status_set_error();
+    if (status_warning_raised_.exchange(false)) status_set_warning();
+}
+
+/**
+ * Map the requested ESPHome climate state to a Woleix target state.
+ * 
+ * @return Target state for the state manager
+ */
+WoleixInternalState WoleixClimate::target_state_() const
+{
+    WoleixInternalState target_state;
+    target_state.power = StateMapper::esphome_to_woleix_power(mode != ClimateMode::CLIMATE_MODE_OFF);
+    target_state.mode = StateMapper::esphome_to_woleix_mode(mode);
+    target_state.fan_speed = StateMapper::esphome_to_woleix_fan_mode(fan_mode.value());
+    target_state.temperature = target_temperature;
+    return target_state;
 }
 
 /**
@@ -113,21 +190,205 @@ void WoleixClimate::setup()
  * Converts ESPHome climate states to Woleix-specific states using StateMapper,
  * then uses the state manager to generate the optimal command sequence.
  * 
+ * A new target replaces the pending plan rather than being appended to it:
+ * the target is planned from the state transmitted so far (see
+ * rebase_on_transmitted_()), and the pending normal-priority commands are
+ * dropped when the new plan is committed, so presses undone by the new
+ * target (e.g. 24 -> 26 -> 24) are never transmitted. High-priority commands
+ * (turning the unit off) are queued ahead of everything else.
+ * 
+ * The state manager emits the commands directly into free queue slots, which
+ * are published in one step once the plan is complete; a plan that does not
+ * fit is rejected as a whole and leaves both the queue, pending plan
+ * included, and the planned state untouched. The room of the pending plan
+ * counts as free, see WoleixCommandQueue::Plan.
+ * 
+ * With just-in-time planning the commands are not queued at all: the resolved
+ * target state replaces whatever the target mailbox held before.
+ * 
+ * Either way, the plan is timed until its last frame goes out, see time_plan_().
+ * 
  * @return Reference to vector of commands needed for the state transition
  */
 bool WoleixClimate::enqueue_commands_()
 {
-    WoleixInternalState target_state;
     // Map ESPHome Climate states to Woleix AC states
-    target_state.power = StateMapper::esphome_to_woleix_power(mode != ClimateMode::CLIMATE_MODE_OFF);
-    target_state.mode = StateMapper::esphome_to_woleix_mode(mode);
-    target_state.fan_speed = StateMapper::esphome_to_woleix_fan_mode(fan_mode.value());
-    target_state.temperature = target_temperature;
-    
-    // Generate command sequence via state manager
-    const std::vector<WoleixCommand>& commands = WoleixStateManager::move_to(target_state);
+    WoleixInternalState target_state = target_state_();
+
+    if (planning_ == WoleixPlanning::JUST_IN_TIME)
+    {
+        // Only the resolved target matters, the protocol handler plans the way there
+        if (!WoleixStateManager::move_to(target_state).empty()) time_plan_();
+        target_mailbox_.post(current_state_);
+        return true;
+    }
+
+    // Plan from the transmitted state; the pending plan is only dropped once the new one is committed
+    const WoleixInternalState planned = current_state_;
+    size_t replaced = rebase_on_transmitted_();
+    const WoleixInternalState rebased = current_state_;
+
+    // Generate the command sequence straight into the queue, committed as a whole
+    auto plan = command_queue_.begin_plan(replaced > 0);
+    replacing_plan_ = replaced > 0;
+    bool accepted = WoleixStateManager::move_to(target_state, plan);
+    replacing_plan_ = false;
+    if (!accepted)
+    {
+        // The pending plan stays queued, and so does the state it leads to, unless it made room for this one
+        current_state_ = plan.dropped() > 0 ? rebased : planned;
+        metrics_.record_rejected_plan();
+        return false;
+    }
+
+    if (replaced > 0)
+    {
+        ESP_LOGD(TAG, "Replaced %zu pending commands, re-planned from the transmitted state", replaced);
+    }
+    metrics_.record_queue_depth(command_queue_.length());
+    if (plan.size() > 0 && !command_queue_.is_empty()) time_plan_();
+    return true;
+}
+
+/**
+ * Start timing a plan.
+ * 
+ * The latency runs from the request behind the plan, i.e. the first
+ * transmit_state() of a debounced burst, until the last frame of the plan is
+ * sent, which is known once the protocol handler runs out of commands. So
+ * the debounce delay is part of it. A plan replaced by a newer one before
+ * completion is not recorded: its target was never reached, and the clock
+ * restarts for the new target.
+ */
+void WoleixClimate::time_plan_()
+{
+    plan_requested_ms_ = change_requested_ms_;
+    set_on_complete_([this]()
+    {
+        uint32_t latency_ms = last_frame_ms_() - plan_requested_ms_;
+        // Nothing was sent for this plan if the last frame predates it
+        if (static_cast<int32_t>(latency_ms) >= 0) metrics_.record_plan_latency(latency_ms);
+    });
+}
+
+/**
+ * Rebase the planned state on the transmitted state, ahead of replacing the pending plan.
+ * 
+ * Normal-priority commands still in the queue were never transmitted, so the
+ * planned state becomes the transmitted state, plus the high-priority
+ * commands, which stay queued. The next move_to() then plans straight from
+ * where the AC unit actually is, instead of detouring via a target that is
+ * no longer wanted. The queue itself is left alone: the caller drops the
+ * normal-priority commands once their replacement is in place.
+ * 
+ * @return Number of normal-priority commands pending; 0 if nothing was rebased
+ */
+size_t WoleixClimate::rebase_on_transmitted_()
+{
+    size_t pending = 0;
+    for (size_t i = 0; i < command_queue_.length(); i++)
+    {
+        if (command_queue_.at(i).get_priority() == WoleixCommand::Priority::NORMAL) pending++;
+    }
+    if (pending == 0) return 0;
+
+    WoleixStateManager::rebase_on_transmitted();
+    for (size_t i = 0; i < command_queue_.length(); i++)
+    {
+        const WoleixCommand command = command_queue_.at(i);
+        if (command.get_priority() == WoleixCommand::Priority::HIGH) WoleixStateManager::replay_pending(command);
+    }
+    return pending;
+}
+
+/**
+ * Drop the pending plan and continue from the transmitted state.
+ * 
+ * High-priority commands stay queued, see rebase_on_transmitted_().
+ */
+void WoleixClimate::replan_from_transmitted_()
+{
+    if (rebase_on_transmitted_() == 0) return;
+
+    size_t dropped = command_queue_.preempt();
+    ESP_LOGD(TAG, "Dropped %zu pending commands, re-planning from the transmitted state", dropped);
+}
+
+/**
+ * Publish the metrics sensors.
+ * 
+ * Takes one snapshot of the counters and feeds every configured sensor from
+ * it, so the hot path never calls into the sensors. The command rate is the
+ * number of frames sent since the previous publication, scaled to a minute.
+ * Reschedules itself every metrics update interval.
+ */
+void WoleixClimate::publish_metrics_()
+{
+    auto lock = lock_protocol_();
+    WoleixMetricsSnapshot snapshot = metrics_.snapshot();
+    float values[WOLEIX_METRIC_COUNT] =
+    {
+        static_cast<float>(snapshot.queue_depth),
+        static_cast<float>(snapshot.peak_queue_depth),
+        WoleixMetrics::per_minute(snapshot.commands_transmitted - last_commands_transmitted_, metrics_update_interval_ms_),
+        static_cast<float>(snapshot.rejected_plans),
+        static_cast<float>(snapshot.setting_mode_entries),
+        static_cast<float>(snapshot.setting_mode_reuses),
+        static_cast<float>(snapshot.airtime_ms) / 1000.0f,
+        static_cast<float>(snapshot.plan_latency_p50_ms),
+        static_cast<float>(snapshot.plan_latency_p95_ms),
+        static_cast<float>(snapshot.plan_latency_max_ms)
+    };
+    last_commands_transmitted_ = snapshot.commands_transmitted;
+
+    for (size_t i = 0; i < WOLEIX_METRIC_COUNT; i++)
+    {
+        if (metrics_sensors_[i] != nullptr) metrics_sensors_[i]->publish_state(values[i]);
+    }
+
+    schedule_timer(WoleixTimerId::METRICS, metrics_update_interval_ms_, [this]() { publish_metrics_(); });
+}
+
+/**
+ * Apply a sensor reading.
+ * 
+ * The value is stored right away, so any publication includes it, but the
+ * climate state is only published when the reading throttle says so: now,
+ * or at the end of the minimum interval, together with whatever other
+ * readings arrive until then.
+ */
+void WoleixClimate::on_reading_(WoleixReading reading, float value)
+{
+    if (reading == WoleixReading::CURRENT_TEMPERATURE)
+    {
+        current_temperature = value;
+    }
+    else
+    {
+        current_humidity = value;
+    }
 
-    return command_queue_->enqueue(commands);
+    auto delay_ms = reading_throttle_.offer(reading, value, now_ms());
+    if (!delay_ms.has_value()) return;
+
+    if (*delay_ms == 0)
+    {
+        publish_readings_();
+    }
+    else
+    {
+        schedule_timer(WoleixTimerId::READINGS, *delay_ms, [this]() { publish_readings_(); });
+    }
+}
+
+/**
+ * Publish the climate state for the pending sensor readings.
+ */
+void WoleixClimate::publish_readings_()
+{
+    cancel_timer(WoleixTimerId::READINGS);
+    reading_throttle_.published(now_ms());
+    publish_state();
 }
 
 /**
@@ -151,26 +412,78 @@ void WoleixClimate::update_state_()
 /**
  * Transmit the current state via IR.
  * 
- * Called by ESPHome when the climate state changes. This method:
+ * Called by ESPHome when the climate state changes. With debouncing enabled,
+ * planning is deferred until the burst of state changes is over: every call
+ * restarts the debounce window, up to the maximum latency counted from the
+ * first call of the burst. Meanwhile, the optimistic publish_state() done by
+ * ClimateIR::control() keeps showing the requested state.
+ * 
+ * Turning the unit off is planned right away, dropping any pending burst.
+ */
+void WoleixClimate::transmit_state()
+{
+    if (debounce_window_ms_ == 0 || priority_of(target_state_()) == WoleixCommand::Priority::HIGH)
+    {
+        if (debounce_pending_)
+        {
+            cancel_timer(WoleixTimerId::DEBOUNCE);
+            debounce_pending_ = false;
+        }
+        change_requested_ms_ = clock_ms_();
+        transmit_state_now_();
+        return;
+    }
+
+    uint32_t now = now_ms();
+    if (!debounce_pending_)
+    {
+        debounce_pending_ = true;
+        debounce_started_ms_ = now;
+        change_requested_ms_ = clock_ms_();
+    }
+
+    uint32_t elapsed = now - debounce_started_ms_;
+    if (elapsed >= debounce_max_latency_ms_)
+    {
+        flush_debounced_state_();
+        return;
+    }
+
+    ESP_LOGD(TAG, "Debouncing state change (%" PRIu32 " ms into the burst)", elapsed);
+    uint32_t delay_ms = std::min(debounce_window_ms_, debounce_max_latency_ms_ - elapsed);
+    schedule_timer(WoleixTimerId::DEBOUNCE, delay_ms, [this]() { flush_debounced_state_(); });
+}
+
+/**
+ * Plan the final target of a debounced burst.
+ * 
+ * The planned state may differ from the requested one (rounding, clamping),
+ * so it is published once more.
+ */
+void WoleixClimate::flush_debounced_state_()
+{
+    auto lock = lock_protocol_();
+    cancel_timer(WoleixTimerId::DEBOUNCE);
+    debounce_pending_ = false;
+    transmit_state_now_();
+    publish_state();
+}
+
+/**
+ * Plan and enqueue the current state.
+ * 
+ * This method:
  * 1. Calculates the necessary commands to reach the target state
  * 2. Transmits those commands via IR
  * 3. Updates internal state to match the new state
  * 
  * If no commands are needed (already at target state), no transmission occurs.
  */
-void WoleixClimate::transmit_state()
+void WoleixClimate::transmit_state_now_()
 {
-    if (on_hold_)
+    if (on_hold_ && priority_of(target_state_()) != WoleixCommand::Priority::HIGH)
     {
-        report_status
-        (
-            WoleixStatus
-            (
-                WoleixStatus::Severity::WX_SEVERITY_WARNING,
-                WoleixCategory::Core::WX_CATEGORY_ENQUEING_ON_HOLD,
-                "Transmission on hold due to nearly full command queue"
-            )
-        );
+        report_status(WoleixStatus(WoleixMessages::Core::WX_MESSAGE_ENQUEING_ON_HOLD));
     }
     else
     {
@@ -178,15 +491,7 @@ void WoleixClimate::transmit_state()
             static_cast<int>(mode), target_temperature, static_cast<int>(fan_mode.value()));
 
         if (!enqueue_commands_())
-            report_status
-            (
-                WoleixStatus
-                (
-                    WoleixStatus::Severity::WX_SEVERITY_ERROR,
-                    WoleixCategory::Core::WX_CATEGORY_ENQUEING_FAILED,
-                    "Transmission failed due to full command queue"
-                )
-            );
+            report_status(WoleixStatus(WoleixMessages::Core::WX_MESSAGE_ENQUEING_FAILED));
     }
     ESP_LOGD(TAG, "Reporting back state - Mode: %d, Temp: %.1f, Fan: %d",
         static_cast<int>(mode), target_temperature, static_cast<int>(fan_mode.value()));
@@ -194,6 +499,122 @@ void WoleixClimate::transmit_state()
     update_state_();
 }
 
+/**
+ * Signal that a temperature change is likely to follow.
+ * 
+ * Temperature commands are only sent in COOL mode, judged by the state the
+ * AC unit is planned to be in.
+ * 
+ * @return true if setting mode was entered
+ */
+bool WoleixClimate::prepare_temperature_change()
+{
+    if (!speculative_setting_mode_) return false;
+    auto lock = lock_protocol_();
+    if (current_state_.power != WoleixPowerState::ON || current_state_.mode != WoleixMode::COOL) return false;
+
+    return WoleixHandler::pre_enter_setting_mode();
+}
+
+/**
+ * Track a button pressed on the physical remote.
+ * 
+ * Frames of our own transmissions are picked up as well and dropped as
+ * echoes. A real press is applied to the tracked state, with the setting
+ * mode quirk: the first temperature press only opens setting mode, and in
+ * any mode but COOL, or with the unit off, the temperature buttons do
+ * nothing. The remote overrides what is still pending: the pending plan is
+ * dropped, and the new state is published as the target.
+ * 
+ * @param data Received pulse train
+ * @return true if the frame is a Woleix button press, including echoes of our own frames
+ */
+bool WoleixClimate::on_receive(remote_base::RemoteReceiveData data)
+{
+    auto nec = remote_base::NECProtocol().decode(data);
+    if (!nec.has_value() || nec->address != ADDRESS_NEC) return false;
+    auto type = WoleixCommand::type_of(nec->command);
+    if (!type.has_value()) return false;
+
+    auto lock = lock_protocol_();
+    if (WoleixHandler::is_echo(nec->command)) return true;
+
+    ESP_LOGD(TAG, "Remote press: code=%#04x", nec->command);
+    if (*type == WoleixCommand::Type::TEMP_UP || *type == WoleixCommand::Type::TEMP_DOWN)
+    {
+        const auto& unit = get_transmitted_state();
+        if (unit.power != WoleixPowerState::ON || unit.mode != WoleixMode::COOL) return true;
+        if (!WoleixHandler::on_remote_temperature_press()) return true;
+    }
+
+    if (debounce_pending_)
+    {
+        cancel_timer(WoleixTimerId::DEBOUNCE);
+        debounce_pending_ = false;
+    }
+    if (planning_ == WoleixPlanning::JUST_IN_TIME)
+    {
+        WoleixStateManager::rebase_on_transmitted();
+    }
+    else
+    {
+        replan_from_transmitted_();
+    }
+    WoleixStateManager::on_remote_press(*type);
+    target_mailbox_.reset(current_state_);
+
+    update_state_();
+    publish_state();
+    return true;
+}
+
+/**
+ * Get the setting mode window the next plan starts into.
+ * 
+ * The next plan goes out once the protocol handler is done with the gap
+ * after its last transmission and with the commands still queued. Queued
+ * temperature presses keep the window open, everything else lets it run
+ * down, so the window is replayed over the queue with the planner's costs.
+ * While a plan replacing the pending one is being made, only the
+ * high-priority commands will still go out ahead of it.
+ * 
+ * @return Window as seen from the first command of the next plan
+ */
+WoleixSettingModeWindow WoleixClimate::setting_mode_window() const
+{
+    auto window = WoleixSettingModeWindow::open_for(setting_mode_remaining_ms());
+    uint32_t at_ms = next_command_in_ms();
+    for (size_t i = 0; i < command_queue_.length(); i++)
+    {
+        const WoleixCommand command = command_queue_.at(i);
+        if (replacing_plan_ && command.get_priority() == WoleixCommand::Priority::NORMAL) continue;
+        at_ms += WoleixPathPlanner::press_cost(command.get_type(), at_ms, window);
+    }
+    return window.after(at_ms);
+}
+
+/**
+ * Handle a control request from ESPHome.
+ * 
+ * A request changing only the target temperature opens setting mode before
+ * the temperature commands are planned, provided speculation is enabled.
+ * 
+ * @param call The requested changes
+ */
+void WoleixClimate::control(const climate::ClimateCall& call)
+{
+    bool temperature_only = call.get_target_temperature().has_value() &&
+        !call.get_mode().has_value() &&
+        !call.get_fan_mode().has_value();
+
+    auto lock = lock_protocol_();
+    if (temperature_only && std::round(*call.get_target_temperature()) != std::round(current_state_.temperature))
+    {
+        prepare_temperature_change();
+    }
+    ClimateIR::control(call);
+}
+
 /**
  * Get the traits/capabilities of this climate device.
  * 
@@ -1,14 +1,19 @@
 #pragma once
 
+#include <algorithm>
 #include <cinttypes>
 #include <vector>
 #include <string>
 #include <map>
 #include <memory>
 #include <deque>
+#include <array>
+#include <atomic>
+#include <mutex>
 
 #include "esphome/core/optional.h"
 #include "esphome/core/log.h"
+#include "esphome/core/hal.h"
 
 #include "esphome/components/climate/climate_mode.h"
 #include "esphome/components/climate_ir/climate_ir.h"
@@ -17,10 +22,17 @@
 
 #include "woleix_constants.h"
 #include "woleix_command.h"
+#include "woleix_coroutine_protocol_handler.h"
+#include "woleix_executor.h"
+#include "woleix_metrics.h"
+#include "woleix_path_planner.h"
 #include "woleix_status.h"
 #include "woleix_protocol_handler.h"
+#include "woleix_reading_throttle.h"
 #include "woleix_state_mapper.h"
 #include "woleix_state_manager.h"
+#include "woleix_target_mailbox.h"
+#include "woleix_timer.h"
 
 namespace esphome
 {
@@ -32,6 +44,14 @@ using climate::ClimateFanMode;
 using climate::ClimateTraits;
 using climate_ir::ClimateIR;
 
+#ifdef USE_WOLEIX_COROUTINE_HANDLER
+/// Protocol handler selected with `protocol_handler: coroutine`
+using WoleixHandler = WoleixCoroutineProtocolHandler;
+#else
+/// Protocol handler selected with `protocol_handler: callbacks`
+using WoleixHandler = WoleixProtocolHandler;
+#endif
+
 namespace WoleixCategory::Core
 {
     inline constexpr auto WX_CATEGORY_ENQUEING_ON_HOLD = 
@@ -40,6 +60,53 @@ namespace WoleixCategory::Core
         Category::make(CategoryId::Core, 2, "Core.EnqueingFailed");
 }
 
+namespace WoleixMessages::Core
+{
+    inline constexpr WoleixMessage WX_MESSAGE_ENQUEING_ON_HOLD
+    {
+        WoleixSeverity::WX_SEVERITY_WARNING,
+        WoleixCategory::Core::WX_CATEGORY_ENQUEING_ON_HOLD,
+        "Transmission on hold due to nearly full command queue"
+    };
+    inline constexpr WoleixMessage WX_MESSAGE_ENQUEING_FAILED
+    {
+        WoleixSeverity::WX_SEVERITY_ERROR,
+        WoleixCategory::Core::WX_CATEGORY_ENQUEING_FAILED,
+        "Transmission failed due to full command queue"
+    };
+}
+
+/**
+ * @brief How state changes are turned into IR commands.
+ */
+enum class WoleixPlanning: uint8_t
+{
+    QUEUED,        ///< Plan the full command sequence on every change and queue it
+    JUST_IN_TIME   ///< Keep only the latest target and plan one command at a time
+};
+
+/**
+ * @brief Pipeline metrics that can be published as sensors.
+ */
+enum class WoleixMetric: uint8_t
+{
+    QUEUE_DEPTH,            ///< Commands currently queued
+    PEAK_QUEUE_DEPTH,       ///< Highest queue depth since boot
+    COMMANDS_PER_MINUTE,    ///< Frames transmitted per minute over the last interval
+    REJECTED_PLANS,         ///< Plans the command queue refused since boot
+    SETTING_MODE_ENTRIES,   ///< Temperature setting mode entry presses since boot
+    SETTING_MODE_REUSES,    ///< Temperature runs reusing an active setting mode since boot
+    AIRTIME,                ///< Total IR airtime since boot, in seconds
+    LATENCY_P50,            ///< Median plan latency since boot, in milliseconds
+    LATENCY_P95,            ///< 95th percentile plan latency since boot, in milliseconds
+    LATENCY_MAX             ///< Longest plan latency since boot, in milliseconds
+};
+
+/**
+ * @brief Number of WoleixMetric values.
+ */
+inline constexpr size_t WOLEIX_METRIC_COUNT = 10;
+
 /**
  * Climate IR controller for Woleix air conditioners.
  * 
@@ -60,18 +127,46 @@ namespace WoleixCategory::Core
  * @code{.yaml}
  * climate:
  *   - platform: climate_ir_woleix
+ *     id: air_conditioner
  *     name: "Air Conditioner"
  *     transmitter_id: ir_transmitter
  *     sensor: room_temp
  *     humidity_sensor: room_humidity  # optional
+ *     reading_publishing:              # optional, default: publish every reading
+ *       min_interval: 10s
+ *       temperature_delta: 0.2
+ *       humidity_delta: 1.0
+ *       max_staleness: 5min
+ *     planning: just_in_time           # optional, default: queued
+ *     shortest_path_planning: true     # optional, default: false
+ *     wait_for_transmit_complete: true # optional, default: false, see below
+ *     executor: dedicated              # optional, default: main_loop, see below
+ *     debounce:                        # optional, default: plan every change right away
+ *       window: 300ms
+ *       max_latency: 1s
+ *     metrics_update_interval: 60s     # optional, default: 60s
+ *     queue_depth:                     # optional metrics sensors, see set_metrics_sensor()
+ *       name: "AC Queue Depth"
+ * @endcode
+ * 
+ * With wait_for_transmit_complete, the transmitter has to report the end
+ * of each transmission. The dedicated executor needs a non-blocking
+ * transmitter as well:
+ * @code{.yaml}
+ * remote_transmitter:
+ *   id: ir_transmitter
+ *   non_blocking: true
+ *   on_complete:
+ *     - lambda: id(air_conditioner).on_transmit_complete();
  * @endcode
  * 
  * @see WoleixStateManager
  */
 class WoleixClimate
   : public ClimateIR,
+    protected WoleixTimerScheduler,
     public WoleixStateManager,
-    public WoleixProtocolHandler,
+    public WoleixHandler,
     protected WoleixCommandQueueProducer,
     protected WoleixStatusObserver
 {
@@ -83,6 +178,14 @@ public:
      */
     WoleixClimate();
 
+    /**
+     * Destructor.
+     * 
+     * Stops the dedicated executor and hands the protocol timers back to
+     * the component, as the protocol handler outlives the executor.
+     */
+    ~WoleixClimate() override;
+
     /**
      * Setup method called once during initialization.
      * 
@@ -92,6 +195,22 @@ public:
      */
     void setup() override;
 
+    /**
+     * Called by ESPHome before a reboot or an OTA update.
+     * 
+     * Stops the dedicated executor, so that no command goes out while the
+     * device shuts down.
+     */
+    void on_shutdown() override { executor_.stop(); }
+
+    /**
+     * Main loop hook.
+     * 
+     * Applies the status changes raised on the dedicated executor's task,
+     * see report_status().
+     */
+    void loop() override;
+
     /**
      * Set the transmitter for this climate device.
      * 
@@ -104,7 +223,7 @@ public:
     void set_transmitter(RemoteTransmitterBase* transmitter) override
     {
         ClimateIR::set_transmitter(transmitter);
-        WoleixProtocolHandler::set_transmitter(transmitter);
+        WoleixHandler::set_transmitter(transmitter);
     }
 
     /**
@@ -114,6 +233,138 @@ public:
      */
     void set_humidity_sensor(sensor::Sensor* humidity_sensor) { humidity_sensor_ = humidity_sensor; }
 
+    /**
+     * Limit how often sensor readings publish the climate state.
+     * 
+     * Current temperature and humidity readings are applied right away, but
+     * publishing them is throttled by a WoleixReadingThrottle: at most once
+     * per @p min_interval_ms, and only for changes of at least the reading's
+     * delta (see set_reading_delta()) or once the last publication is older
+     * than @p max_staleness_ms.
+     * 
+     * @param min_interval_ms Shortest time between two publications
+     * @param max_staleness_ms Age after which any reading is published, 0 for no limit
+     */
+    void set_reading_publishing(uint32_t min_interval_ms, uint32_t max_staleness_ms)
+    {
+        reading_throttle_.configure(min_interval_ms, max_staleness_ms);
+    }
+
+    /**
+     * Set the smallest change of a sensor reading that is published.
+     * 
+     * @param reading Kind of reading
+     * @param delta Change threshold, in the reading's unit
+     */
+    void set_reading_delta(WoleixReading reading, float delta) { reading_throttle_.set_delta(reading, delta); }
+
+    /**
+     * Set a sensor publishing one of the pipeline metrics.
+     * 
+     * Sensors are published together every metrics update interval, from a
+     * snapshot of the counters in WoleixMetrics.
+     * 
+     * @param metric Metric to publish
+     * @param metric_sensor Sensor receiving the metric
+     */
+    void set_metrics_sensor(WoleixMetric metric, sensor::Sensor* metric_sensor)
+    {
+        metrics_sensors_[static_cast<size_t>(metric)] = metric_sensor;
+    }
+
+    /**
+     * Set how often the metrics sensors are published.
+     * 
+     * @param interval_ms Publishing interval in milliseconds
+     */
+    void set_metrics_update_interval(uint32_t interval_ms) { metrics_update_interval_ms_ = interval_ms; }
+
+    /**
+     * Select how state changes are planned.
+     * 
+     * Must be called before setup(), which connects the protocol handler
+     * to either the command queue or the target mailbox.
+     * 
+     * @param planning Planning strategy
+     */
+    void set_planning(WoleixPlanning planning) { planning_ = planning; }
+
+    /**
+     * Enable speculative entry into temperature setting mode.
+     * 
+     * When enabled, temperature-only changes and prepare_temperature_change()
+     * open setting mode ahead of the actual temperature commands.
+     * 
+     * @param enabled true to enable speculation
+     */
+    void set_speculative_setting_mode(bool enabled) { speculative_setting_mode_ = enabled; }
+
+    /**
+     * Run the protocol timers on a dedicated executor.
+     * 
+     * By default, the protocol timers are ESPHome timeouts, fired from the
+     * main loop: command gaps are only as precise as the loop period and
+     * stretch whenever the loop stalls. The dedicated executor fires them
+     * from a WoleixThreadExecutor instead, a FreeRTOS task of its own on
+     * ESP32, so the protocol handler keeps sub-millisecond gaps. Requires a
+     * `non_blocking` transmitter, since the main loop waits for the
+     * transmits on that task. Must be called before setup().
+     * 
+     * @param enabled true to use the dedicated executor
+     */
+    void set_dedicated_executor(bool enabled) { dedicated_executor_ = enabled; }
+
+    /**
+     * Signal that the transmitter finished sending.
+     * 
+     * Hides WoleixHandler::on_transmit_complete() to serialize it
+     * with the dedicated executor, if any.
+     */
+    void on_transmit_complete()
+    {
+        auto lock = lock_protocol_();
+        WoleixHandler::on_transmit_complete();
+    }
+
+    /**
+     * Debounce state changes before planning them.
+     * 
+     * Bursts of control calls, e.g. from dragging a thermostat slider, are
+     * coalesced: planning waits until no new call arrived for @p window_ms,
+     * but never longer than @p max_latency_ms after the first call of the
+     * burst. Only the final target of the burst is planned. Turning the unit
+     * off is never delayed.
+     * 
+     * @param window_ms Quiet time that ends a burst, 0 to plan every call right away
+     * @param max_latency_ms Longest delay from the first call of a burst to planning
+     */
+    void set_debounce(uint32_t window_ms, uint32_t max_latency_ms)
+    {
+        debounce_window_ms_ = window_ms;
+        debounce_max_latency_ms_ = std::max(window_ms, max_latency_ms);
+    }
+
+    /**
+     * Signal that a temperature change is likely to follow.
+     * 
+     * Meant for early signals such as the start of a slider drag, e.g. from a
+     * lambda. If speculation is enabled and the AC unit is on in COOL mode,
+     * setting mode is opened right away, so the temperature change that
+     * follows within the setting mode window skips the entry press and delay.
+     * 
+     * @return true if setting mode was entered
+     */
+    bool prepare_temperature_change();
+
+    /**
+     * Get the setting mode window the next plan starts into.
+     * 
+     * Predicted from the protocol handler, see WoleixStateManager::setting_mode_window().
+     * 
+     * @return Window as seen from the first command of the next plan
+     */
+    WoleixSettingModeWindow setting_mode_window() const override;
+
     /**
      * Reset the state manager to default values.
      * 
@@ -138,31 +389,36 @@ protected:
      * 
      * This method logs the status
      * message with appropriate severity and sets error or warning states as needed.
+     * The component status is not synchronized, so on the dedicated executor's
+     * task only the log line is written, and the status change is left to loop().
      * 
      * @param reporter The reporter that generated the status update.
      * @param status The status update to be handled.
      */
     virtual void report_status(const WoleixStatus& status)
     {
+        char text[WoleixStatus::MAX_TEXT_LENGTH];
+        status.format(text, sizeof(text));
+
         if (status.get_severity() == WoleixStatus::Severity::WX_SEVERITY_ERROR)
         {
-            auto msg = status.get_message();
-            ESP_LOGE(TAG, "Error (%s): %s", status.get_category().name, msg.c_str());
-            status_set_error();
+            ESP_LOGE(TAG, "Error (%s): %s", status.get_category().name, text);
+            if (on_executor_()) status_error_raised_ = true;
+            else status_set_error();
         }
         if (status.get_severity() == WoleixStatus::Severity::WX_SEVERITY_WARNING)
         {
-            auto msg = status.get_message();
-            ESP_LOGW(TAG, "Warning (%s): %s", status.get_category().name, msg.c_str());
-            status_set_warning();
+            ESP_LOGW(TAG, "Warning (%s): %s", status.get_category().name, text);
+            if (on_executor_()) status_warning_raised_ = true;
+            else status_set_warning();
         }
         if (status.get_severity() == WoleixStatus::Severity::WX_SEVERITY_INFO)
         {
-            ESP_LOGI(TAG, "Info (%s): %s", status.get_category().name, status.get_message().c_str());
+            ESP_LOGI(TAG, "Info (%s): %s", status.get_category().name, text);
         }
         if (status.get_severity() == WoleixStatus::Severity::WX_SEVERITY_DEBUG)
         {
-            ESP_LOGD(TAG, "Debug (%s): %s", status.get_category().name, status.get_message().c_str());
+            ESP_LOGD(TAG, "Debug (%s): %s", status.get_category().name, text);
         }
     }
 
@@ -180,6 +436,82 @@ protected:
         report_status(status);
     }
 
+    /**
+     * @brief Schedule a protocol timer on the ESPHome scheduler.
+     * 
+     * Uses the numeric timeout ID overload, so no name string is built or hashed.
+     * The callback is kept in a per-timer slot; the closure handed to ESPHome
+     * only captures `this` and the ID and fits into std::function's inline buffer.
+     * 
+     * @param id Timer to (re)schedule
+     * @param delay_ms Delay in milliseconds
+     * @param callback Function to call when the timer fires
+     */
+    void schedule_timer(WoleixTimerId id, uint32_t delay_ms, WoleixTimerCallback callback) override
+    {
+        timer_callbacks_[static_cast<size_t>(id)] = callback;
+        set_timeout(static_cast<uint32_t>(id), delay_ms, [this, id]()
+        {
+            // Copy first: the callback may reschedule the same timer
+            WoleixTimerCallback fired = timer_callbacks_[static_cast<size_t>(id)];
+            fired();
+        });
+    }
+
+    /**
+     * @brief Cancel a protocol timer on the ESPHome scheduler.
+     * 
+     * @param id Timer to cancel
+     */
+    void cancel_timer(WoleixTimerId id) override
+    {
+        cancel_timeout(static_cast<uint32_t>(id));
+    }
+
+    /**
+     * @brief Current time on the ESPHome clock.
+     */
+    uint32_t now_ms() const override
+    {
+        return millis();
+    }
+
+    /**
+     * @brief Serialize with the protocol timers on the dedicated executor.
+     * 
+     * The protocol handler, the command queue and the state manager are
+     * shared with the executor's callbacks, so every entry point from the
+     * main loop holds the executor's mutex. Without a dedicated executor,
+     * everything runs on the main loop and nothing is locked.
+     * 
+     * @return Lock held until it goes out of scope, if any
+     */
+    std::unique_lock<std::recursive_mutex> lock_protocol_()
+    {
+        if (!dedicated_executor_) return {};
+        return std::unique_lock<std::recursive_mutex>(executor_.mutex());
+    }
+
+    /**
+     * @brief Whether the caller runs on the dedicated executor's task.
+     */
+    bool on_executor_() const
+    {
+        return dedicated_executor_ && executor_.is_current_thread();
+    }
+
+    /**
+     * @brief Track the state reached by the commands transmitted so far.
+     * 
+     * @param command Command transmitted
+     * @param presses Number of presses
+     */
+    void on_commands_transmitted_(const WoleixCommand& command, uint32_t presses) override
+    {
+        WoleixStateManager::on_command_transmitted(command.get_type(), presses);
+        metrics_.record_queue_depth(command_queue_.length());
+    }
+
     /**
      * @brief Handler for when the command queue reaches its high watermark.
      * 
@@ -187,8 +519,9 @@ protected:
      */
     void on_queue_at_high_watermark() override
     {
-        ESP_LOGW(TAG, "Queue at its high watermark (%d)", command_queue_->length());
-        status_set_warning(LOG_STR("Queue.AtHighWatermark"));
+        ESP_LOGW(TAG, "Queue at its high watermark (%d)", command_queue_.length());
+        if (on_executor_()) status_warning_raised_ = true;
+        else status_set_warning(LOG_STR("Queue.AtHighWatermark"));
         on_hold_ = true;
     }
 
@@ -199,7 +532,7 @@ protected:
      */
     void on_queue_at_low_watermark() override
     {
-        ESP_LOGI(TAG, "Queue at its low watermark (%d)", command_queue_->length());
+        ESP_LOGI(TAG, "Queue at its low watermark (%d)", command_queue_.length());
         on_hold_ = false;
     }
 
@@ -211,7 +544,8 @@ protected:
     void on_queue_full() override
     {
         ESP_LOGE(TAG, "Queue full");
-        status_set_error(LOG_STR("Queue.Full"));
+        if (on_executor_()) status_error_raised_ = true;
+        else status_set_error(LOG_STR("Queue.Full"));
     }
 
     /**
@@ -227,10 +561,41 @@ protected:
      * Transmit the current state via IR.
      * 
      * Called by ESPHome when the climate state changes. Calculates necessary commands,
-     * transmits them, and updates internal state.
+     * transmits them, and updates internal state, possibly after a debounce delay.
      */
     void transmit_state() override;
 
+    /**
+     * Plan and enqueue the current state right away.
+     */
+    void transmit_state_now_();
+
+    /**
+     * Plan the final target of a debounced burst and publish the result.
+     */
+    void flush_debounced_state_();
+
+    /**
+     * Handle a control request from ESPHome.
+     * 
+     * Speculatively enters setting mode for temperature-only requests, then
+     * hands over to ClimateIR::control().
+     * 
+     * @param call The requested changes
+     */
+    void control(const climate::ClimateCall& call) override;
+
+    /**
+     * Track a button pressed on the physical remote.
+     * 
+     * Called by the remote receiver for every frame it decodes, when the
+     * climate is given a `receiver_id`.
+     * 
+     * @param data Received pulse train
+     * @return true if the frame is a Woleix button press, including echoes of our own frames
+     */
+    bool on_receive(remote_base::RemoteReceiveData data) override;
+
     /**
      * Get the traits/capabilities of this climate device.
      * 
@@ -238,6 +603,11 @@ protected:
      */
     ClimateTraits traits() override;
 
+    /**
+     * Map the requested ESPHome climate state to a Woleix target state.
+     */
+    WoleixInternalState target_state_() const;
+
     /**
      * Calculate commands needed to reach the target state.
      * 
@@ -245,15 +615,82 @@ protected:
      */
     virtual bool enqueue_commands_();
 
+    /**
+     * Rebase the planned state on the transmitted state, leaving the queue alone.
+     * 
+     * @return Number of pending normal-priority commands the next plan replaces
+     */
+    size_t rebase_on_transmitted_();
+
+    /**
+     * Drop the pending plan and rebase the planned state on the transmitted state.
+     */
+    void replan_from_transmitted_();
+
     /**
      * Update internal state based on the current state machine state.
      */
     virtual void update_state_();
 
-    std::unique_ptr<WoleixCommandQueue> command_queue_;         /**< Command queue for asynchronous execution */
+    /**
+     * Start timing a freshly enqueued plan until its last frame is sent.
+     */
+    void time_plan_();
+
+    /**
+     * Publish the metrics sensors and schedule the next publication.
+     */
+    void publish_metrics_();
+
+    /**
+     * Apply a sensor reading and publish it, now or later, if it is worth it.
+     * 
+     * @param reading Kind of reading
+     * @param value New value
+     */
+    void on_reading_(WoleixReading reading, float value);
+
+    /**
+     * Publish the climate state for the pending sensor readings.
+     */
+    void publish_readings_();
+
+    /**
+     * Get the command source the protocol handler pulls from.
+     * 
+     * @return The command queue or the target mailbox, depending on the planning strategy
+     */
+    WoleixCommandSource* command_source_()
+    {
+        if (planning_ == WoleixPlanning::JUST_IN_TIME) return &target_mailbox_;
+        return &command_queue_;
+    }
+
+    WoleixStaticCommandQueue<QUEUE_MAX_CAPACITY> command_queue_;  /**< Command queue for asynchronous execution */
+    WoleixTargetMailbox target_mailbox_;        /**< Latest target for just-in-time planning */
+    WoleixPlanning planning_{WoleixPlanning::QUEUED};  /**< Planning strategy */
+    WoleixStatusBus status_bus_;               /**< Status bus shared by the state manager and protocol handler */
+    bool speculative_setting_mode_{false};     /**< Whether setting mode may be entered ahead of time */
+    std::array<WoleixTimerCallback, WOLEIX_TIMER_COUNT> timer_callbacks_{};  /**< Pending timer callbacks, by timer ID */
 
+    sensor::Sensor* temperature_sensor_{nullptr};  /**< Current temperature sensor, taken over from ClimateIR */
     sensor::Sensor* humidity_sensor_{nullptr};  /**< Optional humidity sensor */
+    WoleixReadingThrottle reading_throttle_;    /**< Publishing policy for sensor readings */
+    std::array<sensor::Sensor*, WOLEIX_METRIC_COUNT> metrics_sensors_{};  /**< Optional metrics sensors, by metric */
+    uint32_t metrics_update_interval_ms_{60000};  /**< Metrics publishing interval */
+    uint32_t last_commands_transmitted_{0};     /**< Frame counter at the previous publication */
+    bool replacing_plan_{false};                /**< Whether the plan being made replaces the pending normal-priority commands */
+    uint32_t change_requested_ms_{0};           /**< When the change being planned was first requested, on the handler's clock */
+    uint32_t plan_requested_ms_{0};             /**< When the change behind the plan being timed was requested */
+    uint32_t debounce_window_ms_{0};            /**< Quiet time ending a burst of state changes, 0 if disabled */
+    uint32_t debounce_max_latency_ms_{0};       /**< Longest delay of a debounced state change */
+    uint32_t debounce_started_ms_{0};           /**< When the pending burst started */
+    bool debounce_pending_{false};              /**< Whether a debounced state change is pending */
     bool on_hold_{false};                       /**< Flag indicating if command transmission is on hold */
+    bool dedicated_executor_{false};            /**< Whether the protocol timers run on executor_ */
+    WoleixThreadExecutor executor_;             /**< Executor for the protocol timers, if dedicated */
+    std::atomic<bool> status_error_raised_{false};    /**< Error raised on the executor's task, pending for loop() */
+    std::atomic<bool> status_warning_raised_{false};  /**< Warning raised on the executor's task, pending for loop() */
 };
 
 }  // namespace climate_ir_woleix
@@ -1,14 +1,16 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <memory>
-#include <deque>
 #include <numeric>
 #include <set>
 #include <optional>
+#include <vector>
 
 #include "woleix_constants.h"
 #include "woleix_status.h"
+#include "woleix_ring_buffer.h"
 
 namespace esphome
 {
@@ -41,6 +43,24 @@ public:
         FAN_SPEED = SPEED_NEC     /**< Toggle fan speed LOW/HIGH */
     };
 
+    /**
+     * @brief Priority classes (lanes) of the command queue.
+     * 
+     * High-priority commands are queued ahead of all normal ones.
+     */
+    enum class Priority: uint8_t
+    {
+        NORMAL,   /**< Regular state changes */
+        HIGH      /**< Commands that must not wait, e.g. turning the unit off */
+    };
+
+    /**
+     * @brief Construct a placeholder POWER command.
+     * 
+     * Only used to pre-fill the fixed-size command queue slots.
+     */
+    WoleixCommand() = default;
+
     /**
      * @brief Construct a new Woleix command.
      * 
@@ -67,6 +87,25 @@ public:
      */
     uint16_t get_command() const { return static_cast<uint16_t>(type_); };
     
+    /**
+     * @brief Look up the command type of a NEC command code.
+     * 
+     * @param code NEC command code, e.g. of a received frame
+     * @return Command type, or nothing for buttons the controller does not use (TIMER) and unknown codes
+     */
+    static std::optional<Type> type_of(uint16_t code)
+    {
+        switch (code)
+        {
+            case POWER_NEC:     return Type::POWER;
+            case TEMP_UP_NEC:   return Type::TEMP_UP;
+            case TEMP_DOWN_NEC: return Type::TEMP_DOWN;
+            case MODE_NEC:      return Type::MODE;
+            case SPEED_NEC:     return Type::FAN_SPEED;
+            default:            return {};
+        }
+    }
+
     /**
      * @brief Get the NEC protocol address.
      * @return 16-bit NEC address
@@ -79,10 +118,22 @@ public:
      */
     uint32_t get_repeat_count() const { return repeat_count_; }
 
+    /**
+     * @brief Get the queue priority class.
+     * @return Priority class
+     */
+    Priority get_priority() const { return priority_; }
+
+    /**
+     * @brief Set the queue priority class.
+     * @param priority Priority class
+     */
+    void set_priority(Priority priority) { priority_ = priority; }
+
     /**
      * @brief Equality comparison operator.
      * 
-     * Compares type, address, delay, and repeat count.
+     * Compares type, address, repeat count and priority.
      * 
      * @param other Command to compare with
      * @return true if commands are identical, false otherwise
@@ -91,15 +142,105 @@ public:
     {
         return type_ == other.type_ &&
             address_ == other.address_ &&
-            repeat_count_ == other.repeat_count_;
+            repeat_count_ == other.repeat_count_ &&
+            priority_ == other.priority_;
     }
 
 protected:
-    Type type_;
-    uint16_t address_;    /**< NEC format IR address */
+    Type type_{Type::POWER};
+    uint16_t address_{ADDRESS_NEC};    /**< NEC format IR address */
     uint32_t repeat_count_{1};  /**< Number of times to repeat the command */
+    Priority priority_{Priority::NORMAL};  /**< Queue priority class */
+};
+
+/**
+ * @brief Queue-internal 2-byte form of a WoleixCommand.
+ * 
+ * | Bits  | Meaning                                               |
+ * |-------|-------------------------------------------------------|
+ * | 0-2   | Button, as index into TYPES                           |
+ * | 3     | Priority (set: HIGH)                                  |
+ * | 4-5   | Slot in the owning queue's address table              |
+ * | 6-15  | Repeat count (0-1023)                                 |
+ * 
+ * The NEC address is the same for every command of a device, so the queue
+ * keeps it once in a small address table and the slots only refer to it.
+ * A WoleixCommand is materialized with unpack() when the command is read.
+ */
+class WoleixPackedCommand
+{
+public:
+    /// Buttons in index order
+    static constexpr std::array<WoleixCommand::Type, 5> TYPES =
+    {
+        WoleixCommand::Type::POWER,
+        WoleixCommand::Type::TEMP_UP,
+        WoleixCommand::Type::TEMP_DOWN,
+        WoleixCommand::Type::MODE,
+        WoleixCommand::Type::FAN_SPEED
+    };
+
+    static constexpr uint16_t TYPE_MASK = 0x07;
+    static constexpr uint16_t PRIORITY_BIT = 0x08;
+    static constexpr uint8_t ADDRESS_SHIFT = 4;
+    static constexpr uint16_t ADDRESS_MASK = 0x03;
+    static constexpr uint8_t REPEAT_SHIFT = 6;
+
+    /// Number of distinct addresses a queue can refer to
+    static constexpr size_t ADDRESS_SLOTS = ADDRESS_MASK + 1;
+    /// Largest repeat count that fits
+    static constexpr uint32_t MAX_REPEAT_COUNT = 0xFFFF >> REPEAT_SHIFT;
+
+    WoleixPackedCommand() = default;
+
+    /**
+     * @brief Pack a command.
+     * 
+     * @param command Command to pack
+     * @param address_slot Slot of the command's address in the queue's address table
+     * @return Packed command, or nothing if the type is unknown or the repeat count too large
+     */
+    static std::optional<WoleixPackedCommand> pack(const WoleixCommand& command, uint8_t address_slot)
+    {
+        if (command.get_repeat_count() > MAX_REPEAT_COUNT || address_slot >= ADDRESS_SLOTS) return {};
+
+        for (uint16_t index = 0; index < TYPES.size(); index++)
+        {
+            if (TYPES[index] != command.get_type()) continue;
+
+            uint16_t bits = index;
+            if (command.get_priority() == WoleixCommand::Priority::HIGH) bits |= PRIORITY_BIT;
+            bits |= static_cast<uint16_t>(address_slot << ADDRESS_SHIFT);
+            bits |= static_cast<uint16_t>(command.get_repeat_count() << REPEAT_SHIFT);
+            return WoleixPackedCommand(bits);
+        }
+        return {};
+    }
+
+    /**
+     * @brief Materialize the command.
+     * @param address NEC address stored in the slot given by address_slot()
+     */
+    WoleixCommand unpack(uint16_t address) const
+    {
+        WoleixCommand command(TYPES[bits_ & TYPE_MASK], address, 0, bits_ >> REPEAT_SHIFT);
+        if (bits_ & PRIORITY_BIT) command.set_priority(WoleixCommand::Priority::HIGH);
+        return command;
+    }
+
+    uint8_t address_slot() const { return (bits_ >> ADDRESS_SHIFT) & ADDRESS_MASK; }
+
+    bool is_high_priority() const { return (bits_ & PRIORITY_BIT) != 0; }
+
+protected:
+    explicit WoleixPackedCommand(uint16_t bits) : bits_(bits) {}
+
+    uint16_t bits_{0};
 };
 
+static_assert(sizeof(WoleixPackedCommand) == 2, "Packed command must fit into 2 bytes");
+static_assert(WoleixPackedCommand::TYPES.size() <= WoleixPackedCommand::TYPE_MASK + 1);
+
 static constexpr float QUEUE_HIGH_WATERMARK = 0.8f;
 static constexpr float QUEUE_LOW_WATERMARK = 0.2f;
 
@@ -148,19 +289,105 @@ public:
     virtual void on_command_enqueued() = 0;
 };
 
+/**
+ * @brief Source of commands for the protocol handler.
+ * 
+ * The protocol handler pulls the next command with get(), transmits it and
+ * calls dequeue() once the command has taken effect. Consumers are notified
+ * whenever the source turns from empty to non-empty.
+ * 
+ * Implemented by WoleixCommandQueue (commands planned ahead of time) and
+ * WoleixTargetMailbox (commands planned just in time).
+ */
+class WoleixCommandSource
+{
+public:
+    virtual ~WoleixCommandSource() = default;
+
+    /**
+     * @brief Peek at the next command to transmit.
+     * @return The next command, or nothing if the source is empty
+     */
+    virtual std::optional<WoleixCommand> get() const = 0;
+
+    /**
+     * @brief Consume the command returned by get().
+     * @return false if the source was empty, true otherwise
+     */
+    virtual bool dequeue() = 0;
+
+    /**
+     * @brief Check whether there is anything left to transmit.
+     */
+    virtual bool is_empty() const = 0;
+
+    void register_consumer(WoleixCommandQueueConsumer* consumer)
+    {
+        consumers_.push_back(consumer);
+    }
+    void unregister_consumer(WoleixCommandQueueConsumer* consumer)
+    {
+        std::erase(consumers_, consumer);
+    }
+
+    void on_command_enqueued() const
+    {
+        for (const auto& consumer : consumers_)
+        {
+            consumer->on_command_enqueued();
+        }
+    }
+
+protected:
+    std::vector<WoleixCommandQueueConsumer*> consumers_;
+};
+
+/**
+ * @brief Destination the state manager emits planned commands into.
+ * 
+ * A plan is emitted command by command and then committed as a whole:
+ * either all commands are taken over, or none is.
+ */
+class WoleixCommandSink
+{
+public:
+    virtual ~WoleixCommandSink() = default;
+
+    /**
+     * @brief Take the next command of the plan.
+     * @param command Planned command
+     * @return false if the command cannot be taken; the plan is then rejected on commit()
+     */
+    virtual bool emit(const WoleixCommand& command) = 0;
+
+    /**
+     * @brief Publish all emitted commands at once.
+     * @return false if the plan was rejected, in which case nothing was published
+     */
+    virtual bool commit() = 0;
+};
+
 /**
  * @brief A queue for managing WoleixCommand objects.
  * 
  * This class implements a queue with a maximum capacity for WoleixCommand objects.
  * It provides methods for enqueueing and dequeueing commands, as well as notifying
  * producers and consumers about the queue's state.
+ * 
+ * The commands are held in a fixed-capacity ring buffer, so neither enqueueing
+ * nor dequeueing ever touches the heap. The slot storage itself is provided by
+ * WoleixStaticCommandQueue, which sizes it at compile time.
+ * 
+ * Slots hold WoleixPackedCommand (2 bytes instead of 12), with the NEC
+ * addresses kept once per queue. Commands that do not pack (repeat count above
+ * WoleixPackedCommand::MAX_REPEAT_COUNT, or more distinct addresses pending
+ * than WoleixPackedCommand::ADDRESS_SLOTS) are rejected by enqueue().
  */
-class WoleixCommandQueue
+class WoleixCommandQueue : public WoleixCommandSource
 {
 public:
-    WoleixCommandQueue(size_t max_capacity)
-        : max_capacity_(max_capacity), queue_(std::make_unique<std::deque<WoleixCommand>>())
-    {}
+    WoleixCommandQueue(const WoleixCommandQueue&) = delete;
+    WoleixCommandQueue& operator=(const WoleixCommandQueue&) = delete;
 
     void register_producer(WoleixCommandQueueProducer* producer)
     {
@@ -171,73 +398,161 @@ public:
         std::erase(producers_, producer);
     }
 
-    void register_consumer(WoleixCommandQueueConsumer* consumer)
-    {
-        consumers_.push_back(consumer);
-    }
-    void unregister_consumer(WoleixCommandQueueConsumer* consumer)
+    /**
+     * @brief Sink writing a plan straight into the free slots of the queue.
+     * 
+     * Emitted commands are packed into the slots past the tail, where they
+     * stay invisible to the consumer until commit() publishes them in one go.
+     * When a plan is rejected or abandoned, the staged slots are simply
+     * overwritten by the next plan, and the addresses it registered are
+     * released again.
+     * 
+     * A plan may replace the pending normal-priority commands: it may use
+     * their room, and they stay queued until the plan is committed and are
+     * dropped in the same step, so a rejected plan leaves them in place.
+     * Only a plan that runs out of free slots drops them early, to stage
+     * into their room; if it is rejected after all, they are gone.
+     * 
+     * Only one plan may be open at a time, and nothing else may be enqueued
+     * until it is committed or dropped.
+     */
+    class Plan : public WoleixCommandSink
     {
-        std::erase(consumers_, consumer);
-    }
+    public:
+        Plan(WoleixCommandQueue& queue, bool replace_pending)
+          : queue_(queue), replace_pending_(replace_pending)
+        {
+            if (queue_.queue_.empty()) queue_.address_count_ = 0;
+            address_count_ = queue_.address_count_;
+            if (replace_pending_) pending_ = queue_.count_pending_();
+        }
 
-    bool enqueue(const WoleixCommand& command)
-    {
-        if (queue_->size() == max_capacity_)
+        ~Plan()
         {
-            on_queue_full();
-            return false;
+            if (committed_) return;
+            queue_.address_count_ = address_count_;
+            if (dropped_ > 0) queue_.on_commands_removed_();
+        }
+
+        Plan(const Plan&) = delete;
+        Plan& operator=(const Plan&) = delete;
+
+        bool emit(const WoleixCommand& command) override
+        {
+            size_t offset = emitted_++;
+            if (unpackable_ || !fits_()) return false;
+
+            auto packed = queue_.pack_(command);
+            if (!packed.has_value())
+            {
+                unpackable_ = true;
+                return false;
+            }
+            if (queue_.queue_.stage(offset, packed.value())) return true;
+            if (pending_ == 0 || dropped_ > 0) return false;
+
+            // Out of free slots: drop the commands this plan replaces now rather than on commit
+            dropped_ = queue_.drop_pending_(offset);
+            return queue_.queue_.stage(offset, packed.value());
         }
-        else if (queue_->size() > max_capacity_ * QUEUE_HIGH_WATERMARK)
+
+        bool commit() override
         {
-            on_queue_at_high_watermark();
+            if (!fits_())
+            {
+                queue_.on_queue_full();
+                return false;
+            }
+            if (unpackable_) return false;
+            committed_ = true;
+            return queue_.commit_(emitted_, replace_pending_, dropped_);
         }
 
-        queue_->push_back(command);
+        /// Number of commands emitted so far
+        size_t size() const { return emitted_; }
 
-        if (queue_->size() == 1)
+        /// Number of pending commands already dropped to make room for the plan
+        size_t dropped() const { return dropped_; }
+
+    protected:
+        /// Whether the plan fits, counting the room of the commands it replaces
+        bool fits_() const
         {
-            on_command_enqueued();
+            size_t reclaimable = dropped_ > 0 ? 0 : pending_;
+            return queue_.queue_.size() + emitted_ <= queue_.max_capacity() + reclaimable;
         }
-        return true;
-    }
-    bool enqueue(const std::vector<WoleixCommand>& commands)
+
+        WoleixCommandQueue& queue_;
+        bool replace_pending_;      ///< Drop pending normal-priority commands on commit
+        size_t pending_{0};         ///< Normal-priority commands the plan replaces
+        size_t dropped_{0};         ///< Of these, the ones dropped ahead of the commit
+        size_t emitted_{0};
+        uint8_t address_count_{0};  ///< Addresses in use before the plan
+        bool unpackable_{false};    ///< A command did not fit the packed form
+        bool committed_{false};
+    };
+
+    /**
+     * @brief Open a plan to be emitted straight into the queue.
+     * 
+     * @param replace_pending true to drop the pending normal-priority
+     *        commands once the plan is committed, as preempt() would
+     */
+    Plan begin_plan(bool replace_pending = false) { return Plan(*this, replace_pending); }
+
+    bool enqueue(const WoleixCommand& command)
     {
-        if (queue_->size() + commands.size() > max_capacity_)
+        if (queue_.full())
         {
             on_queue_full();
             return false;
         }
-        else if (queue_->size() + commands.size() >= max_capacity_ * QUEUE_HIGH_WATERMARK)
+
+        if (queue_.empty()) address_count_ = 0;
+        auto packed = pack_(command);
+        if (!packed.has_value()) return false;
+
+        if (queue_.size() > max_capacity() * QUEUE_HIGH_WATERMARK)
         {
             on_queue_at_high_watermark();
         }
 
-        queue_->insert(queue_->end(), commands.begin(), commands.end());
-
-        if (queue_->size() == commands.size())
+        queue_.stage(0, packed.value());
+        queue_.commit(1);
+        lift_by_priority_(queue_.size() - 1);
+        if (queue_.size() == 1)
         {
             on_command_enqueued();
         }
         return true;
     }
+    bool enqueue(const std::vector<WoleixCommand>& commands)
+    {
+        Plan plan = begin_plan();
+        for (const auto& command : commands)
+        {
+            plan.emit(command);
+        }
+        return plan.commit();
+    }
 
-    std::optional<WoleixCommand> get() const
+    std::optional<WoleixCommand> get() const override
     {
-        if (queue_->empty()) return {};
-        return queue_->front();
+        if (queue_.empty()) return {};
+        return unpack_(queue_.front());
     }
 
-    bool dequeue()
+    bool dequeue() override
     {
-        if (queue_->empty()) return false;
-        if (queue_->size() <= max_capacity_ * QUEUE_LOW_WATERMARK)
+        if (queue_.empty()) return false;
+        if (queue_.size() <= max_capacity() * QUEUE_LOW_WATERMARK)
         {
             on_queue_at_low_watermark();
         }
 
-        queue_->pop_front();
+        queue_.pop_front();
         
-        if (queue_->empty())
+        if (queue_.empty())
         {
             on_queue_empty();
         }
@@ -276,26 +591,226 @@ public:
         }
     }
 
-    void on_command_enqueued() const
+    /**
+     * @brief Drop all pending normal-priority commands.
+     * 
+     * Used when a high-priority target makes the pending plan obsolete. The
+     * dropped commands were never transmitted, so the caller re-plans from the
+     * state transmitted so far. High-priority commands stay queued.
+     * 
+     * @return Number of commands removed from the queue
+     */
+    size_t preempt()
     {
-        for (const auto& consumer : consumers_)
+        size_t kept = 0;
+        for (size_t i = 0; i < queue_.size(); i++)
         {
-            consumer->on_command_enqueued();
+            if (queue_[i].is_high_priority())
+            {
+                queue_[kept++] = queue_[i];
+            }
         }
+
+        size_t removed = queue_.size() - kept;
+        if (removed == 0) return 0;
+
+        queue_.truncate(kept);
+        on_commands_removed_();
+        return removed;
     }
 
-    void reset() { queue_->clear(); }
-    bool is_empty() const { return queue_->empty(); }
-    uint16_t length() const { return queue_->size(); }
-    size_t max_capacity() const { return max_capacity_; }
+    /**
+     * @brief Materialize a pending command by position (0 is the next one).
+     * @note No bounds checking; callers must ensure index < length().
+     */
+    WoleixCommand at(size_t index) const { return unpack_(queue_[index]); }
+
+    void reset() { queue_.clear(); }
+    bool is_empty() const override { return queue_.empty(); }
+    uint16_t length() const { return queue_.size(); }
+    size_t max_capacity() const { return queue_.capacity(); }
 
 protected:
+    /**
+     * @brief Construct a queue over externally owned slots.
+     * 
+     * @param slots Slot array of at least @p max_capacity elements
+     * @param max_capacity Maximum number of queued commands
+     */
+    WoleixCommandQueue(WoleixPackedCommand* slots, size_t max_capacity)
+      : queue_(slots, max_capacity)
+    {}
+
+    /**
+     * @brief Pack a command, registering its address if needed.
+     * 
+     * The address is only registered once the command is known to pack, so
+     * a rejected command never takes up a slot. The address table is
+     * recycled by enqueue() and begin_plan() whenever the queue is empty.
+     * 
+     * @return Packed command, or nothing if the command does not pack
+     */
+    std::optional<WoleixPackedCommand> pack_(const WoleixCommand& command)
+    {
+        uint8_t slot = 0;
+        while (slot < address_count_ && addresses_[slot] != command.get_address()) slot++;
+
+        auto packed = WoleixPackedCommand::pack(command, slot);
+        if (packed.has_value() && slot == address_count_)
+        {
+            addresses_[address_count_++] = command.get_address();
+        }
+        return packed;
+    }
+
+    WoleixCommand unpack_(const WoleixPackedCommand& packed) const
+    {
+        return packed.unpack(addresses_[packed.address_slot()]);
+    }
 
-    size_t max_capacity_;
-    std::unique_ptr<std::deque<WoleixCommand>> queue_;
+    /**
+     * @brief Publish staged commands and notify producers and consumers.
+     * 
+     * @param count Number of staged commands
+     * @param replace_pending true to drop the normal-priority commands queued before
+     * @param dropped Number of commands the plan already dropped, see drop_pending_()
+     * @return true
+     */
+    bool commit_(size_t count, bool replace_pending, size_t dropped)
+    {
+        size_t first = queue_.size();
+        bool was_empty = first == 0 && dropped == 0;
+        queue_.commit(count);
+
+        size_t removed = dropped;
+        if (replace_pending)
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < queue_.size(); i++)
+            {
+                if (i >= first || queue_[i].is_high_priority()) queue_[kept++] = queue_[i];
+            }
+            first -= queue_.size() - kept;
+            removed += queue_.size() - kept;
+            queue_.truncate(kept);
+        }
+
+        if (queue_.size() >= max_capacity() * QUEUE_HIGH_WATERMARK)
+        {
+            on_queue_at_high_watermark();
+        }
+        for (size_t i = first; i < queue_.size(); i++)
+        {
+            lift_by_priority_(i);
+        }
+
+        if (removed > 0) on_commands_removed_();
+        if (was_empty)
+        {
+            on_command_enqueued();
+        }
+        return true;
+    }
+
+    /**
+     * @brief Count the pending normal-priority commands.
+     */
+    size_t count_pending_() const
+    {
+        size_t pending = 0;
+        for (size_t i = 0; i < queue_.size(); i++)
+        {
+            if (!queue_[i].is_high_priority()) pending++;
+        }
+        return pending;
+    }
+
+    /**
+     * @brief Drop the pending normal-priority commands under an open plan.
+     * 
+     * The staged commands move down with the tail, so that the plan can go
+     * on staging into the room that was freed.
+     * 
+     * @param staged Number of commands staged so far
+     * @return Number of commands dropped
+     */
+    size_t drop_pending_(size_t staged)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < queue_.size(); i++)
+        {
+            if (queue_[i].is_high_priority()) queue_[kept++] = queue_[i];
+        }
+        size_t dropped = queue_.size() - kept;
+        queue_.truncate(kept);
+        for (size_t i = 0; i < staged; i++)
+        {
+            queue_.stage(i, queue_.staged(dropped + i));
+        }
+        return dropped;
+    }
+
+    /**
+     * @brief Move a command into its priority lane.
+     * 
+     * High-priority commands are moved ahead of all normal ones, behind
+     * previously queued high-priority commands.
+     * 
+     * @param index Position of the command
+     */
+    void lift_by_priority_(size_t index)
+    {
+        const WoleixPackedCommand command = queue_[index];
+        if (!command.is_high_priority()) return;
+
+        while (index > 0 && !queue_[index - 1].is_high_priority())
+        {
+            queue_[index] = queue_[index - 1];
+            index--;
+        }
+        queue_[index] = command;
+    }
+
+    /**
+     * @brief Notify producers after pending commands were dropped.
+     */
+    void on_commands_removed_() const
+    {
+        if (queue_.size() <= max_capacity() * QUEUE_LOW_WATERMARK)
+        {
+            on_queue_at_low_watermark();
+        }
+        if (queue_.empty())
+        {
+            on_queue_empty();
+        }
+    }
+
+    WoleixRingBuffer<WoleixPackedCommand> queue_;
+    std::array<uint16_t, WoleixPackedCommand::ADDRESS_SLOTS> addresses_{};  /**< NEC addresses referred to by the slots */
+    uint8_t address_count_{0};  /**< Number of addresses in use */
 
     std::vector<WoleixCommandQueueProducer*> producers_;
-    std::vector<WoleixCommandQueueConsumer*> consumers_;
+};
+
+/**
+ * @brief WoleixCommandQueue with a compile-time capacity.
+ * 
+ * The command slots are a member array, so the whole queue lives wherever
+ * its owner lives (typically inside the climate component) and enqueue/dequeue
+ * never allocate.
+ * 
+ * @tparam Capacity Maximum number of queued commands
+ */
+template<size_t Capacity>
+class WoleixStaticCommandQueue
+  : private WoleixRingBufferStorage<WoleixPackedCommand, Capacity>,
+    public WoleixCommandQueue
+{
+public:
+    WoleixStaticCommandQueue()
+      : WoleixCommandQueue(WoleixRingBufferStorage<WoleixPackedCommand, Capacity>::storage_.data(), Capacity)
+    {}
 };
     
 } // namespace climate_ir_woleix
@@ -3,6 +3,41 @@
 #include <string>
 #include <cstdint>
 
+#include "esphome/core/defines.h"
+
+/**
+ * @name Protocol Timing Profile
+ * Defaults of the timing profile. The `timing:` block of the YAML configuration
+ * overrides them by emitting these defines, so each firmware is compiled with
+ * its own constants.
+ * @{
+ */
+#ifndef WOLEIX_SETTING_MODE_TIMEOUT_MS
+#define WOLEIX_SETTING_MODE_TIMEOUT_MS 5000
+#endif
+#ifndef WOLEIX_SETTING_MODE_ENTER_DELAY_MS
+#define WOLEIX_SETTING_MODE_ENTER_DELAY_MS 150
+#endif
+#ifndef WOLEIX_INTER_COMMAND_DELAY_MS
+#define WOLEIX_INTER_COMMAND_DELAY_MS 200
+#endif
+#ifndef WOLEIX_POWER_GAP_MS
+#define WOLEIX_POWER_GAP_MS WOLEIX_INTER_COMMAND_DELAY_MS
+#endif
+#ifndef WOLEIX_MODE_GAP_MS
+#define WOLEIX_MODE_GAP_MS WOLEIX_INTER_COMMAND_DELAY_MS
+#endif
+#ifndef WOLEIX_TEMP_UP_GAP_MS
+#define WOLEIX_TEMP_UP_GAP_MS WOLEIX_INTER_COMMAND_DELAY_MS
+#endif
+#ifndef WOLEIX_TEMP_DOWN_GAP_MS
+#define WOLEIX_TEMP_DOWN_GAP_MS WOLEIX_INTER_COMMAND_DELAY_MS
+#endif
+#ifndef WOLEIX_FAN_SPEED_GAP_MS
+#define WOLEIX_FAN_SPEED_GAP_MS WOLEIX_INTER_COMMAND_DELAY_MS
+#endif
+/** @} */
+
 namespace esphome {
 namespace climate_ir_woleix {
 
@@ -20,10 +55,18 @@ static const char *const TAG = "climate_ir_woleix.climate";
  * @brief Maximum capacity of the command queue.
  * 
  * This constant defines the maximum number of commands that can be held in the queue
- * before it is considered full.
+ * before it is considered full. It sizes the queue storage at compile time.
  */
 inline constexpr size_t QUEUE_MAX_CAPACITY = 256;
 
+/**
+ * @brief Number of operating modes the MODE button cycles through.
+ * 
+ * Pressing MODE this many times brings the AC unit back to the mode it started in
+ * (COOL -> DEHUM -> FAN -> COOL).
+ */
+inline constexpr size_t MODE_CYCLE_LENGTH = 3;
+
 /**
  * @brief Minimum temperature supported by the Woleix AC unit in Celsius.
  */
@@ -34,6 +77,66 @@ inline constexpr float WOLEIX_TEMP_MIN = 15.0f;
  */
 inline constexpr float WOLEIX_TEMP_MAX = 30.0f;
 
+/**
+ * @name Protocol Timing
+ * Delays observed by the protocol handler between IR transmissions.
+ * @{
+ */
+
+/**
+ * @brief Time the AC unit stays in temperature setting mode after the last temperature press.
+ */
+inline constexpr uint32_t TEMP_SETTING_MODE_TIMEOUT_MS = WOLEIX_SETTING_MODE_TIMEOUT_MS;
+
+/**
+ * @brief Delay after the press that enters temperature setting mode.
+ */
+inline constexpr uint32_t TEMP_ENTER_DELAY_MS = WOLEIX_SETTING_MODE_ENTER_DELAY_MS;
+
+/**
+ * @brief Default delay between two consecutive commands.
+ * 
+ * Individual buttons may use a different gap, see command_gap_ms().
+ */
+inline constexpr uint32_t INTER_COMMAND_DELAY_MS = WOLEIX_INTER_COMMAND_DELAY_MS;
+
+/**
+ * @brief Airtime of a single NEC frame (9 ms leader, 4.5 ms space, 32 bits, stop bit), rounded up.
+ */
+inline constexpr uint32_t NEC_FRAME_DURATION_MS = 68;
+
+static_assert(TEMP_ENTER_DELAY_MS < TEMP_SETTING_MODE_TIMEOUT_MS,
+    "Setting mode must not expire before the entry delay has passed");
+
+/**
+ * @brief Margin before the end of setting mode within which a temperature press no longer relies on it.
+ * 
+ * A press sent closer to the end may reach the unit after it left setting
+ * mode, and would then only reopen it. One frame plus the jitter of the
+ * main loop.
+ */
+inline constexpr uint32_t TEMP_SETTING_MODE_GUARD_MS = NEC_FRAME_DURATION_MS + 100;
+
+static_assert(TEMP_SETTING_MODE_GUARD_MS < TEMP_SETTING_MODE_TIMEOUT_MS,
+    "Setting mode must outlast its guard margin");
+
+/**
+ * @brief Time after the last frame of a transmission within which its echo is expected.
+ * 
+ * A receiver next to the transmitter picks up our own frames. It reports
+ * a frame once it is complete, and the frame is decoded on a later main
+ * loop iteration; frames of the same button arriving later are taken for
+ * presses on the physical remote.
+ */
+inline constexpr uint32_t ECHO_WINDOW_MS = NEC_FRAME_DURATION_MS + 250;
+
+/**
+ * @brief Upper limit for the number of presses merged into a single transmit call.
+ */
+inline constexpr uint32_t BURST_MAX_PRESSES = 16;
+
+/** @} */  // End of Protocol Timing
+
 /**
  * @name IR Command Definitions
  * NEC IR commands for Woleix AC remote control.
@@ -77,6 +180,42 @@ inline constexpr uint16_t TIMER_NEC     = 0xFF00;
 
 /** @} */  // End of IR Command Definitions
 
+/**
+ * @brief Delay after a command before the next one is sent.
+ * 
+ * Resolved at compile time from the timing profile.
+ * 
+ * @param nec_code NEC code of the command
+ * @return Gap in milliseconds
+ */
+inline constexpr uint32_t command_gap_ms(uint16_t nec_code)
+{
+    switch (nec_code)
+    {
+        case POWER_NEC:     return WOLEIX_POWER_GAP_MS;
+        case MODE_NEC:      return WOLEIX_MODE_GAP_MS;
+        case TEMP_UP_NEC:   return WOLEIX_TEMP_UP_GAP_MS;
+        case TEMP_DOWN_NEC: return WOLEIX_TEMP_DOWN_GAP_MS;
+        case SPEED_NEC:     return WOLEIX_FAN_SPEED_GAP_MS;
+        default:            return INTER_COMMAND_DELAY_MS;
+    }
+}
+
+/**
+ * @brief Pause between the frames of a multi-send burst, in microseconds.
+ * 
+ * Keeps the frame starts command_gap_ms() apart, the same spacing as
+ * individually scheduled presses on a non-blocking transmitter.
+ * 
+ * @param nec_code NEC code of the command
+ * @return Pause in microseconds
+ */
+inline constexpr uint32_t burst_send_wait_us(uint16_t nec_code)
+{
+    uint32_t gap = command_gap_ms(nec_code);
+    return gap > NEC_FRAME_DURATION_MS ? (gap - NEC_FRAME_DURATION_MS) * 1000 : 0;
+}
+
 
 }  // namespace climate_ir_woleix
 }  // namespace esphome
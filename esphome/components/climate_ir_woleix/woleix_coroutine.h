@@ -0,0 +1,244 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+#include "woleix_timer.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Fixed pool of coroutine frames.
+ *
+ * Coroutine frames are heap-allocated by default. Coroutines returning a
+ * WoleixTask take their frame from a pool owned by the object they are a
+ * member of instead, so they never allocate: a frame that does not fit, or
+ * a pool that is exhausted, makes the coroutine call return an empty task.
+ *
+ * Each slot starts with a small header pointing back to the pool, so that
+ * frames can be released without knowing their pool. The storage is
+ * provided by WoleixStaticFramePool, which sizes it at compile time.
+ */
+class WoleixFramePool
+{
+public:
+    WoleixFramePool(const WoleixFramePool&) = delete;
+    WoleixFramePool& operator=(const WoleixFramePool&) = delete;
+
+    /**
+     * @brief Take a free slot.
+     * @param size Frame size requested by the compiler
+     * @return Frame memory, or nullptr if it does not fit or no slot is free
+     */
+    void* allocate(size_t size) noexcept
+    {
+        if (size > slot_size_ - HEADER_SIZE) return nullptr;
+        for (size_t i = 0; i < slot_count_; i++)
+        {
+            Header* header = header_(i);
+            if (header->pool != nullptr) continue;
+            header->pool = this;
+            return reinterpret_cast<unsigned char*>(header) + HEADER_SIZE;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Release a frame taken with allocate().
+     * @param frame Frame memory
+     */
+    static void deallocate(void* frame) noexcept
+    {
+        Header* header = reinterpret_cast<Header*>(static_cast<unsigned char*>(frame) - HEADER_SIZE);
+        header->pool = nullptr;
+    }
+
+    /**
+     * @brief Largest frame a slot holds.
+     */
+    size_t max_frame_size() const { return slot_size_ - HEADER_SIZE; }
+
+    /**
+     * @brief Number of slots in use.
+     */
+    size_t used() const
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < slot_count_; i++)
+        {
+            if (header_(i)->pool != nullptr) count++;
+        }
+        return count;
+    }
+
+protected:
+    struct Header
+    {
+        WoleixFramePool* pool;  ///< Owning pool, nullptr while the slot is free
+    };
+
+    /// Header size, keeping frames aligned like operator new would
+    static constexpr size_t HEADER_SIZE = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    WoleixFramePool(unsigned char* storage, size_t slot_size, size_t slot_count)
+      : storage_(storage), slot_size_(slot_size), slot_count_(slot_count)
+    {
+        for (size_t i = 0; i < slot_count_; i++) header_(i)->pool = nullptr;
+    }
+
+    Header* header_(size_t index) const { return reinterpret_cast<Header*>(storage_ + index * slot_size_); }
+
+    unsigned char* storage_;
+    size_t slot_size_;
+    size_t slot_count_;
+};
+
+/**
+ * @brief WoleixFramePool with inline storage.
+ *
+ * @tparam FrameSize Largest frame a slot holds
+ * @tparam SlotCount Number of frames alive at the same time
+ */
+template<size_t FrameSize, size_t SlotCount>
+class WoleixStaticFramePool : public WoleixFramePool
+{
+public:
+    WoleixStaticFramePool()
+      : WoleixFramePool(storage_, SLOT_SIZE, SlotCount)
+    {}
+
+protected:
+    static constexpr size_t SLOT_SIZE =
+        (HEADER_SIZE + FrameSize + __STDCPP_DEFAULT_NEW_ALIGNMENT__ - 1) / __STDCPP_DEFAULT_NEW_ALIGNMENT__ * __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) unsigned char storage_[SLOT_SIZE * SlotCount];
+};
+
+/**
+ * @brief Coroutine driven by timers and events, with a pooled frame.
+ *
+ * Only member functions of a class providing `WoleixFramePool&
+ * coroutine_frame_pool()` can return a WoleixTask; their frame comes from
+ * that pool. The coroutine starts suspended and runs with resume(). It is
+ * destroyed with the task, wherever it is suspended.
+ */
+class WoleixTask
+{
+public:
+    struct promise_type
+    {
+        template<typename Owner, typename... Args>
+        static void* operator new(size_t size, Owner& owner, Args&&...) noexcept
+        {
+            return owner.coroutine_frame_pool().allocate(size);
+        }
+
+        static void operator delete(void* frame) noexcept { WoleixFramePool::deallocate(frame); }
+
+        static WoleixTask get_return_object_on_allocation_failure() noexcept { return WoleixTask(); }
+
+        WoleixTask get_return_object() noexcept
+        {
+            return WoleixTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    WoleixTask() = default;
+    WoleixTask(WoleixTask&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    WoleixTask& operator=(WoleixTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            destroy_();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~WoleixTask() { destroy_(); }
+
+    /**
+     * @brief Whether a coroutine frame was allocated.
+     */
+    explicit operator bool() const { return static_cast<bool>(handle_); }
+
+    /**
+     * @brief Run the coroutine until it suspends.
+     */
+    void resume() const
+    {
+        if (handle_ && !handle_.done()) handle_.resume();
+    }
+
+    /**
+     * @brief Handle of the coroutine, for the awaitables resuming it.
+     */
+    std::coroutine_handle<> handle() const { return handle_; }
+
+private:
+    explicit WoleixTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    void destroy_()
+    {
+        if (handle_) handle_.destroy();
+        handle_ = nullptr;
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * @brief Timer callback resuming a coroutine.
+ *
+ * The handle is a single pointer, so the callback fits WoleixTimerCallback
+ * without allocating.
+ *
+ * @param handle Coroutine to resume
+ */
+inline WoleixTimerCallback woleix_resume_callback(std::coroutine_handle<> handle)
+{
+    return [handle]() { handle.resume(); };
+}
+
+/**
+ * @brief Awaitable suspending a coroutine on a scheduler timer.
+ *
+ * `co_await WoleixSleep(scheduler, id, delay_ms)` resumes the coroutine
+ * from the timer callback, like any other timer. Rescheduling the timer
+ * with woleix_resume_callback() moves the wakeup; cancelling it leaves the
+ * coroutine suspended until it is destroyed.
+ */
+class WoleixSleep
+{
+public:
+    WoleixSleep(WoleixTimerScheduler* scheduler, WoleixTimerId id, uint32_t delay_ms)
+      : scheduler_(scheduler), id_(id), delay_ms_(delay_ms)
+    {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> handle) const
+    {
+        scheduler_->schedule_timer(id_, delay_ms_, woleix_resume_callback(handle));
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    WoleixTimerScheduler* scheduler_;
+    WoleixTimerId id_;
+    uint32_t delay_ms_;
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
@@ -0,0 +1,234 @@
+#include "esphome/core/log.h"
+
+#include "woleix_coroutine_protocol_handler.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * Setup the protocol handler with a command source.
+ *
+ * Starts the sequence on first use; it waits for commands until the
+ * command source is set.
+ *
+ * @param command_queue Pointer to the command queue or mailbox to use
+ */
+void WoleixCoroutineProtocolHandler::setup(WoleixCommandSource* command_queue)
+{
+    if (!task_) restart_();
+    WoleixProtocolHandler::setup(command_queue);
+}
+
+/**
+ * Reset the protocol handler to its initial state.
+ *
+ * The sequence is destroyed wherever it is suspended and starts over.
+ */
+void WoleixCoroutineProtocolHandler::reset()
+{
+    WoleixProtocolHandler::reset();
+    restart_();
+}
+
+void WoleixCoroutineProtocolHandler::restart_()
+{
+    cancel_timeout_(TIMEOUT_NEXT_COMMAND);
+    next_command_at_ms_ = clock_ms_();
+    // Release the frame first: the pool only holds one
+    task_ = WoleixTask();
+    idle_ = false;
+    speculate_ = false;
+
+    task_ = run_();
+    if (!task_)
+    {
+        report(WoleixStatus(WoleixMessages::ProtocolHandler::WX_MESSAGE_FRAME_POOL_EXHAUSTED,
+            static_cast<unsigned>(frame_pool_.max_frame_size())));
+        return;
+    }
+    task_.resume();
+}
+
+/**
+ * The Woleix protocol sequence.
+ *
+ * Runs until the handler is reset or destroyed. Each iteration sends one
+ * press or run of presses, then waits until the device is ready for the
+ * next one.
+ */
+// GCC pairs the frame's operator delete with the global operator new rather
+// than with the promise's, and warns about a mismatch that is not there
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+WoleixTask WoleixCoroutineProtocolHandler::run_()
+{
+    bool started = false;
+    for (;;)
+    {
+        // Wait for work
+        while ((command_queue_ == nullptr || command_queue_->is_empty()) && !speculate_)
+        {
+            if (started)
+            {
+                ESP_LOGD(TAG, "All commands executed");
+                if (on_complete_)
+                {
+                    on_complete_();
+                    on_complete_ = nullptr;
+                }
+            }
+            idle_ = true;
+            co_await std::suspend_always{};
+            started = true;
+        }
+
+        bool missed_complete = false;
+        uint32_t wait_ms = 0;
+        if (speculate_)
+        {
+            // Woken by pre_enter_setting_mode(): open setting mode for the change to come
+            speculate_ = false;
+            ESP_LOGD(TAG, "Speculatively entering temperature setting mode");
+            metrics_.record_setting_mode_entry();
+            transmit_(WoleixCommand(WoleixCommand::Type::TEMP_UP, ADDRESS_NEC));
+            temp_state_ = TempProtocolState::SETTING_ACTIVE;
+            extend_setting_mode_timeout_();
+            missed_complete = co_await gap_(0, TEMP_ENTER_DELAY_MS);
+        }
+        else if (auto next = command_queue_->get(); !next.has_value())
+        {
+            report(WoleixStatus(WoleixMessages::ProtocolHandler::WX_MESSAGE_FAILED_GET_COMMAND));
+            idle_ = true;
+            co_await std::suspend_always{};
+        }
+        else if (WoleixCommand cmd = *next; is_temp_command_(cmd) && close_expiring_setting_mode_(wait_ms))
+        {
+            // Too late for this window, too early for the next one
+            co_await sleep_(wait_ms);
+        }
+        else if (is_temp_command_(cmd) && !is_in_temp_setting_mode_())
+        {
+            // First press only enters setting mode, the command stays queued
+            ESP_LOGD(TAG, "Entering temperature setting mode");
+            metrics_.record_setting_mode_entry();
+            transmit_(cmd);
+            temp_state_ = TempProtocolState::SETTING_ACTIVE;
+            extend_setting_mode_timeout_();
+            missed_complete = co_await gap_(0, TEMP_ENTER_DELAY_MS);
+        }
+        else
+        {
+            bool temp_command = is_temp_command_(cmd);
+            if (temp_command)
+            {
+                ESP_LOGD(TAG, "In setting mode, sending temp command directly");
+                metrics_.record_setting_mode_reuse();
+            }
+            else
+            {
+                ESP_LOGD(TAG, "Sending regular command");
+            }
+
+            uint32_t presses = take_run_(cmd);
+            transmit_run_(cmd, presses);
+            if (temp_command) extend_setting_mode_timeout_(run_span_ms_(cmd, presses));
+            missed_complete = co_await gap_(run_span_ms_(cmd, presses), command_gap_ms(cmd.get_command()));
+        }
+
+        if (missed_complete)
+        {
+            report(WoleixStatus(WoleixMessages::ProtocolHandler::WX_MESSAGE_TRANSMIT_COMPLETE_MISSING));
+        }
+    }
+}
+#pragma GCC diagnostic pop
+
+/**
+ * Wait a fixed delay before looking at the queue again.
+ *
+ * @param delay_ms Delay
+ * @return Awaitable resuming the sequence after the delay
+ */
+WoleixSleep WoleixCoroutineProtocolHandler::sleep_(uint32_t delay_ms)
+{
+    next_command_at_ms_ = clock_ms_() + delay_ms;
+    return WoleixSleep(scheduler_, TIMEOUT_NEXT_COMMAND, delay_ms);
+}
+
+/**
+ * Wait until the next command may be sent.
+ *
+ * Without the transmit complete signal, simply waits the delay. With it,
+ * waits the fixed timing plus one frame duration as a fallback, which
+ * on_transmit_complete() replaces with the quiet gap.
+ *
+ * @param run_span_ms Time from the first to the last frame start of the run
+ * @param delay_ms Delay required after the start of the last frame
+ * @return Awaitable yielding true if the transmit complete signal was missed
+ */
+WoleixCoroutineProtocolHandler::Gap WoleixCoroutineProtocolHandler::gap_(uint32_t run_span_ms, uint32_t delay_ms)
+{
+    if (!wait_for_transmit_complete_)
+    {
+        next_command_at_ms_ = clock_ms_() + run_span_ms + delay_ms;
+        return Gap(scheduler_, run_span_ms + delay_ms, &awaiting_transmit_complete_);
+    }
+
+    awaiting_transmit_complete_ = true;
+    quiet_gap_ms_ = delay_ms > NEC_FRAME_DURATION_MS ? delay_ms - NEC_FRAME_DURATION_MS : 0;
+    next_command_at_ms_ = clock_ms_() + run_span_ms + delay_ms + NEC_FRAME_DURATION_MS;
+    return Gap(scheduler_, run_span_ms + delay_ms + NEC_FRAME_DURATION_MS, &awaiting_transmit_complete_);
+}
+
+/**
+ * Resume the sequence waiting for work.
+ *
+ * Like the callback handler, the command is processed from a zero-delay
+ * timer rather than from within enqueue(), so that a plan enqueued in one
+ * go is seen as a whole. While the sequence waits out a delay, there is
+ * nothing to do: it checks the queue when the delay is over.
+ */
+void WoleixCoroutineProtocolHandler::on_command_enqueued()
+{
+    if (!idle_) return;
+    idle_ = false;
+    set_timeout_(TIMEOUT_NEXT_COMMAND, 0, woleix_resume_callback(task_.handle()));
+}
+
+/**
+ * Open temperature setting mode ahead of an expected temperature change.
+ *
+ * Wakes the sequence, which sends the entry press right away and then
+ * waits for the device to enter setting mode.
+ *
+ * @return true if the entry press was sent
+ */
+bool WoleixCoroutineProtocolHandler::pre_enter_setting_mode()
+{
+    if (!idle_ || is_in_temp_setting_mode_()) return false;
+    if (!command_queue_ || !command_queue_->is_empty()) return false;
+
+    idle_ = false;
+    speculate_ = true;
+    task_.resume();
+    return true;
+}
+
+/**
+ * Handle the end of a transmission.
+ *
+ * Moves the wakeup of the sequence from the fallback to the quiet gap the
+ * device needs after the frame.
+ */
+void WoleixCoroutineProtocolHandler::on_transmit_complete()
+{
+    if (!awaiting_transmit_complete_) return;
+
+    awaiting_transmit_complete_ = false;
+    set_timeout_(TIMEOUT_NEXT_COMMAND, quiet_gap_ms_, woleix_resume_callback(task_.handle()));
+}
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
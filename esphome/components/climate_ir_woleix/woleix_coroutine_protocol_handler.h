@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "woleix_coroutine.h"
+#include "woleix_protocol_handler.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+namespace WoleixCategory::ProtocolHandler
+{
+    inline constexpr auto WX_CATEGORY_FRAME_POOL_EXHAUSTED =
+        Category::make(CategoryId::ProtocolHandler, 6, "ProtocolHandler.FramePoolExhausted");
+}
+
+namespace WoleixMessages::ProtocolHandler
+{
+    inline constexpr WoleixMessage WX_MESSAGE_FRAME_POOL_EXHAUSTED
+    {
+        WoleixSeverity::WX_SEVERITY_ERROR,
+        WoleixCategory::ProtocolHandler::WX_CATEGORY_FRAME_POOL_EXHAUSTED,
+        "No room for the protocol coroutine (frame of %u bytes max)"
+    };
+}
+
+/**
+ * @brief Protocol handler running the Woleix sequence as a coroutine.
+ *
+ * Same protocol, same timers and same public interface as
+ * WoleixProtocolHandler, which it reuses for transmitting, merging bursts
+ * and tracking setting mode. Instead of a chain of timer callbacks
+ * (process_next_command_(), handle_temp_command_(), enter_setting_mode_(),
+ * schedule_after_transmit_()), the whole sequence is one loop in run_(),
+ * which waits for commands and delays with co_await:
+ *
+ *   - no command queued: suspend until one is enqueued
+ *   - temperature command outside setting mode: entry press, wait
+ *   - otherwise: send the run of presses, wait the command gap
+ *
+ * The coroutine frame comes from a fixed pool inside the handler, and the
+ * timers resume it through a WoleixTimerCallback holding only its handle,
+ * so nothing is allocated at run time.
+ *
+ * The expiry of setting mode stays a plain timer: it is not part of the
+ * sequence, just a state change in the background.
+ */
+class WoleixCoroutineProtocolHandler : public WoleixProtocolHandler
+{
+public:
+    /// Frame size reserved for run_()
+    static constexpr size_t FRAME_SIZE = 256;
+
+    /**
+     * @brief Construct a new coroutine protocol handler.
+     *
+     * @param scheduler Timer scheduler used for the protocol delays; must outlive the handler
+     */
+    explicit WoleixCoroutineProtocolHandler(WoleixTimerScheduler* scheduler)
+      : WoleixProtocolHandler(scheduler)
+    {}
+
+    /**
+     * @brief Set up the handler with a command source and start the sequence.
+     *
+     * @param command_queue Pointer to the WoleixCommandSource to use
+     * @see WoleixProtocolHandler::setup()
+     */
+    void setup(WoleixCommandSource* command_queue);
+
+    /**
+     * @brief Reset the handler and restart the sequence from the top.
+     *
+     * @see WoleixProtocolHandler::reset()
+     */
+    void reset();
+
+    /**
+     * @brief Open temperature setting mode ahead of an expected temperature change.
+     *
+     * @return true if the entry press was sent, false if the handler is busy
+     *         or setting mode is already active
+     * @see WoleixProtocolHandler::pre_enter_setting_mode()
+     */
+    bool pre_enter_setting_mode();
+
+    /**
+     * @brief Signal that the transmitter finished sending.
+     *
+     * @see WoleixProtocolHandler::on_transmit_complete()
+     */
+    void on_transmit_complete();
+
+    /**
+     * @brief Pool the coroutine frame is allocated from.
+     */
+    WoleixFramePool& coroutine_frame_pool() { return frame_pool_; }
+
+protected:
+    /**
+     * @brief Wait for the next command slot.
+     *
+     * Resumes with true if the wait ended on the fallback timer, without
+     * the transmit complete signal it was waiting for.
+     */
+    class Gap : public WoleixSleep
+    {
+    public:
+        Gap(WoleixTimerScheduler* scheduler, uint32_t delay_ms, bool* awaiting_transmit_complete)
+          : WoleixSleep(scheduler, WoleixTimerId::NEXT_COMMAND, delay_ms),
+            awaiting_transmit_complete_(awaiting_transmit_complete)
+        {}
+
+        bool await_resume() const noexcept
+        {
+            if (!*awaiting_transmit_complete_) return false;
+            *awaiting_transmit_complete_ = false;
+            return true;
+        }
+
+    private:
+        bool* awaiting_transmit_complete_;
+    };
+
+    /**
+     * @brief The protocol sequence.
+     */
+    WoleixTask run_();
+
+    /**
+     * @brief Wait a fixed delay, e.g. for an expiring setting mode window to close.
+     */
+    WoleixSleep sleep_(uint32_t delay_ms);
+
+    /**
+     * @brief Wait until the next command may be sent.
+     *
+     * Coroutine counterpart of schedule_after_transmit_(): the delay counts
+     * from the start of the last frame, and with the transmit complete
+     * signal, on_transmit_complete() shortens the wait to the quiet gap.
+     *
+     * @param run_span_ms Time from the first to the last frame start of the run
+     * @param delay_ms Delay required after the start of the last frame
+     * @return Awaitable yielding true if the transmit complete signal was missed
+     */
+    Gap gap_(uint32_t run_span_ms, uint32_t delay_ms);
+
+    /**
+     * @brief Destroy the running sequence, if any, and start a new one.
+     */
+    void restart_();
+
+    /**
+     * @brief Resume the sequence waiting for work, through the scheduler.
+     */
+    void on_command_enqueued() override;
+
+    WoleixStaticFramePool<FRAME_SIZE, 1> frame_pool_;
+    WoleixTask task_;
+    bool idle_{false};       ///< Whether run_() waits for work, with no timer pending
+    bool speculate_{false};  ///< Whether run_() was woken to open setting mode
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
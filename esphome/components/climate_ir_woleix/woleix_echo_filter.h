@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Tells our own frames, picked up by the IR receiver, from presses on the remote.
+ *
+ * Every transmission is announced with expect(): the button, the number of
+ * frames sent, and the time by which their echoes must have arrived. A
+ * received frame of that button is taken for an echo, and consumed, as
+ * long as echoes of it are outstanding and not overdue. Echoes that never
+ * arrive (receiver out of sight of the transmitter) expire on their own.
+ *
+ * Transmissions of different buttons are tracked separately, so a late
+ * echo of the setting mode entry press is not mistaken for a remote press
+ * after the next command went out. The slots are fixed; when they run out,
+ * the one due first is given up.
+ */
+class WoleixEchoFilter
+{
+public:
+    /// Number of transmissions whose echoes can be outstanding at the same time
+    static constexpr size_t SLOT_COUNT = 4;
+
+    /**
+     * @brief Announce frames going out.
+     * @param command NEC command code
+     * @param frames Number of frames sent
+     * @param until_ms Time by which the echo of the last frame is due
+     */
+    void expect(uint16_t command, uint32_t frames, uint32_t until_ms)
+    {
+        Pending* slot = nullptr;
+        for (auto& pending : pending_)
+        {
+            if (pending.frames > 0 && pending.command == command)
+            {
+                slot = &pending;
+                break;
+            }
+            if (slot == nullptr || pending.frames == 0 ||
+                (slot->frames > 0 && static_cast<int32_t>(pending.until_ms - slot->until_ms) < 0))
+            {
+                slot = &pending;
+            }
+        }
+
+        if (slot->command != command) slot->frames = 0;
+        slot->command = command;
+        slot->frames += frames;
+        slot->until_ms = until_ms;
+    }
+
+    /**
+     * @brief Check a received frame and consume it if it is an echo.
+     * @param command NEC command code of the received frame
+     * @param now_ms Time the frame was received
+     * @return true if the frame is an echo of our own transmission
+     */
+    bool consume(uint16_t command, uint32_t now_ms)
+    {
+        for (auto& pending : pending_)
+        {
+            if (pending.frames == 0 || pending.command != command) continue;
+            if (static_cast<int32_t>(now_ms - pending.until_ms) > 0)
+            {
+                pending.frames = 0;
+                return false;
+            }
+            pending.frames--;
+            return true;
+        }
+        return false;
+    }
+
+protected:
+    struct Pending
+    {
+        uint16_t command{0};
+        uint32_t frames{0};     ///< Echoes still outstanding, 0 if the slot is free
+        uint32_t until_ms{0};
+    };
+
+    std::array<Pending, SLOT_COUNT> pending_{};
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#ifdef USE_ESP32
+#include <esp_pthread.h>
+#endif
+
+#include "woleix_timer.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Timer scheduler running its callbacks off the main loop.
+ *
+ * Timers scheduled on the ESPHome scheduler fire from the main loop, so
+ * their precision is the loop period at best, and any stall of the loop
+ * (Wi-Fi, API, web server) delays them further. An executor fires them
+ * from its own context instead, for sub-millisecond command gaps.
+ *
+ * Callbacks run with the executor's state mutex held. Code on other tasks
+ * touching the state the callbacks work on must hold it too, see mutex().
+ * The mutex is recursive, so callbacks can call back into code that locks
+ * it. A timer cancelled or rescheduled while its callback waits for the
+ * mutex does not run.
+ */
+class WoleixExecutor : public WoleixTimerScheduler
+{
+public:
+    /**
+     * @brief Start firing timers.
+     * @return false if the executor could not be started
+     */
+    virtual bool start() = 0;
+
+    /**
+     * @brief Stop firing timers; pending timers are dropped.
+     */
+    virtual void stop() = 0;
+
+    /**
+     * @brief Mutex serializing the callbacks with the other tasks.
+     */
+    std::recursive_mutex& mutex() { return mutex_; }
+
+protected:
+    std::recursive_mutex mutex_;
+};
+
+/**
+ * @brief Executor backed by a dedicated std::thread and std::chrono::steady_clock.
+ *
+ * The thread sleeps on a condition variable until the earliest deadline or
+ * until the timers change. On ESP32, std::thread is a pthread, i.e. a
+ * FreeRTOS task of its own, created with TASK_PRIORITY and TASK_STACK_SIZE:
+ * the callbacks, transmits included, never run on a task shared with other
+ * components, such as the esp_timer task. On hosts, it lets the unit tests
+ * measure the jitter of the command gaps.
+ *
+ * Callbacks transmit with the mutex held, so the main loop waits for the
+ * mutex as long as a transmit takes. The remote_transmitter must be
+ * `non_blocking: true`, which only starts the frame and returns.
+ */
+class WoleixThreadExecutor : public WoleixExecutor
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// FreeRTOS priority of the task: above the main loop, below lwIP and Wi-Fi
+    static constexpr int TASK_PRIORITY = 10;
+    /// Stack size of the task, in bytes
+    static constexpr size_t TASK_STACK_SIZE = 4096;
+
+    ~WoleixThreadExecutor() override { stop(); }
+
+    bool start() override
+    {
+        if (thread_.joinable()) return true;
+#ifdef USE_ESP32
+        // Applies to the threads created by this task, until reset below
+        esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+        cfg.thread_name = "woleix";
+        cfg.prio = TASK_PRIORITY;
+        cfg.stack_size = TASK_STACK_SIZE;
+        if (esp_pthread_set_cfg(&cfg) != ESP_OK) return false;
+#endif
+        {
+            std::lock_guard<std::mutex> lock(timers_mutex_);
+            running_ = true;
+        }
+        thread_ = std::thread([this]() { run_(); });
+#ifdef USE_ESP32
+        cfg = esp_pthread_get_default_config();
+        esp_pthread_set_cfg(&cfg);
+#endif
+        return true;
+    }
+
+    void stop() override
+    {
+        {
+            std::lock_guard<std::mutex> lock(timers_mutex_);
+            running_ = false;
+            for (auto& slot : slots_) slot.armed = false;
+        }
+        wake_.notify_one();
+        if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) thread_.join();
+    }
+
+    void schedule_timer(WoleixTimerId id, uint32_t delay_ms, WoleixTimerCallback callback) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(timers_mutex_);
+            Slot& slot = slots_[static_cast<size_t>(id)];
+            slot.deadline = Clock::now() + std::chrono::milliseconds(delay_ms);
+            slot.callback = callback;
+            slot.armed = true;
+            slot.generation++;
+        }
+        wake_.notify_one();
+    }
+
+    void cancel_timer(WoleixTimerId id) override
+    {
+        std::lock_guard<std::mutex> lock(timers_mutex_);
+        Slot& slot = slots_[static_cast<size_t>(id)];
+        slot.armed = false;
+        slot.generation++;
+    }
+
+    /// Whether the caller runs on the executor's thread
+    bool is_current_thread() const { return thread_.get_id() == std::this_thread::get_id(); }
+
+    uint32_t now_ms() const override
+    {
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - epoch_).count());
+    }
+
+protected:
+    struct Slot
+    {
+        Clock::time_point deadline;
+        WoleixTimerCallback callback;
+        uint32_t generation{0};
+        bool armed{false};
+    };
+
+    void run_()
+    {
+        std::unique_lock<std::mutex> lock(timers_mutex_);
+        while (running_)
+        {
+            Slot* next = nullptr;
+            for (auto& slot : slots_)
+            {
+                if (slot.armed && (next == nullptr || slot.deadline < next->deadline)) next = &slot;
+            }
+            if (next == nullptr)
+            {
+                wake_.wait(lock);
+                continue;
+            }
+            if (Clock::now() < next->deadline)
+            {
+                wake_.wait_until(lock, next->deadline);
+                continue;
+            }
+
+            // Copy first: the callback may reschedule the same timer
+            next->armed = false;
+            WoleixTimerCallback fired = next->callback;
+            uint32_t generation = next->generation;
+            lock.unlock();
+            {
+                std::lock_guard<std::recursive_mutex> state_lock(mutex_);
+                if (is_current_(*next, generation)) fired();
+            }
+            lock.lock();
+        }
+    }
+
+    bool is_current_(const Slot& slot, uint32_t generation)
+    {
+        std::lock_guard<std::mutex> lock(timers_mutex_);
+        return running_ && slot.generation == generation;
+    }
+
+    const Clock::time_point epoch_{Clock::now()};
+    std::array<Slot, WOLEIX_TIMER_COUNT> slots_{};
+    std::mutex timers_mutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+    bool running_{false};
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
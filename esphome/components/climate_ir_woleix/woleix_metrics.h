@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "woleix_constants.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Point-in-time copy of the pipeline counters.
+ */
+struct WoleixMetricsSnapshot
+{
+    uint32_t queue_depth{0};            ///< Commands queued when last recorded
+    uint32_t peak_queue_depth{0};       ///< Highest queue depth recorded
+    uint32_t commands_transmitted{0};   ///< NEC frames sent, including setting mode entries
+    uint32_t rejected_plans{0};         ///< Plans the command queue refused
+    uint32_t setting_mode_entries{0};   ///< Presses spent entering temperature setting mode
+    uint32_t setting_mode_reuses{0};    ///< Temperature runs sent while setting mode was already active
+    uint32_t airtime_ms{0};             ///< Total time spent transmitting frames
+    uint32_t plan_latency_p50_ms{0};    ///< Median time from requesting a change to the last frame of its plan
+    uint32_t plan_latency_p95_ms{0};    ///< 95th percentile of the same
+    uint32_t plan_latency_max_ms{0};    ///< Longest time from requesting a change to the last frame of its plan
+};
+
+/**
+ * @brief Fixed-bucket, log-scale histogram of latencies in milliseconds.
+ *
+ * Values below 4 ms get one bucket each; above that, every power of two is
+ * split into four buckets, so a bucket is at most 25 % wide relative to its
+ * lower bound. Latencies of 2^17 ms (~2 min) or more land in the last bucket.
+ * The 68 buckets take a few hundred bytes of RAM and are never resized.
+ *
+ * Recording is a couple of relaxed atomic operations, like the other
+ * counters. Percentiles are reported as the upper bound of the bucket they
+ * fall into, capped at the exact maximum.
+ */
+class WoleixLatencyHistogram
+{
+public:
+    static constexpr size_t SUB_BUCKETS = 4;   ///< Buckets per power of two
+    static constexpr size_t OCTAVES = 16;      ///< Powers of two covered above the linear range
+    static constexpr size_t BUCKET_COUNT = SUB_BUCKETS + OCTAVES * SUB_BUCKETS;
+
+    /**
+     * @brief Record one latency.
+     * @param latency_ms Latency in milliseconds
+     */
+    void record(uint32_t latency_ms)
+    {
+        buckets_[bucket_of(latency_ms)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+
+        uint32_t max = max_ms_.load(std::memory_order_relaxed);
+        while (latency_ms > max && !max_ms_.compare_exchange_weak(max, latency_ms, std::memory_order_relaxed)) {}
+    }
+
+    /**
+     * @brief Estimate a percentile.
+     * @param fraction Percentile as a fraction, e.g. 0.95
+     * @return Upper bound of the bucket holding the percentile, 0 if nothing was recorded
+     */
+    uint32_t percentile(float fraction) const
+    {
+        uint32_t total = count_.load(std::memory_order_relaxed);
+        if (total == 0) return 0;
+
+        // Rank of the percentile among the recorded values, 1-based
+        uint32_t rank = static_cast<uint32_t>(std::ceil(fraction * static_cast<float>(total)));
+        rank = std::clamp<uint32_t>(rank, 1, total);
+
+        uint32_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++)
+        {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return std::min(upper_bound_of(i), max());
+        }
+        return max();
+    }
+
+    uint32_t max() const { return max_ms_.load(std::memory_order_relaxed); }
+    uint32_t count() const { return count_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Bucket a latency falls into.
+     */
+    static size_t bucket_of(uint32_t latency_ms)
+    {
+        if (latency_ms < SUB_BUCKETS) return latency_ms;
+
+        size_t octave = static_cast<size_t>(std::bit_width(latency_ms)) - 1;  // floor(log2), >= 2
+        if (octave >= OCTAVES + 2) return BUCKET_COUNT - 1;
+
+        size_t sub = (latency_ms >> (octave - 2)) & (SUB_BUCKETS - 1);
+        return SUB_BUCKETS + (octave - 2) * SUB_BUCKETS + sub;
+    }
+
+    /**
+     * @brief Smallest latency above a bucket, in milliseconds.
+     */
+    static uint32_t upper_bound_of(size_t bucket)
+    {
+        if (bucket < SUB_BUCKETS) return static_cast<uint32_t>(bucket + 1);
+
+        size_t octave = (bucket - SUB_BUCKETS) / SUB_BUCKETS + 2;
+        size_t sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+        return static_cast<uint32_t>((SUB_BUCKETS + sub + 1) << (octave - 2));
+    }
+
+protected:
+    std::array<std::atomic<uint32_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint32_t> count_{0};
+    std::atomic<uint32_t> max_ms_{0};
+};
+
+/**
+ * @brief Counters describing what the command pipeline is doing.
+ *
+ * Updated on the hot path (planning, transmission), so every update is a
+ * single relaxed atomic operation: no locks, and safe to bump from another
+ * task than the one publishing. The counters are only ever read as a whole
+ * through snapshot(), which is what the sensors are fed from.
+ *
+ * All counters are cumulative and wrap around at 2^32; rates are derived by
+ * the reader from two snapshots.
+ */
+class WoleixMetrics
+{
+public:
+    /**
+     * @brief Record the current command queue depth.
+     * @param depth Number of queued commands
+     */
+    void record_queue_depth(size_t depth)
+    {
+        uint32_t value = static_cast<uint32_t>(depth);
+        queue_depth_.store(value, std::memory_order_relaxed);
+
+        uint32_t peak = peak_queue_depth_.load(std::memory_order_relaxed);
+        while (value > peak && !peak_queue_depth_.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {}
+    }
+
+    /**
+     * @brief Record frames that went out over IR.
+     * @param frames Number of NEC frames sent
+     */
+    void record_frames(uint32_t frames)
+    {
+        commands_transmitted_.fetch_add(frames, std::memory_order_relaxed);
+        airtime_ms_.fetch_add(frames * NEC_FRAME_DURATION_MS, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Record the time from enqueueing a plan to its last frame.
+     * @param latency_ms Latency in milliseconds
+     */
+    void record_plan_latency(uint32_t latency_ms) { plan_latency_.record(latency_ms); }
+
+    const WoleixLatencyHistogram& plan_latency() const { return plan_latency_; }
+
+    void record_rejected_plan() { rejected_plans_.fetch_add(1, std::memory_order_relaxed); }
+    void record_setting_mode_entry() { setting_mode_entries_.fetch_add(1, std::memory_order_relaxed); }
+    void record_setting_mode_reuse() { setting_mode_reuses_.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief Read all counters.
+     *
+     * Each counter is read atomically; the set is not, which is fine for
+     * monitoring purposes.
+     */
+    WoleixMetricsSnapshot snapshot() const
+    {
+        WoleixMetricsSnapshot snapshot;
+        snapshot.queue_depth = queue_depth_.load(std::memory_order_relaxed);
+        snapshot.peak_queue_depth = peak_queue_depth_.load(std::memory_order_relaxed);
+        snapshot.commands_transmitted = commands_transmitted_.load(std::memory_order_relaxed);
+        snapshot.rejected_plans = rejected_plans_.load(std::memory_order_relaxed);
+        snapshot.setting_mode_entries = setting_mode_entries_.load(std::memory_order_relaxed);
+        snapshot.setting_mode_reuses = setting_mode_reuses_.load(std::memory_order_relaxed);
+        snapshot.airtime_ms = airtime_ms_.load(std::memory_order_relaxed);
+        snapshot.plan_latency_p50_ms = plan_latency_.percentile(0.50f);
+        snapshot.plan_latency_p95_ms = plan_latency_.percentile(0.95f);
+        snapshot.plan_latency_max_ms = plan_latency_.max();
+        return snapshot;
+    }
+
+    /**
+     * @brief Convert a counter increase into a per-minute rate.
+     * @param delta Counter increase, wrap-around safe when computed as a difference
+     * @param interval_ms Time over which the counter increased
+     * @return Rate per minute, 0 for an empty interval
+     */
+    static float per_minute(uint32_t delta, uint32_t interval_ms)
+    {
+        if (interval_ms == 0) return 0.0f;
+        return static_cast<float>(delta) * 60000.0f / static_cast<float>(interval_ms);
+    }
+
+protected:
+    std::atomic<uint32_t> queue_depth_{0};
+    std::atomic<uint32_t> peak_queue_depth_{0};
+    std::atomic<uint32_t> commands_transmitted_{0};
+    std::atomic<uint32_t> rejected_plans_{0};
+    std::atomic<uint32_t> setting_mode_entries_{0};
+    std::atomic<uint32_t> setting_mode_reuses_{0};
+    std::atomic<uint32_t> airtime_ms_{0};
+    WoleixLatencyHistogram plan_latency_;
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
@@ -0,0 +1,70 @@
+#include "woleix_nec_pulse_cache.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * Encode the frames of all buttons.
+ * 
+ * @param address NEC address of the AC unit
+ */
+void WoleixNecPulseCache::build(uint16_t address)
+{
+    address_ = address;
+    for (size_t i = 0; i < COMMANDS.size(); i++)
+    {
+        encode(address, COMMANDS[i], frames_[i]);
+    }
+    built_ = true;
+}
+
+/**
+ * Look up the pre-encoded frame of a command.
+ * 
+ * @param address NEC address
+ * @param command NEC command code
+ * @return Raw timings, or nullptr if not built or the frame is not cached
+ */
+const RawTimings* WoleixNecPulseCache::get(uint16_t address, uint16_t command) const
+{
+    if (!built_ || address != address_) return nullptr;
+
+    for (size_t i = 0; i < COMMANDS.size(); i++)
+    {
+        if (COMMANDS[i] == command) return &frames_[i];
+    }
+    return nullptr;
+}
+
+/**
+ * Encode a single NEC frame.
+ * 
+ * @param address NEC address
+ * @param command NEC command code
+ * @param timings Buffer to fill, cleared first
+ */
+void WoleixNecPulseCache::encode(uint16_t address, uint16_t command, RawTimings& timings)
+{
+    timings.clear();
+    timings.reserve(FRAME_TIMING_COUNT);
+
+    timings.push_back(static_cast<int32_t>(HEADER_MARK_US));
+    timings.push_back(-static_cast<int32_t>(HEADER_SPACE_US));
+    encode_word_(address, timings);
+    encode_word_(command, timings);
+    timings.push_back(static_cast<int32_t>(BIT_MARK_US));
+}
+
+void WoleixNecPulseCache::encode_word_(uint16_t word, RawTimings& timings)
+{
+    for (uint16_t mask = 1; mask; mask <<= 1)
+    {
+        timings.push_back(static_cast<int32_t>(BIT_MARK_US));
+        timings.push_back(-static_cast<int32_t>((word & mask) ? ONE_SPACE_US : ZERO_SPACE_US));
+    }
+}
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "esphome/components/remote_base/remote_base.h"
+
+#include "woleix_constants.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+using remote_base::RawTimings;
+
+/**
+ * @brief Pre-encoded NEC pulse trains for the Woleix remote buttons.
+ *
+ * The AC unit only understands a handful of NEC frames, so there is no point
+ * in running the NEC encoder for every press. build() encodes each button
+ * once into a raw timing buffer (marks positive, spaces negative, as in
+ * ESPHome's RawTimings), which the protocol handler then sends as is.
+ *
+ * Frames are encoded the same way as ESPHome's NECProtocol: header, 16
+ * address bits and 16 command bits (LSB first), and a trailing stop mark.
+ * Only single frames without NEC repeat codes are cached.
+ */
+class WoleixNecPulseCache
+{
+public:
+    /// Carrier frequency of the NEC protocol
+    static constexpr uint32_t CARRIER_FREQUENCY_HZ = 38000;
+
+    static constexpr uint32_t HEADER_MARK_US = 9000;
+    static constexpr uint32_t HEADER_SPACE_US = 4500;
+    static constexpr uint32_t BIT_MARK_US = 560;
+    static constexpr uint32_t ONE_SPACE_US = 1690;
+    static constexpr uint32_t ZERO_SPACE_US = 560;
+
+    /// Number of timings in a frame: header, 32 bits as mark/space pairs, stop mark
+    static constexpr size_t FRAME_TIMING_COUNT = 2 + 2 * 32 + 1;
+
+    /// NEC codes of all buttons on the remote
+    static constexpr std::array<uint16_t, 6> COMMANDS =
+    {
+        POWER_NEC, TEMP_UP_NEC, TEMP_DOWN_NEC, MODE_NEC, SPEED_NEC, TIMER_NEC
+    };
+
+    /**
+     * @brief Encode the frames of all buttons.
+     *
+     * Allocates once; intended to be called during setup.
+     *
+     * @param address NEC address of the AC unit
+     */
+    void build(uint16_t address = ADDRESS_NEC);
+
+    /**
+     * @brief Look up the pre-encoded frame of a command.
+     *
+     * @param address NEC address
+     * @param command NEC command code
+     * @return Raw timings, or nullptr if the frame is not cached
+     */
+    const RawTimings* get(uint16_t address, uint16_t command) const;
+
+    /**
+     * @brief Check whether build() has been called.
+     */
+    bool is_built() const { return built_; }
+
+    /**
+     * @brief Encode a single NEC frame.
+     *
+     * @param address NEC address
+     * @param command NEC command code
+     * @param timings Buffer to fill, cleared first
+     */
+    static void encode(uint16_t address, uint16_t command, RawTimings& timings);
+
+private:
+    static void encode_word_(uint16_t word, RawTimings& timings);
+
+    std::array<RawTimings, COMMANDS.size()> frames_{};
+    uint16_t address_{ADDRESS_NEC};
+    bool built_{false};
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
@@ -0,0 +1,337 @@
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <limits>
+
+#include "woleix_path_planner.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * Number of temperature steps between WOLEIX_TEMP_MIN and WOLEIX_TEMP_MAX (inclusive).
+ */
+static constexpr size_t TEMP_STEP_COUNT = static_cast<size_t>(WOLEIX_TEMP_MAX - WOLEIX_TEMP_MIN) + 1;
+
+/**
+ * Number of nodes in the state graph: power x mode x temperature x fan speed x setting mode.
+ */
+static constexpr size_t NODE_COUNT = 2 * MODE_CYCLE_LENGTH * TEMP_STEP_COUNT * 2 * 2;
+
+/**
+ * Buttons considered when expanding a node, in the order move_to() uses them.
+ */
+static constexpr std::array<WoleixCommand::Type, 5> PLANNER_BUTTONS =
+{
+    WoleixCommand::Type::POWER,
+    WoleixCommand::Type::MODE,
+    WoleixCommand::Type::TEMP_UP,
+    WoleixCommand::Type::TEMP_DOWN,
+    WoleixCommand::Type::FAN_SPEED
+};
+
+/**
+ * Unreachable node marker; the longest plan (~5 s) fits easily into 16 bits.
+ */
+static constexpr uint16_t INFINITE_COST = std::numeric_limits<uint16_t>::max();
+
+/**
+ * End of an unbounded setting mode window, as kept per node.
+ */
+static constexpr uint16_t UNBOUNDED_WINDOW = std::numeric_limits<uint16_t>::max();
+
+static uint16_t pack_window_(const WoleixSettingModeWindow& window)
+{
+    if (window.closes_at_ms == WoleixSettingModeWindow::UNBOUNDED) return UNBOUNDED_WINDOW;
+    return static_cast<uint16_t>(std::min<uint32_t>(window.closes_at_ms, UNBOUNDED_WINDOW - 1));
+}
+
+static WoleixSettingModeWindow unpack_window_(uint16_t closes_at_ms)
+{
+    if (closes_at_ms == UNBOUNDED_WINDOW) return WoleixSettingModeWindow::unbounded();
+    return WoleixSettingModeWindow::open_for(closes_at_ms);
+}
+
+static size_t temp_index_(float temperature)
+{
+    float steps = std::round(std::clamp(temperature, WOLEIX_TEMP_MIN, WOLEIX_TEMP_MAX) - WOLEIX_TEMP_MIN);
+    return static_cast<size_t>(steps);
+}
+
+static size_t encode_(const WoleixInternalState& state, bool setting_mode_active)
+{
+    size_t index = static_cast<size_t>(state.power);
+    index = index * MODE_CYCLE_LENGTH + static_cast<size_t>(state.mode);
+    index = index * TEMP_STEP_COUNT + temp_index_(state.temperature);
+    index = index * 2 + static_cast<size_t>(state.fan_speed);
+    index = index * 2 + (setting_mode_active ? 1 : 0);
+    return index;
+}
+
+static WoleixInternalState decode_(size_t index, bool& setting_mode_active)
+{
+    setting_mode_active = (index % 2) != 0;
+    index /= 2;
+    auto fan_speed = static_cast<WoleixFanSpeed>(index % 2);
+    index /= 2;
+    float temperature = WOLEIX_TEMP_MIN + static_cast<float>(index % TEMP_STEP_COUNT);
+    index /= TEMP_STEP_COUNT;
+    auto mode = static_cast<WoleixMode>(index % MODE_CYCLE_LENGTH);
+    index /= MODE_CYCLE_LENGTH;
+    auto power = static_cast<WoleixPowerState>(index);
+    return WoleixInternalState(power, mode, temperature, fan_speed);
+}
+
+/**
+ * Check whether a press changes anything worth planning for.
+ *
+ * Fan speed is only considered in FAN mode, like move_to() does.
+ */
+static bool is_useful_press_(const WoleixInternalState& state, WoleixCommand::Type type)
+{
+    if (type == WoleixCommand::Type::POWER) return true;
+    if (state.power != WoleixPowerState::ON) return false;
+
+    switch (type)
+    {
+        case WoleixCommand::Type::MODE:
+            return true;
+        case WoleixCommand::Type::TEMP_UP:
+            return state.mode == WoleixMode::COOL && state.temperature < WOLEIX_TEMP_MAX;
+        case WoleixCommand::Type::TEMP_DOWN:
+            return state.mode == WoleixMode::COOL && state.temperature > WOLEIX_TEMP_MIN;
+        case WoleixCommand::Type::FAN_SPEED:
+            return state.mode == WoleixMode::FAN;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Find the cheapest command sequence from one state to another.
+ *
+ * Runs Dijkstra's algorithm with a linear scan for the closest node, which
+ * beats a heap at this graph size.
+ * Ties are broken by expanding buttons in move_to() order, so among equally
+ * cheap plans the one move_to() would produce is preferred.
+ *
+ * @param from State the AC unit is in
+ * @param to Target state
+ * @param setting_mode_active Whether temperature setting mode is already active
+ * @return Cheapest plan
+ */
+WoleixPlan WoleixPathPlanner::plan
+(
+    const WoleixInternalState& from,
+    const WoleixInternalState& to,
+    bool setting_mode_active
+)
+{
+    return plan(from, to, setting_mode_active ? WoleixSettingModeWindow::unbounded() : WoleixSettingModeWindow::closed());
+}
+
+/**
+ * Find the cheapest command sequence, starting into a setting mode window.
+ *
+ * Same search, with the end of the setting mode window kept for each node
+ * next to its distance. The per-node arrays live on the stack of the caller,
+ * which may be the dedicated executor's task, so every entry is 16 bits: the
+ * window end is clamped like the distance, and the predecessor is kept with
+ * the button pressed there as one step index.
+ *
+ * @param from State the AC unit is in
+ * @param to Target state
+ * @param window Setting mode window when the first command goes out
+ * @return Cheapest plan
+ */
+WoleixPlan WoleixPathPlanner::plan
+(
+    const WoleixInternalState& from,
+    const WoleixInternalState& to,
+    const WoleixSettingModeWindow& window
+)
+{
+    // Plan on the whole-degree grid the graph is built from
+    bool ignored;
+    const WoleixInternalState goal = decode_(encode_(normalize(from, to), false), ignored);
+    const size_t start = encode_(from, window.is_open_at(0));
+
+    static_assert(NODE_COUNT * PLANNER_BUTTONS.size() <= std::numeric_limits<uint16_t>::max());
+
+    std::array<uint16_t, NODE_COUNT> dist;
+    std::array<uint16_t, NODE_COUNT> steps;      // Predecessor * PLANNER_BUTTONS.size() + button
+    std::array<uint16_t, NODE_COUNT> windows;    // Packed setting mode window end
+    std::bitset<NODE_COUNT> done;
+    dist.fill(INFINITE_COST);
+    dist[start] = 0;
+    windows[start] = pack_window_(window);
+
+    size_t reached = NODE_COUNT;
+    while (true)
+    {
+        size_t node = NODE_COUNT;
+        for (size_t i = 0; i < NODE_COUNT; i++)
+        {
+            if (!done[i] && dist[i] != INFINITE_COST && (node == NODE_COUNT || dist[i] < dist[node]))
+            {
+                node = i;
+            }
+        }
+        if (node == NODE_COUNT) break;
+        done[node] = true;
+
+        bool active;
+        WoleixInternalState state = decode_(node, active);
+        if (!WoleixStateManager::next_command(state, goal).has_value())
+        {
+            reached = node;
+            break;
+        }
+
+        for (size_t button = 0; button < PLANNER_BUTTONS.size(); button++)
+        {
+            const WoleixCommand::Type type = PLANNER_BUTTONS[button];
+            if (!is_useful_press_(state, type)) continue;
+
+            WoleixSettingModeWindow next_window = unpack_window_(windows[node]);
+            uint32_t cost = dist[node] + press_cost(type, dist[node], next_window);
+            WoleixInternalState next_state = state;
+            WoleixStateManager::apply(next_state, type);
+
+            size_t next = encode_(next_state, next_window.is_open_at(cost));
+            if (!done[next] && cost < dist[next])
+            {
+                dist[next] = static_cast<uint16_t>(cost);
+                steps[next] = static_cast<uint16_t>(node * PLANNER_BUTTONS.size() + button);
+                windows[next] = pack_window_(next_window);
+            }
+        }
+    }
+
+    WoleixPlan result;
+    result.state = from;
+    if (reached == NODE_COUNT) return result;
+
+    for (size_t node = reached; node != start; node = steps[node] / PLANNER_BUTTONS.size())
+    {
+        result.commands.push_back(PLANNER_BUTTONS[steps[node] % PLANNER_BUTTONS.size()]);
+    }
+    std::reverse(result.commands.begin(), result.commands.end());
+
+    for (auto type : result.commands)
+    {
+        WoleixStateManager::apply(result.state, type);
+    }
+    result.cost_ms = dist[reached];
+    return result;
+}
+
+/**
+ * Compute the transmission time of a command sequence.
+ *
+ * @param commands Logical button presses
+ * @param setting_mode_active Whether temperature setting mode is already active
+ * @return Total cost in milliseconds
+ */
+uint32_t WoleixPathPlanner::cost
+(
+    const std::vector<WoleixCommand::Type>& commands,
+    bool setting_mode_active
+)
+{
+    uint32_t total = 0;
+    for (auto type : commands)
+    {
+        total += press_cost(type, setting_mode_active);
+    }
+    return total;
+}
+
+/**
+ * Compute the transmission time of a command sequence, starting into a setting mode window.
+ *
+ * @param commands Logical button presses
+ * @param window Setting mode window when the first command goes out
+ * @return Total cost in milliseconds
+ */
+uint32_t WoleixPathPlanner::cost
+(
+    const std::vector<WoleixCommand::Type>& commands,
+    const WoleixSettingModeWindow& window
+)
+{
+    WoleixSettingModeWindow current = window;
+    uint32_t total = 0;
+    for (auto type : commands)
+    {
+        total += press_cost(type, total, current);
+    }
+    return total;
+}
+
+/**
+ * Compute the cost of a single press.
+ *
+ * Mirrors the protocol handler: the first temperature press is preceded by
+ * an extra press entering setting mode, which then stays active.
+ *
+ * @param type Button pressed
+ * @param setting_mode_active Whether temperature setting mode is active, updated in place
+ * @return Cost in milliseconds
+ */
+uint32_t WoleixPathPlanner::press_cost(WoleixCommand::Type type, bool& setting_mode_active)
+{
+    bool is_temp = type == WoleixCommand::Type::TEMP_UP || type == WoleixCommand::Type::TEMP_DOWN;
+    if (!is_temp || setting_mode_active) return press_cost_ms(type);
+
+    setting_mode_active = true;
+    return SETTING_MODE_ENTRY_COST_MS + press_cost_ms(type);
+}
+
+/**
+ * Compute the cost of a single press sent into a setting mode window.
+ *
+ * Mirrors the protocol handler: a temperature press that cannot reuse the
+ * window waits for it to close, if it is about to, and is preceded by the
+ * press entering setting mode. Every temperature press keeps the window
+ * open for TEMP_SETTING_MODE_TIMEOUT_MS from the time it goes out.
+ *
+ * @param type Button pressed
+ * @param at_ms Time the press is due, relative to the window
+ * @param window Setting mode window, extended in place
+ * @return Cost in milliseconds
+ */
+uint32_t WoleixPathPlanner::press_cost(WoleixCommand::Type type, uint32_t at_ms, WoleixSettingModeWindow& window)
+{
+    bool is_temp = type == WoleixCommand::Type::TEMP_UP || type == WoleixCommand::Type::TEMP_DOWN;
+    if (!is_temp) return press_cost_ms(type);
+
+    uint32_t delay = 0;
+    if (!window.is_reusable_at(at_ms))
+    {
+        delay = window.wait_for_close_at(at_ms) + SETTING_MODE_ENTRY_COST_MS;
+    }
+    window.extend(at_ms + delay);
+    return delay + press_cost_ms(type);
+}
+
+/**
+ * Resolve the state move_to() would end up in.
+ *
+ * @param from State the AC unit is in
+ * @param to Requested target state
+ * @return Normalized target state
+ */
+WoleixInternalState WoleixPathPlanner::normalize(const WoleixInternalState& from, const WoleixInternalState& to)
+{
+    WoleixInternalState result = to;
+    float target_temp = std::clamp(to.temperature, WOLEIX_TEMP_MIN, WOLEIX_TEMP_MAX);
+    result.temperature = from.temperature + std::round(target_temp - from.temperature);
+    return result;
+}
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "woleix_constants.h"
+#include "woleix_command.h"
+#include "woleix_state_manager.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Command sequence found by the planner, with its total airtime.
+ */
+struct WoleixPlan
+{
+    std::vector<WoleixCommand::Type> commands;  /**< Logical button presses, in transmission order */
+    WoleixInternalState state;                  /**< State reached after the last command */
+    uint32_t cost_ms{0};                        /**< Time needed to transmit the sequence */
+};
+
+/**
+ * @brief Cost-based shortest-path planner over the Woleix device state graph.
+ *
+ * Every (power, mode, temperature, fan speed) combination is a node, and every
+ * button press that changes it is an edge weighted by the time the protocol
+ * handler needs to transmit it:
+ * - a regular press costs one NEC frame plus the gap configured for its button
+ * - the first temperature press additionally costs the extra press entering
+ *   setting mode plus the setting mode entry delay
+ *
+ * Whether setting mode is active is part of the node, so the extra press is
+ * charged only once per run of temperature presses. Dijkstra's algorithm then
+ * yields the cheapest sequence reaching a state that satisfies the target the
+ * same way move_to() does (temperature only in COOL, fan speed only in FAN).
+ *
+ * The setting mode window can be given with the time it has left, e.g. the
+ * window a previous plan left open. A temperature press reuses it only while
+ * it is at least TEMP_SETTING_MODE_GUARD_MS from closing; a press that would
+ * land in that margin waits for the window to close and pays the entry. The
+ * end of the window is carried along the cheapest path to each node rather
+ * than being part of the node: paths only differ in it after a temperature
+ * press of their own, whose window outlasts the rest of any cheapest plan.
+ *
+ * The graph has 384 nodes, so the planner runs over fixed-size arrays and
+ * allocates only for the returned command list. The arrays take about 2.3 KB
+ * of the caller's stack, which must leave room for them, see
+ * WoleixThreadExecutor::TASK_STACK_SIZE.
+ *
+ * Usage example:
+ * @code
+ * WoleixPlan plan = WoleixPathPlanner::plan(current, target);
+ * for (auto type : plan.commands) queue.enqueue(factory.create(type));
+ * @endcode
+ */
+class WoleixPathPlanner
+{
+public:
+    /// Cost of a regular button press: its frame plus the gap after it
+    static constexpr uint32_t press_cost_ms(WoleixCommand::Type type)
+    {
+        return NEC_FRAME_DURATION_MS + command_gap_ms(static_cast<uint16_t>(type));
+    }
+    /// Extra cost of the press entering temperature setting mode
+    static constexpr uint32_t SETTING_MODE_ENTRY_COST_MS = NEC_FRAME_DURATION_MS + TEMP_ENTER_DELAY_MS;
+
+    /**
+     * @brief Find the cheapest command sequence from one state to another.
+     *
+     * @param from State the AC unit is in
+     * @param to Target state (clamped and rounded like move_to() does)
+     * @param setting_mode_active Whether temperature setting mode is already active
+     * @return Cheapest plan; empty if @p from already satisfies @p to
+     */
+    static WoleixPlan plan
+    (
+        const WoleixInternalState& from,
+        const WoleixInternalState& to,
+        bool setting_mode_active = false
+    );
+
+    /**
+     * @brief Find the cheapest command sequence, starting into a setting mode window.
+     *
+     * @param from State the AC unit is in
+     * @param to Target state (clamped and rounded like move_to() does)
+     * @param window Setting mode window when the first command goes out
+     * @return Cheapest plan, including the time spent waiting for a window to close
+     */
+    static WoleixPlan plan
+    (
+        const WoleixInternalState& from,
+        const WoleixInternalState& to,
+        const WoleixSettingModeWindow& window
+    );
+
+    /**
+     * @brief Compute the transmission time of a command sequence.
+     *
+     * @param commands Logical button presses
+     * @param setting_mode_active Whether temperature setting mode is already active
+     * @return Total cost in milliseconds
+     */
+    static uint32_t cost
+    (
+        const std::vector<WoleixCommand::Type>& commands,
+        bool setting_mode_active = false
+    );
+
+    /**
+     * @brief Compute the transmission time of a command sequence, starting into a setting mode window.
+     *
+     * @param commands Logical button presses
+     * @param window Setting mode window when the first command goes out
+     * @return Total cost in milliseconds
+     */
+    static uint32_t cost
+    (
+        const std::vector<WoleixCommand::Type>& commands,
+        const WoleixSettingModeWindow& window
+    );
+
+    /**
+     * @brief Compute the cost of a single press.
+     *
+     * @param type Button pressed
+     * @param setting_mode_active Whether temperature setting mode is active,
+     *        updated in place
+     * @return Cost in milliseconds
+     */
+    static uint32_t press_cost(WoleixCommand::Type type, bool& setting_mode_active);
+
+    /**
+     * @brief Compute the cost of a single press sent into a setting mode window.
+     *
+     * @param type Button pressed
+     * @param at_ms Time the press is due, relative to the window
+     * @param window Setting mode window, extended in place by temperature presses
+     * @return Cost in milliseconds, including any wait for the window to close
+     */
+    static uint32_t press_cost(WoleixCommand::Type type, uint32_t at_ms, WoleixSettingModeWindow& window);
+
+    /**
+     * @brief Resolve the state move_to() would end up in.
+     *
+     * @param from State the AC unit is in
+     * @param to Requested target state
+     * @return @p to with the temperature clamped and a whole number of degrees away from @p from
+     */
+    static WoleixInternalState normalize(const WoleixInternalState& from, const WoleixInternalState& to);
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
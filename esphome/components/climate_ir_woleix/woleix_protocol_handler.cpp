@@ -17,29 +17,26 @@ using remote_base::NECData;
 using remote_base::NECProtocol;
 
 /**
- * Setup the protocol handler with a command queue.
+ * Setup the protocol handler with a command source.
  * 
- * @param command_queue Pointer to the command queue to use
+ * Also pre-encodes the NEC frames of all buttons on first use.
+ * 
+ * @param command_queue Pointer to the command queue or mailbox to use
  */
-void WoleixProtocolHandler::setup(WoleixCommandQueue* command_queue)
+void WoleixProtocolHandler::setup(WoleixCommandSource* command_queue)
 {
+    if (!pulse_cache_.is_built()) pulse_cache_.build();
+
     if (command_queue)
     {
+        if (command_queue_) command_queue_->unregister_consumer(this);
         command_queue_ = command_queue;
         command_queue_->register_consumer(this);
-        if (command_queue_->length() > 0) on_command_enqueued();
+        if (!command_queue_->is_empty()) on_command_enqueued();
     }
     else
     {
-        report
-        (
-            WoleixStatus
-            (
-                WoleixStatus::Severity::WX_SEVERITY_ERROR,
-                WoleixCategory::ProtocolHandler::WX_CATEGORY_INVALID_COMMAND_QUEUE,
-                "Invalid (null) command queue received during setup"
-            )
-        );
+        report(WoleixStatus(WoleixMessages::ProtocolHandler::WX_MESSAGE_INVALID_COMMAND_QUEUE));
     }
 }
 
@@ -53,15 +50,7 @@ void WoleixProtocolHandler::process_next_command_()
 {
     if (!command_queue_)
     {
-        report
-        (
-            WoleixStatus
-            (
-                WoleixStatus::Severity::WX_SEVERITY_WARNING,
-                WoleixCategory::ProtocolHandler::WX_CATEGORY_COMMAND_QUEUE_NOT_SET,
-                "Command queue not set during processing"
-            )
-        );
+        report(WoleixStatus(WoleixMessages::ProtocolHandler::WX_MESSAGE_COMMAND_QUEUE_NOT_SET));
     }
     else if (command_queue_->is_empty())
     {
@@ -75,16 +64,7 @@ void WoleixProtocolHandler::process_next_command_()
     }
     else if (!command_queue_->get().has_value())
     {
-        report
-        (
-            WoleixStatus
-            (
-                WoleixStatus::Severity::WX_SEVERITY_ERROR,
-                WoleixCategory::ProtocolHandler::WX_CATEGORY_FAILED_GET_COMMAND,
-                "Failed getting command from (non-empty) command queue"
-            )
-
-        );
+        report(WoleixStatus(WoleixMessages::ProtocolHandler::WX_MESSAGE_FAILED_GET_COMMAND));
     }
     else
     {
@@ -111,6 +91,13 @@ void WoleixProtocolHandler::process_next_command_()
  */
 void WoleixProtocolHandler::handle_temp_command_(const WoleixCommand& cmd)
 {
+    uint32_t wait_ms;
+    if (close_expiring_setting_mode_(wait_ms))
+    {
+        schedule_next_command_(wait_ms);
+        return;
+    }
+
     switch (temp_state_)
     {
         case TempProtocolState::IDLE:
@@ -120,21 +107,24 @@ void WoleixProtocolHandler::handle_temp_command_(const WoleixCommand& cmd)
             
         case TempProtocolState::SETTING_ACTIVE:
             // Already in setting mode, send directly
+        {
             ESP_LOGD(TAG, "In setting mode, sending temp command directly");
-            transmit_(cmd);
-            command_queue_->dequeue();
-            extend_setting_mode_timeout_();
+            metrics_.record_setting_mode_reuse();
+            uint32_t presses = take_run_(cmd);
+            transmit_run_(cmd, presses);
+            extend_setting_mode_timeout_(run_span_ms_(cmd, presses));
                         
             // Schedule next command with delay
-            set_timeout_(TIMEOUT_NEXT_COMMAND, INTER_COMMAND_DELAY_MS, 
-                [this]() { process_next_command_(); });
+            schedule_after_transmit_(run_span_ms_(cmd, presses), command_gap_ms(cmd.get_command()));
             break;
+        }
     }
 }
 
 void WoleixProtocolHandler::enter_setting_mode_(const WoleixCommand& cmd)
 {
     ESP_LOGD(TAG, "Entering temperature setting mode");
+    metrics_.record_setting_mode_entry();
     
     // Send the command (first press enters setting mode)
     transmit_(cmd);
@@ -144,8 +134,7 @@ void WoleixProtocolHandler::enter_setting_mode_(const WoleixCommand& cmd)
     extend_setting_mode_timeout_();
     
     // Wait for AC to enter setting mode, then continue with remaining commands
-    set_timeout_(TIMEOUT_NEXT_COMMAND, TEMP_ENTER_DELAY_MS, 
-        [this]() { process_next_command_(); });
+    schedule_after_transmit_(0, TEMP_ENTER_DELAY_MS);
 }
 
 /**
@@ -159,17 +148,143 @@ void WoleixProtocolHandler::enter_setting_mode_(const WoleixCommand& cmd)
 void WoleixProtocolHandler::handle_regular_command_(const WoleixCommand& cmd)
 {
     ESP_LOGD(TAG, "Sending regular command");
-    transmit_(cmd);
-    command_queue_->dequeue();
+    uint32_t presses = take_run_(cmd);
+    transmit_run_(cmd, presses);
     
-    set_timeout_(TIMEOUT_NEXT_COMMAND, INTER_COMMAND_DELAY_MS, 
-        [this]() { process_next_command_(); });
+    schedule_after_transmit_(run_span_ms_(cmd, presses), command_gap_ms(cmd.get_command()));
 }
 
-void WoleixProtocolHandler::extend_setting_mode_timeout_()
+/**
+ * Dequeue a run of identical commands.
+ * 
+ * Only commands without their own repeat count are merged, as their frames
+ * would otherwise need different spacing.
+ * 
+ * @param cmd The command at the head of the queue
+ * @return Number of presses taken (at least 1)
+ */
+uint32_t WoleixProtocolHandler::take_run_(const WoleixCommand& cmd)
 {
+    command_queue_->dequeue();
+
+    uint32_t presses = 1;
+    if (cmd.get_repeat_count() != 1) return presses;
+
+    while (presses < max_burst_presses_ && command_queue_->get() == cmd)
+    {
+        command_queue_->dequeue();
+        presses++;
+    }
+    return presses;
+}
+
+void WoleixProtocolHandler::transmit_run_(const WoleixCommand& cmd, uint32_t presses)
+{
+    if (presses == 1)
+    {
+        transmit_(cmd);
+    }
+    else
+    {
+        transmit_burst_(cmd, presses);
+    }
+    last_frame_at_ms_ = scheduler_->now_ms() + run_span_ms_(cmd, presses);
+    on_commands_transmitted_(cmd, presses);
+}
+
+/**
+ * Open temperature setting mode ahead of an expected temperature change.
+ * 
+ * Sends the press that only enters setting mode, so that the next real
+ * temperature command changes the temperature right away. The device closes
+ * setting mode on its own after TEMP_SETTING_MODE_TIMEOUT_MS, which bounds
+ * how long the speculation stays useful; the window cannot be extended
+ * without changing the temperature.
+ * 
+ * Nothing is sent while commands are pending or being spaced out, or if
+ * setting mode is already active.
+ * 
+ * @return true if the entry press was sent
+ */
+bool WoleixProtocolHandler::pre_enter_setting_mode()
+{
+    if (is_in_temp_setting_mode_() || next_command_pending_) return false;
+    if (!command_queue_ || !command_queue_->is_empty()) return false;
+
+    ESP_LOGD(TAG, "Speculatively entering temperature setting mode");
+    metrics_.record_setting_mode_entry();
+
+    transmit_(WoleixCommand(WoleixCommand::Type::TEMP_UP, ADDRESS_NEC));
+    temp_state_ = TempProtocolState::SETTING_ACTIVE;
+    extend_setting_mode_timeout_();
+
+    // Commands arriving meanwhile wait for the device to enter setting mode
+    schedule_after_transmit_(0, TEMP_ENTER_DELAY_MS);
+    return true;
+}
+
+void WoleixProtocolHandler::schedule_next_command_(uint32_t delay_ms)
+{
+    next_command_pending_ = true;
+    set_timeout_(TIMEOUT_NEXT_COMMAND, delay_ms, [this]()
+    {
+        next_command_pending_ = false;
+        process_next_command_();
+    });
+}
+
+/**
+ * Schedule the next command after a transmission.
+ * 
+ * All delays are counted from the start of the last frame. Without the
+ * transmit complete signal, the next command is simply scheduled that long
+ * after the transmit call. With it, the handler waits for the frame to end
+ * and then only for the rest of the delay; the fixed timing plus one frame
+ * duration serves as a fallback in case the signal never comes.
+ * 
+ * @param run_span_ms Time from the first to the last frame start of the run
+ * @param delay_ms Delay required after the start of the last frame
+ */
+void WoleixProtocolHandler::schedule_after_transmit_(uint32_t run_span_ms, uint32_t delay_ms)
+{
+    if (!wait_for_transmit_complete_)
+    {
+        schedule_next_command_(run_span_ms + delay_ms);
+        return;
+    }
+
+    awaiting_transmit_complete_ = true;
+    quiet_gap_ms_ = delay_ms > NEC_FRAME_DURATION_MS ? delay_ms - NEC_FRAME_DURATION_MS : 0;
+
+    next_command_pending_ = true;
+    set_timeout_(TIMEOUT_NEXT_COMMAND, run_span_ms + delay_ms + NEC_FRAME_DURATION_MS, [this]()
+    {
+        awaiting_transmit_complete_ = false;
+        report(WoleixStatus(WoleixMessages::ProtocolHandler::WX_MESSAGE_TRANSMIT_COMPLETE_MISSING));
+        next_command_pending_ = false;
+        process_next_command_();
+    });
+}
+
+/**
+ * Handle the end of a transmission.
+ * 
+ * Replaces the fallback timer with the quiet gap the device needs after
+ * the frame.
+ */
+void WoleixProtocolHandler::on_transmit_complete()
+{
+    if (!awaiting_transmit_complete_) return;
+
+    awaiting_transmit_complete_ = false;
+    schedule_next_command_(quiet_gap_ms_);
+}
+
+void WoleixProtocolHandler::extend_setting_mode_timeout_(uint32_t extra_ms)
+{
+    setting_mode_until_ms_ = clock_ms_() + TEMP_SETTING_MODE_TIMEOUT_MS + extra_ms;
     cancel_timeout_(TIMEOUT_SETTING_MODE);
-    set_timeout_(TIMEOUT_SETTING_MODE, TEMP_SETTING_MODE_TIMEOUT_MS,
+    set_timeout_(TIMEOUT_SETTING_MODE, TEMP_SETTING_MODE_TIMEOUT_MS + extra_ms,
         [this]() { on_setting_mode_timeout_(); });
 }
 
@@ -179,6 +294,47 @@ void WoleixProtocolHandler::on_setting_mode_timeout_()
     temp_state_ = TempProtocolState::IDLE;
 }
 
+/**
+ * Give up a setting mode window too close to its end to be reused.
+ * 
+ * The setting mode timer is dropped and the window is considered closed
+ * right away; the caller waits out the rest of it before sending anything,
+ * so nothing reaches the unit while it may still be in setting mode.
+ * 
+ * @param wait_ms Set to the time until the window is over
+ * @return true if the window was given up and the caller has to wait
+ */
+bool WoleixProtocolHandler::close_expiring_setting_mode_(uint32_t& wait_ms)
+{
+    if (!is_in_temp_setting_mode_()) return false;
+
+    uint32_t remaining = setting_mode_remaining_ms();
+    if (remaining >= TEMP_SETTING_MODE_GUARD_MS) return false;
+
+    ESP_LOGD(TAG, "Setting mode closes in %" PRIu32 " ms, waiting for it to close", remaining);
+    cancel_timeout_(TIMEOUT_SETTING_MODE);
+    temp_state_ = TempProtocolState::IDLE;
+    wait_ms = remaining;
+    return true;
+}
+
+/**
+ * Account for a temperature button pressed on the physical remote.
+ * 
+ * Opens setting mode if it was closed, keeps it open otherwise, exactly as
+ * our own temperature presses do. The caller makes sure the unit is on in
+ * COOL mode, where the button works.
+ * 
+ * @return true if the press changed the temperature, false if it only opened setting mode
+ */
+bool WoleixProtocolHandler::on_remote_temperature_press()
+{
+    bool active = is_in_temp_setting_mode_();
+    temp_state_ = TempProtocolState::SETTING_ACTIVE;
+    extend_setting_mode_timeout_();
+    return active;
+}
+
 /**
  * Reset the protocol handler to its initial state.
  * 
@@ -193,6 +349,9 @@ void WoleixProtocolHandler::reset()
     cancel_timeout_(TIMEOUT_NEXT_COMMAND);    
     
     temp_state_ = TempProtocolState::IDLE;
+    next_command_at_ms_ = clock_ms_();
+    next_command_pending_ = false;
+    awaiting_transmit_complete_ = false;
     on_complete_ = nullptr;
 }
 
@@ -215,41 +374,101 @@ void WoleixProtocolHandler::transmit_(const WoleixCommand& command)
 {
     if (!transmitter_)
     {
-        report
-        (
-            WoleixStatus
-            (
-                WoleixStatus::Severity::WX_SEVERITY_ERROR,
-                WoleixCategory::ProtocolHandler::WX_CATEGORY_TRANSMITTER_NOT_SET,
-                "Transmitter is not set"
-            )
-
-        );
+        report(WoleixStatus(WoleixMessages::ProtocolHandler::WX_MESSAGE_TRANSMITTER_NOT_SET));
     }
     else
     {
-        NECData nec_data;
-        nec_data.address = command.get_address();
-        nec_data.command = command.get_command();
-        nec_data.command_repeats = 1; 
-
         ESP_LOGD
         (
             TAG,
             "Transmitting NEC command: " 
                 "address=%#04x, "
                 "code=%#04x, "
-                "repeats=%u, "
-                "send_times=%u",
-            nec_data.address,
-            nec_data.command,
-            nec_data.command_repeats,
+                "send_times=%" PRIu32,
+            command.get_address(),
+            command.get_command(),
             command.get_repeat_count()
         );
 
-        transmitter_->transmit<NECProtocol>(nec_data, command.get_repeat_count(), 0);
+        send_frame_(command, command.get_repeat_count(), 0);
+    }
+}
+
+/**
+ * Transmit a run of identical presses via NEC protocol in a single call.
+ * 
+ * The frames are sent with burst_send_wait_us() between them, so that their
+ * starts are command_gap_ms() apart, like individually scheduled presses.
+ * 
+ * @param command The command to transmit
+ * @param presses Number of presses
+ */
+void WoleixProtocolHandler::transmit_burst_(const WoleixCommand& command, uint32_t presses)
+{
+    if (!transmitter_)
+    {
+        report(WoleixStatus(WoleixMessages::ProtocolHandler::WX_MESSAGE_TRANSMITTER_NOT_SET));
+    }
+    else
+    {
+        ESP_LOGD
+        (
+            TAG,
+            "Transmitting NEC burst: "
+                "address=%#04x, "
+                "code=%#04x, "
+                "presses=%" PRIu32 ", "
+                "send_wait=%" PRIu32 "us",
+            command.get_address(),
+            command.get_command(),
+            presses,
+            burst_send_wait_us(command.get_command())
+        );
+
+        send_frame_(command, presses, burst_send_wait_us(command.get_command()));
     }
 }
 
+/**
+ * Send the NEC frame of a command.
+ * 
+ * Uses the pre-encoded pulse train when available, so the transmit path does
+ * no encoding. Falls back to ESPHome's NEC encoder for frames that are not
+ * cached (cache not built yet, or a different address). Every frame sent is
+ * counted in the metrics, together with its airtime, and its echo is
+ * expected at the receiver.
+ * 
+ * @param command The command to send
+ * @param send_times Number of times to send the frame
+ * @param send_wait Pause between the frames in microseconds
+ */
+void WoleixProtocolHandler::send_frame_(const WoleixCommand& command, uint32_t send_times, uint32_t send_wait)
+{
+    const RawTimings* timings = pulse_cache_.get(command.get_address(), command.get_command());
+    if (timings)
+    {
+        auto call = transmitter_->transmit();
+        auto* data = call.get_data();
+        data->set_carrier_frequency(WoleixNecPulseCache::CARRIER_FREQUENCY_HZ);
+        data->set_data(*timings);
+        call.set_send_times(send_times);
+        call.set_send_wait(send_wait);
+        call.perform();
+    }
+    else
+    {
+        NECData nec_data;
+        nec_data.address = command.get_address();
+        nec_data.command = command.get_command();
+        nec_data.command_repeats = 1;
+
+        transmitter_->transmit<NECProtocol>(nec_data, send_times, send_wait);
+    }
+    metrics_.record_frames(send_times);
+
+    uint32_t span = (send_times - 1) * std::max(command_gap_ms(command.get_command()), NEC_FRAME_DURATION_MS);
+    echo_filter_.expect(command.get_command(), send_times, clock_ms_() + span + ECHO_WINDOW_MS);
+}
+
 }  // namespace climate_ir_woleix
 }  // namespace esphome
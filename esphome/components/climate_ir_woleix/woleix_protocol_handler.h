@@ -1,7 +1,7 @@
 #pragma once
 
+#include <algorithm>
 #include <cinttypes>
-#include <string>
 #include <functional>
 
 #include "esphome/components/remote_base/remote_base.h"
@@ -9,6 +9,10 @@
 
 #include "woleix_constants.h"
 #include "woleix_command.h"
+#include "woleix_echo_filter.h"
+#include "woleix_metrics.h"
+#include "woleix_nec_pulse_cache.h"
+#include "woleix_timer.h"
 
 namespace esphome
 {
@@ -27,6 +31,42 @@ namespace WoleixCategory::ProtocolHandler
         Category::make(CategoryId::ProtocolHandler, 3, "ProtocolHandler.FailedGetCommand");
     inline constexpr auto WX_CATEGORY_TRANSMITTER_NOT_SET = 
         Category::make(CategoryId::ProtocolHandler, 4, "ProtocolHandler.TransmitterNotSet");
+    inline constexpr auto WX_CATEGORY_TRANSMIT_COMPLETE_MISSING = 
+        Category::make(CategoryId::ProtocolHandler, 5, "ProtocolHandler.TransmitCompleteMissing");
+}
+
+namespace WoleixMessages::ProtocolHandler
+{
+    inline constexpr WoleixMessage WX_MESSAGE_INVALID_COMMAND_QUEUE
+    {
+        WoleixSeverity::WX_SEVERITY_ERROR,
+        WoleixCategory::ProtocolHandler::WX_CATEGORY_INVALID_COMMAND_QUEUE,
+        "Invalid (null) command queue received during setup"
+    };
+    inline constexpr WoleixMessage WX_MESSAGE_COMMAND_QUEUE_NOT_SET
+    {
+        WoleixSeverity::WX_SEVERITY_WARNING,
+        WoleixCategory::ProtocolHandler::WX_CATEGORY_COMMAND_QUEUE_NOT_SET,
+        "Command queue not set during processing"
+    };
+    inline constexpr WoleixMessage WX_MESSAGE_FAILED_GET_COMMAND
+    {
+        WoleixSeverity::WX_SEVERITY_ERROR,
+        WoleixCategory::ProtocolHandler::WX_CATEGORY_FAILED_GET_COMMAND,
+        "Failed getting command from (non-empty) command queue"
+    };
+    inline constexpr WoleixMessage WX_MESSAGE_TRANSMITTER_NOT_SET
+    {
+        WoleixSeverity::WX_SEVERITY_ERROR,
+        WoleixCategory::ProtocolHandler::WX_CATEGORY_TRANSMITTER_NOT_SET,
+        "Transmitter is not set"
+    };
+    inline constexpr WoleixMessage WX_MESSAGE_TRANSMIT_COMPLETE_MISSING
+    {
+        WoleixSeverity::WX_SEVERITY_WARNING,
+        WoleixCategory::ProtocolHandler::WX_CATEGORY_TRANSMIT_COMPLETE_MISSING,
+        "No transmit complete signal, check the transmitter's on_complete"
+    };
 }
 
 /**
@@ -62,33 +102,28 @@ class WoleixProtocolHandler
 {
 public:
 
-    /// Function type for scheduling a timeout
-    using TimeoutSetter = std::function<void(const std::string&, uint32_t, std::function<void()>)>;    
-    /// Function type for cancelling a timeout
-    using TimeoutCanceller = std::function<void(const std::string&)>;
-
     /**
-     * @brief Construct a new transmitter with the given IR transmitter base.
+     * @brief Construct a new protocol handler.
      * 
-     * @param transmitter ESPHome remote transmitter to use for IR output
+     * @param scheduler Timer scheduler used for the protocol delays; must outlive the handler
      */
-    WoleixProtocolHandler(TimeoutSetter set_timeout, TimeoutCanceller cancel_timeout)
-      : set_timeout_(std::move(set_timeout)),
-        cancel_timeout_(std::move(cancel_timeout)) 
+    explicit WoleixProtocolHandler(WoleixTimerScheduler* scheduler)
+      : scheduler_(scheduler)
     {}
     
     virtual ~WoleixProtocolHandler() { cleanup_(); } 
 
     /**
-     * @brief Set up the protocol handler with a command queue.
+     * @brief Set up the protocol handler with a command source.
      * 
-     * This method initializes the protocol handler with a command queue,
-     * registers itself as a consumer of the queue, and starts processing
-     * commands if the queue is not empty.
+     * This method initializes the protocol handler with a command source
+     * (a WoleixCommandQueue or a WoleixTargetMailbox), registers itself as
+     * a consumer of it, and starts processing commands if it is not empty.
+     * On first use it also pre-encodes the NEC frames of all buttons.
      * 
-     * @param command_queue Pointer to the WoleixCommandQueue to use
+     * @param command_queue Pointer to the WoleixCommandSource to use
      */
-    void setup(WoleixCommandQueue* command_queue);
+    void setup(WoleixCommandSource* command_queue);
 
     /**
      * @brief Reset the protocol handler to its initial state.
@@ -99,6 +134,18 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Set the scheduler running the protocol timers.
+     * 
+     * Lets the protocol timers run on a different scheduler than the one
+     * given to the constructor, e.g. a WoleixExecutor firing them off the
+     * main loop. Must be called while no protocol timer is pending, i.e.
+     * before setup().
+     * 
+     * @param scheduler Timer scheduler; must outlive the handler
+     */
+    void set_scheduler(WoleixTimerScheduler* scheduler) { scheduler_ = scheduler; }
+
     /**
      * @brief Set the IR transmitter base.
      * 
@@ -109,6 +156,103 @@ public:
         transmitter_ = transmitter;
     }
     
+    /**
+     * @brief Open temperature setting mode ahead of an expected temperature change.
+     * 
+     * Sends the setting mode entry press while the handler is idle, so that
+     * the entry press and delay are off the path of the next temperature
+     * change, as long as it arrives within the setting mode window.
+     * 
+     * @return true if the entry press was sent, false if the handler is busy
+     *         or setting mode is already active
+     */
+    bool pre_enter_setting_mode();
+
+    /**
+     * @brief Set the maximum number of identical presses merged into one transmit call.
+     * 
+     * Runs of identical queued commands are sent as a single multi-send
+     * transmission, with frames spaced command_gap_ms() apart, instead of
+     * one scheduler round-trip per press. 1 (the default) disables merging.
+     * Values are clamped to 1..BURST_MAX_PRESSES.
+     * 
+     * @param presses Maximum presses per transmit call
+     */
+    void set_max_burst_presses(uint32_t presses)
+    {
+        max_burst_presses_ = std::clamp<uint32_t>(presses, 1, BURST_MAX_PRESSES);
+    }
+
+    /**
+     * @brief Pace commands by the end of the transmitted frames.
+     * 
+     * Meant for a `remote_transmitter` with `non_blocking: true`, whose
+     * transmit call returns before the frame is on air. Instead of timing
+     * the next command from the transmit call, the handler waits for
+     * on_transmit_complete() and then only keeps the device's quiet gap,
+     * i.e. the command gap minus the frame duration. If the signal does not
+     * arrive, the next command goes out a frame duration later than the
+     * fixed timing would send it, and a warning is reported.
+     * 
+     * @param enabled true to wait for the transmit complete signal
+     */
+    void set_wait_for_transmit_complete(bool enabled) { wait_for_transmit_complete_ = enabled; }
+
+    /**
+     * @brief Signal that the transmitter finished sending.
+     * 
+     * Wire to the transmitter's `on_complete` trigger. Ignored unless the
+     * handler is waiting for a transmission to finish.
+     */
+    void on_transmit_complete();
+
+    /**
+     * @brief Get the time left before temperature setting mode closes.
+     * 
+     * @return Milliseconds until the unit leaves setting mode, 0 if it is not in it
+     */
+    uint32_t setting_mode_remaining_ms() const
+    {
+        if (!is_in_temp_setting_mode_()) return 0;
+        int32_t remaining = static_cast<int32_t>(setting_mode_until_ms_ - clock_ms_());
+        return remaining > 0 ? static_cast<uint32_t>(remaining) : 0;
+    }
+
+    /**
+     * @brief Get the time left before the handler may send the next command.
+     * 
+     * @return Milliseconds until the gap after the last transmission is over,
+     *         0 if the handler could send right away
+     */
+    uint32_t next_command_in_ms() const
+    {
+        int32_t remaining = static_cast<int32_t>(next_command_at_ms_ - clock_ms_());
+        return remaining > 0 ? static_cast<uint32_t>(remaining) : 0;
+    }
+
+    /**
+     * @brief Check whether a received frame is the echo of one we sent.
+     * 
+     * Each frame sent is expected back once, within ECHO_WINDOW_MS after
+     * it went out; see WoleixEchoFilter.
+     * 
+     * @param command NEC command code of the received frame
+     * @return true if the frame is our own and has been accounted for
+     */
+    bool is_echo(uint16_t command) { return echo_filter_.consume(command, clock_ms_()); }
+
+    /**
+     * @brief Account for a temperature button pressed on the physical remote.
+     * 
+     * The remote is subject to the same quirk as we are: its first press
+     * only opens setting mode, and every press keeps it open. Tracking it
+     * keeps the handler from sending an entry press into a window the
+     * remote opened, which would change the temperature.
+     * 
+     * @return true if the press changed the temperature, false if it only opened setting mode
+     */
+    bool on_remote_temperature_press();
+
     /**
      * @brief Get the current IR transmitter base.
      * 
@@ -119,6 +263,17 @@ public:
         return transmitter_;
     }
 
+    /**
+     * @brief Get the pipeline counters.
+     * 
+     * @return Counters updated by the handler (frames, airtime, setting mode)
+     *         and by its owner (queue depth, rejected plans)
+     */
+    const WoleixMetrics& get_metrics() const
+    {
+        return metrics_;
+    }
+
 protected:
 
     /**
@@ -130,19 +285,103 @@ protected:
      */
     virtual void transmit_(const WoleixCommand& command);
 
+    /**
+     * @brief Transmit a run of identical presses in one call.
+     * 
+     * Sends the command @p presses times, with burst_send_wait_us() between
+     * the frames.
+     * 
+     * @param command Command to transmit
+     * @param presses Number of presses
+     */
+    virtual void transmit_burst_(const WoleixCommand& command, uint32_t presses);
+
+    /**
+     * @brief Called after a run of presses taken from the queue went out.
+     * 
+     * Not called for the press that only enters temperature setting mode,
+     * as it does not change the device state. Lets the owner track the
+     * state actually transmitted so far.
+     * 
+     * @param command Command transmitted
+     * @param presses Number of presses
+     */
+    virtual void on_commands_transmitted_(const WoleixCommand&, uint32_t) {}
+
+    /**
+     * @brief Set a callback for when the command source has been drained.
+     * 
+     * Called once, the next time the handler finds no command left, i.e.
+     * after the last frame went out and its gap elapsed.
+     * 
+     * @param callback Function to call on completion
+     */
+    void set_on_complete_(std::function<void()> callback) { on_complete_ = std::move(callback); }
+
+    /**
+     * @brief Time at which the most recent frame taken from the queue was sent.
+     * 
+     * For a burst, this is the last frame of the burst.
+     */
+    uint32_t last_frame_ms_() const { return last_frame_at_ms_; }
+
+    /**
+     * @brief Current time on the clock of the protocol timers.
+     * 
+     * The clock last_frame_ms_() refers to.
+     */
+    uint32_t clock_ms_() const { return scheduler_->now_ms(); }
+
+    /**
+     * @brief Schedule the next command after a transmission.
+     * 
+     * @param run_span_ms Time from the first to the last frame start of the run
+     * @param delay_ms Delay required after the start of the last frame
+     */
+    void schedule_after_transmit_(uint32_t run_span_ms, uint32_t delay_ms);
+
+    /**
+     * @brief Send the NEC frame of a command, from the pulse cache if possible.
+     * 
+     * @param command Command to send
+     * @param send_times Number of times to send the frame
+     * @param send_wait Pause between the frames in microseconds
+     */
+    void send_frame_(const WoleixCommand& command, uint32_t send_times, uint32_t send_wait);
+
     /**
      * Check if currently in temperature setting mode.
      */
     bool is_in_temp_setting_mode_() const { return temp_state_ == TempProtocolState::SETTING_ACTIVE; }
 
-    // Protocol timing constants
-    static constexpr uint32_t TEMP_SETTING_MODE_TIMEOUT_MS = 5000;
-    static constexpr uint32_t TEMP_ENTER_DELAY_MS = 150;
-    static constexpr uint32_t INTER_COMMAND_DELAY_MS = 200;
+    WoleixMetrics metrics_;  ///< Pipeline counters, see get_metrics()
 
-    // Timeout names
-    static constexpr const char* TIMEOUT_SETTING_MODE = "proto_setting_mode";
-    static constexpr const char* TIMEOUT_NEXT_COMMAND = "proto_next_cmd";
+    // Timer IDs
+    static constexpr WoleixTimerId TIMEOUT_SETTING_MODE = WoleixTimerId::SETTING_MODE;
+    static constexpr WoleixTimerId TIMEOUT_NEXT_COMMAND = WoleixTimerId::NEXT_COMMAND;
+
+    /**
+     * @brief Schedule (or reschedule) one of the protocol timers.
+     */
+    void set_timeout_(WoleixTimerId id, uint32_t delay_ms, WoleixTimerCallback callback)
+    {
+        if (id == TIMEOUT_NEXT_COMMAND) next_command_at_ms_ = clock_ms_() + delay_ms;
+        scheduler_->schedule_timer(id, delay_ms, callback);
+    }
+
+    /**
+     * @brief Cancel one of the protocol timers.
+     */
+    void cancel_timeout_(WoleixTimerId id)
+    {
+        scheduler_->cancel_timer(id);
+    }
+
+    /**
+     * Schedule processing of the next command.
+     * New commands wait for the pending delay instead of cutting it short.
+     */
+    void schedule_next_command_(uint32_t delay_ms);
 
     /**
      * Process the next command in the queue.
@@ -166,17 +405,54 @@ protected:
      */
     void enter_setting_mode_(const WoleixCommand& cmd);
 
+    /**
+     * Dequeue the current command together with the identical commands
+     * following it, up to the maximum burst size.
+     * 
+     * @return Number of presses taken (at least 1)
+     */
+    uint32_t take_run_(const WoleixCommand& cmd);
+
+    /**
+     * Transmit a run taken with take_run_(), as a single press or a burst.
+     */
+    void transmit_run_(const WoleixCommand& cmd, uint32_t presses);
+
+    /**
+     * Time between the first and the last frame of a run.
+     */
+    static uint32_t run_span_ms_(const WoleixCommand& cmd, uint32_t presses)
+    {
+        return (presses - 1) * command_gap_ms(cmd.get_command());
+    }
+
     /**
      * Extend the setting mode timeout.
      * Called after each temp command to reset the 5-second window.
+     * 
+     * @param extra_ms Additional time until the last press of a burst is sent
      */
-    void extend_setting_mode_timeout_();
+    void extend_setting_mode_timeout_(uint32_t extra_ms = 0);
 
     /**
      * Called when setting mode times out.
      */
     void on_setting_mode_timeout_();
 
+    /**
+     * @brief Give up a setting mode window too close to its end to be reused.
+     * 
+     * A temperature press sent less than TEMP_SETTING_MODE_GUARD_MS before the
+     * window closes may reach the unit after it left setting mode, where it
+     * would only reopen it. Such a window is considered closed; the handler
+     * has to wait until the unit actually left setting mode before entering
+     * it again.
+     * 
+     * @param wait_ms Set to the time until the window is over
+     * @return true if the window was given up and the handler has to wait
+     */
+    bool close_expiring_setting_mode_(uint32_t& wait_ms);
+
     /**
      * Check if a command is a temperature command.
      */
@@ -200,22 +476,32 @@ protected:
      * @brief Callback method triggered when a new command is enqueued.
      * 
      * This method schedules the processing of the next command immediately
-     * after a new command is added to the queue.
+     * after a new command is added to the queue, unless the handler is still
+     * waiting out the delay after the previous command.
      */
     void on_command_enqueued() override
     {
-        set_timeout_(TIMEOUT_NEXT_COMMAND, 0, [this]() { process_next_command_(); }); 
+        if (!next_command_pending_) schedule_next_command_(0);
     }
 
-private:
+protected:
 
-    // Command queue for async execution
-    WoleixCommandQueue* command_queue_;
+    // Command source (queue or mailbox) for async execution
+    WoleixCommandSource* command_queue_{nullptr};
     
-    RemoteTransmitterBase* transmitter_;
-    TimeoutSetter set_timeout_;
-    TimeoutCanceller cancel_timeout_;
+    RemoteTransmitterBase* transmitter_{nullptr};
+    WoleixNecPulseCache pulse_cache_;
+    WoleixEchoFilter echo_filter_;
+    WoleixTimerScheduler* scheduler_;
     TempProtocolState temp_state_{TempProtocolState::IDLE};
+    bool next_command_pending_{false};
+    bool wait_for_transmit_complete_{false};
+    bool awaiting_transmit_complete_{false};
+    uint32_t quiet_gap_ms_{0};
+    uint32_t max_burst_presses_{1};
+    uint32_t last_frame_at_ms_{0};
+    uint32_t setting_mode_until_ms_{0};  ///< Time the unit leaves setting mode, while it is in it
+    uint32_t next_command_at_ms_{0};     ///< Time the next command may be sent, see next_command_in_ms()
     
     std::function<void()> on_complete_;
 };
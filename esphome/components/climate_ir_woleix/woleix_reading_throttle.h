@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Sensor readings shown as part of the climate state.
+ */
+enum class WoleixReading: uint8_t
+{
+    CURRENT_TEMPERATURE,    ///< Room temperature from the temperature sensor
+    CURRENT_HUMIDITY        ///< Room humidity from the humidity sensor
+};
+
+/**
+ * @brief Number of WoleixReading values.
+ */
+inline constexpr size_t WOLEIX_READING_COUNT = 2;
+
+/**
+ * @brief Decides when sensor readings are worth a climate state publication.
+ *
+ * Every publication sends the whole climate state to the API clients, so
+ * fast sensors should not trigger one per reading. A reading is significant
+ * when it differs from the last published value of its kind by at least the
+ * configured delta, or when the last publication is older than the maximum
+ * staleness. Significant readings are published at most once per minimum
+ * interval; readings arriving in between are coalesced, across both kinds,
+ * into one publication at the end of the interval.
+ *
+ * The default configuration (no interval, no delta) publishes every reading,
+ * as before.
+ */
+class WoleixReadingThrottle
+{
+public:
+    /**
+     * @brief Set the publication limits.
+     * @param min_interval_ms Shortest time between two publications
+     * @param max_staleness_ms Age of the last publication after which any reading is published, 0 for no limit
+     */
+    void configure(uint32_t min_interval_ms, uint32_t max_staleness_ms)
+    {
+        min_interval_ms_ = min_interval_ms;
+        max_staleness_ms_ = max_staleness_ms;
+    }
+
+    /**
+     * @brief Set the smallest change of a reading worth publishing.
+     * @param reading Kind of reading
+     * @param delta Change threshold, in the reading's unit
+     */
+    void set_delta(WoleixReading reading, float delta) { deltas_[index_(reading)] = delta; }
+
+    /**
+     * @brief Offer a new reading.
+     * @param reading Kind of reading
+     * @param value New value, not NaN
+     * @param now_ms Current time
+     * @return Delay until the pending publication is due, 0 to publish right
+     *         away, or nothing if the reading does not need to be published
+     */
+    std::optional<uint32_t> offer(WoleixReading reading, float value, uint32_t now_ms)
+    {
+        const size_t i = index_(reading);
+        latest_[i] = value;
+
+        uint32_t elapsed = now_ms - last_publish_ms_;
+        bool significant = std::isnan(published_[i])
+            || std::fabs(value - published_[i]) >= deltas_[i]
+            || (max_staleness_ms_ > 0 && elapsed >= max_staleness_ms_);
+        if (!significant && !pending_) return {};
+
+        pending_ = true;
+        if (!has_published_ || elapsed >= min_interval_ms_) return 0u;
+        return min_interval_ms_ - elapsed;
+    }
+
+    /**
+     * @brief Record that the latest readings were published.
+     * @param now_ms Current time
+     */
+    void published(uint32_t now_ms)
+    {
+        published_ = latest_;
+        last_publish_ms_ = now_ms;
+        has_published_ = true;
+        pending_ = false;
+    }
+
+    /**
+     * @brief Whether a publication is due or scheduled.
+     */
+    bool is_pending() const { return pending_; }
+
+protected:
+    static size_t index_(WoleixReading reading) { return static_cast<size_t>(reading); }
+
+    uint32_t min_interval_ms_{0};
+    uint32_t max_staleness_ms_{0};
+    std::array<float, WOLEIX_READING_COUNT> deltas_{};
+    std::array<float, WOLEIX_READING_COUNT> latest_{NAN, NAN};
+    std::array<float, WOLEIX_READING_COUNT> published_{NAN, NAN};
+    uint32_t last_publish_ms_{0};
+    bool has_published_{false};
+    bool pending_{false};
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
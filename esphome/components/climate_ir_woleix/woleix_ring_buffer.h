@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <array>
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Fixed-capacity FIFO ring buffer over caller-provided storage.
+ *
+ * The ring buffer never allocates: it only keeps the head index and the
+ * current size over a slot array whose lifetime is managed by the owner
+ * (see WoleixRingBufferStorage). Slots are overwritten in place, so T must
+ * be copy-assignable.
+ *
+ * @tparam T Element type
+ */
+template<typename T>
+class WoleixRingBuffer
+{
+public:
+    WoleixRingBuffer(T* slots, size_t capacity)
+      : slots_(slots), capacity_(capacity)
+    {}
+
+    WoleixRingBuffer(const WoleixRingBuffer&) = delete;
+    WoleixRingBuffer& operator=(const WoleixRingBuffer&) = delete;
+
+    /**
+     * @brief Append an element at the tail.
+     * @param item Element to copy into the next free slot
+     * @return false if the buffer is full, true otherwise
+     */
+    bool push_back(const T& item)
+    {
+        if (full()) return false;
+        slots_[wrap_(head_ + size_)] = item;
+        size_++;
+        return true;
+    }
+
+    /**
+     * @brief Write a free slot past the tail without making it visible.
+     * 
+     * Staged elements are published with commit(); until then, the buffer
+     * behaves as if they were not there.
+     * 
+     * @param offset Position past the tail (0 is the slot right after it)
+     * @param item Element to copy into the slot
+     * @return false if there is no free slot at @p offset, true otherwise
+     */
+    bool stage(size_t offset, const T& item)
+    {
+        if (size_ + offset >= capacity_) return false;
+        slots_[wrap_(head_ + size_ + offset)] = item;
+        return true;
+    }
+
+    /**
+     * @brief Access a staged element.
+     * @note No bounds checking; callers must have staged @p offset.
+     */
+    const T& staged(size_t offset) const { return slots_[wrap_(head_ + size_ + offset)]; }
+
+    /**
+     * @brief Publish the first @p count staged elements.
+     * @note The caller must have staged offsets 0 to count - 1.
+     */
+    void commit(size_t count)
+    {
+        size_ += count;
+    }
+
+    /**
+     * @brief Drop the element at the head.
+     * @return false if the buffer is empty, true otherwise
+     */
+    bool pop_front()
+    {
+        if (empty()) return false;
+        head_ = wrap_(head_ + 1);
+        size_--;
+        return true;
+    }
+
+    /**
+     * @brief Drop elements from the tail until only @p size remain.
+     * @param size Number of elements to keep
+     */
+    void truncate(size_t size)
+    {
+        if (size < size_) size_ = size;
+    }
+
+    T& front() { return slots_[head_]; }
+    const T& front() const { return slots_[head_]; }
+
+    /**
+     * @brief Access the element at a logical position (0 is the head).
+     * @note No bounds checking; callers must ensure index < size().
+     */
+    T& operator[](size_t index) { return slots_[wrap_(head_ + index)]; }
+    const T& operator[](size_t index) const { return slots_[wrap_(head_ + index)]; }
+
+    void clear() { head_ = 0; size_ = 0; }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == capacity_; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+
+protected:
+    /**
+     * @brief Map a linear index into the slot array.
+     *
+     * Indices never exceed 2 * capacity, so a conditional subtraction
+     * replaces the modulo (no division on the hot path).
+     */
+    size_t wrap_(size_t index) const
+    {
+        return index >= capacity_ ? index - capacity_ : index;
+    }
+
+    T* slots_;
+    size_t capacity_;
+    size_t head_{0};
+    size_t size_{0};
+};
+
+/**
+ * @brief Compile-time sized slot storage for a WoleixRingBuffer.
+ *
+ * Kept as a separate class so that it can be inherited *before* the
+ * class owning the ring buffer (base-from-member idiom), guaranteeing
+ * the slots outlive and are constructed ahead of the buffer using them.
+ *
+ * @tparam T Element type
+ * @tparam Capacity Number of slots
+ */
+template<typename T, size_t Capacity>
+class WoleixRingBufferStorage
+{
+    static_assert(Capacity > 0, "Ring buffer capacity must be positive");
+
+protected:
+    std::array<T, Capacity> storage_{};
+};
+
+} // namespace climate_ir_woleix
+} // namespace esphome
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <optional>
+
+#include "woleix_command.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Assumed cache line size, used to keep the producer and consumer
+ * indices from sharing a line.
+ */
+inline constexpr size_t WOLEIX_CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Wait-free single-producer/single-consumer ring buffer.
+ *
+ * One thread (or FreeRTOS task) may push while another one pops, without
+ * locks and without ever blocking: every operation finishes in a bounded
+ * number of steps. The producer owns the tail index, the consumer owns the
+ * head index; each publishes its index with a release store and reads the
+ * other's with an acquire load, so a slot is only read after its write is
+ * visible and only overwritten after it has been consumed.
+ *
+ * Indices run freely and are masked into the slot array, hence the
+ * power-of-two capacity; all slots are usable.
+ *
+ * @tparam T Element type, must be copy-assignable
+ * @tparam Capacity Number of slots, a power of two
+ */
+template<typename T, size_t Capacity>
+class WoleixSpscRingBuffer
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SPSC capacity must be a power of two");
+
+public:
+    WoleixSpscRingBuffer() = default;
+    WoleixSpscRingBuffer(const WoleixSpscRingBuffer&) = delete;
+    WoleixSpscRingBuffer& operator=(const WoleixSpscRingBuffer&) = delete;
+
+    /**
+     * @brief Append an element; producer side only.
+     * @param item Element to copy into the next free slot
+     * @return false if the buffer is full, true otherwise
+     */
+    bool push(const T& item)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+
+        slots_[tail & MASK] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Peek at the oldest element; consumer side only.
+     * @return Pointer to the element, valid until pop(), or nullptr if empty
+     */
+    const T* front() const
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (tail_.load(std::memory_order_acquire) == head) return nullptr;
+        return &slots_[head & MASK];
+    }
+
+    /**
+     * @brief Drop the oldest element; consumer side only.
+     * @return false if the buffer is empty, true otherwise
+     */
+    bool pop()
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (tail_.load(std::memory_order_acquire) == head) return false;
+
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Check for pending elements.
+     *
+     * Exact from the consumer's point of view; from the producer's, the
+     * buffer may have been drained in the meantime.
+     */
+    bool empty() const
+    {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Number of pending elements, a snapshot when called concurrently.
+     */
+    size_t size() const
+    {
+        const size_t head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+protected:
+    static constexpr size_t MASK = Capacity - 1;
+
+    alignas(WOLEIX_CACHE_LINE_SIZE) std::atomic<size_t> head_{0};  ///< Next slot to read, written by the consumer
+    alignas(WOLEIX_CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};  ///< Next slot to write, written by the producer
+    alignas(WOLEIX_CACHE_LINE_SIZE) std::array<T, Capacity> slots_{};
+};
+
+/**
+ * @brief Command queue for producers running outside the ESPHome main loop.
+ *
+ * A single producer task (IR receiver decoder, button handler, API handler,
+ * possibly on the other core) hands commands over with enqueue(), while the
+ * protocol handler consumes them on the main loop through the
+ * WoleixCommandSource interface. Unlike WoleixCommandQueue, there are no
+ * producer callbacks: enqueue() simply fails when the queue is full.
+ *
+ * Consumers must not be called from the producer task, so the "command
+ * enqueued" notification is marshalled: the main loop calls poll(), which
+ * notifies the consumers once the queue turned non-empty after having been
+ * drained.
+ *
+ * Standalone for now: WoleixClimate has no producer outside the main loop
+ * (its receiver listener runs on the loop too), so it keeps feeding the
+ * protocol handler from WoleixCommandQueue, and this header is not included
+ * by the component. It is covered by the host stress tests only.
+ *
+ * @tparam Capacity Maximum number of queued commands, a power of two
+ */
+template<size_t Capacity>
+class WoleixSpscCommandQueue : public WoleixCommandSource
+{
+public:
+    /**
+     * @brief Hand a command over; producer side only, wait-free.
+     * @param command Command to queue
+     * @return false if the queue is full, true otherwise
+     */
+    bool enqueue(const WoleixCommand& command)
+    {
+        return buffer_.push(command);
+    }
+
+    /**
+     * @brief Notify consumers about commands that arrived since the queue
+     * was drained; consumer side only, call from the main loop.
+     * @return true if the consumers were notified
+     */
+    bool poll()
+    {
+        if (!drained_ || buffer_.empty()) return false;
+        drained_ = false;
+        on_command_enqueued();
+        return true;
+    }
+
+    std::optional<WoleixCommand> get() const override
+    {
+        const WoleixCommand* command = buffer_.front();
+        if (!command) return {};
+        return *command;
+    }
+
+    bool dequeue() override
+    {
+        if (!buffer_.pop()) return false;
+        if (buffer_.empty()) drained_ = true;
+        return true;
+    }
+
+    bool is_empty() const override { return buffer_.empty(); }
+    size_t length() const { return buffer_.size(); }
+    static constexpr size_t max_capacity() { return Capacity; }
+
+protected:
+    WoleixSpscRingBuffer<WoleixCommand, Capacity> buffer_;
+
+    /// Whether the consumers still have to be told about new commands (consumer side only)
+    bool drained_{true};
+};
+
+} // namespace climate_ir_woleix
+} // namespace esphome
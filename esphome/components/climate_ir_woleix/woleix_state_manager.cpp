@@ -1,11 +1,13 @@
+#include <cinttypes>
 #include <cmath>
 #include <algorithm>
 #include <array>
-#include <format>
 
 #include "esphome/core/log.h"
 
 #include "woleix_state_manager.h"
+#include "woleix_path_planner.h"
+#include "woleix_transition_table.h"
 
 namespace esphome {
 namespace climate_ir_woleix {
@@ -22,6 +24,17 @@ static constexpr std::array<WoleixMode, 3> MODE_SWITCH_SEQUENCE =
     WoleixMode::DEHUM,
     WoleixMode::FAN
 };
+static_assert(MODE_SWITCH_SEQUENCE.size() == MODE_CYCLE_LENGTH);
+// The transition table counts MODE presses from the enum values
+static_assert
+(
+    MODE_SWITCH_SEQUENCE[0] == WoleixMode::COOL &&
+    MODE_SWITCH_SEQUENCE[1] == WoleixMode::DEHUM &&
+    MODE_SWITCH_SEQUENCE[2] == WoleixMode::FAN &&
+    static_cast<int>(WoleixMode::COOL) == 0 &&
+    static_cast<int>(WoleixMode::DEHUM) == 1 &&
+    static_cast<int>(WoleixMode::FAN) == 2
+);
 
 static constexpr float TEMP_EPSILON = 0.5f; 
 
@@ -50,9 +63,17 @@ void WoleixStateManager::setup()
  * 3. Temperature adjustments (if in COOL mode)
  * 4. Fan speed changes (if in FAN mode)
  * 
+ * The sequence is looked up in the precomputed WoleixTransitionTable; states
+ * outside the table (e.g. invalid enum values) are handled step by step.
  * The function updates internal state as commands are generated and returns
  * a reference to the complete command queue.
  * 
+ * With shortest-path planning enabled, the sequence comes from WoleixPathPlanner
+ * instead (same end state, lowest transmission time).
+ * 
+ * All generated commands are tagged with the priority class of the target,
+ * see priority_of().
+ * 
  * @param power Target internal state
  * 
  * Side effect: fills in the command queue with commnds in the right order
@@ -60,7 +81,131 @@ void WoleixStateManager::setup()
 const std::vector<WoleixCommand>& WoleixStateManager::move_to(const WoleixInternalState& target_state)
 {
     commands_.clear();
+    plan_(target_state);
+    return commands_;
+}
+
+/**
+ * Set the target state and emit the command sequence into a sink.
+ * 
+ * Plans exactly like move_to(const WoleixInternalState&), but every command
+ * goes straight to the sink, so no intermediate vector is built. The plan is
+ * committed as a whole; if the sink rejects a command or the commit, the
+ * planned and desired states are rolled back, as if move_to() was never
+ * called.
+ * 
+ * @param target_state Target internal state
+ * @param sink Destination of the generated commands
+ * @return true if the plan was committed, false if it was rejected
+ */
+bool WoleixStateManager::move_to(const WoleixInternalState& target_state, WoleixCommandSink& sink)
+{
+    const WoleixInternalState planned = current_state_;
+    const WoleixInternalState desired = desired_state_;
+
+    sink_ = &sink;
+    emitted_ = true;
+    plan_(target_state);
+    sink_ = nullptr;
+
+    if (emitted_ && sink.commit()) return true;
+
+    ESP_LOGW(TAG, "Plan of %zu commands rejected", generated_);
+    current_state_ = planned;
+    desired_state_ = desired;
+    return false;
+}
+
+/**
+ * Generate the commands for a transition.
+ * 
+ * @param target_state Target internal state
+ */
+void WoleixStateManager::plan_(const WoleixInternalState& target_state)
+{
+    generated_ = 0;
+    desired_state_ = target_state;
+    priority_ = priority_of(target_state);
+
+    if (shortest_path_planning_)
+    {
+        WoleixPlan plan = WoleixPathPlanner::plan(current_state_, target_state, setting_mode_window());
+        for (auto type : plan.commands)
+        {
+            enqueue_command_(command_factory_->create(type));
+        }
+        current_state_ = plan.state;
+
+        ESP_LOGD(TAG, "Planned %zu commands (%" PRIu32 " ms) for state transition",
+            generated_, plan.cost_ms);
+        return;
+    }
 
+    auto from = WoleixTransitionTable::pack(current_state_);
+    auto to = WoleixTransitionTable::pack_target(current_state_, target_state);
+    if (from.has_value() && to.has_value())
+    {
+        generate_transition_commands_(WoleixTransitionTable::lookup(from.value(), to.value()), target_state);
+
+        ESP_LOGD(TAG, "Looked up %zu commands for state transition %u -> %u",
+            generated_,
+            static_cast<unsigned>(from.value()),
+            static_cast<unsigned>(to.value()));
+    }
+    else
+    {
+        generate_commands_incrementally_(target_state);
+    }
+}
+
+/**
+ * Generate commands from a transition table descriptor.
+ * 
+ * @param descriptor Descriptor looked up in WoleixTransitionTable
+ * @param target_state Target internal state
+ */
+void WoleixStateManager::generate_transition_commands_(uint8_t descriptor, const WoleixInternalState& target_state)
+{
+    if (WoleixTransitionTable::toggles_power(descriptor))
+    {
+        enqueue_command_(command_factory_->create(WoleixCommand::Type::POWER));
+        current_state_.power = target_state.power;
+    }
+
+    uint8_t mode_steps = WoleixTransitionTable::mode_steps(descriptor);
+    for (uint8_t i = 0; i < mode_steps; i++)
+    {
+        enqueue_command_(command_factory_->create(WoleixCommand::Type::MODE));
+    }
+    if (mode_steps > 0) current_state_.mode = target_state.mode;
+
+    int temp_steps = WoleixTransitionTable::temp_steps(descriptor);
+    WoleixCommand::Type temp_type = (temp_steps > 0)
+        ? WoleixCommand::Type::TEMP_UP
+        : WoleixCommand::Type::TEMP_DOWN;
+    for (int i = 0; i < std::abs(temp_steps); i++)
+    {
+        enqueue_command_(command_factory_->create(temp_type));
+    }
+    current_state_.temperature += temp_steps;
+
+    if (WoleixTransitionTable::toggles_fan(descriptor))
+    {
+        enqueue_command_(command_factory_->create(WoleixCommand::Type::FAN_SPEED));
+        current_state_.fan_speed = target_state.fan_speed;
+    }
+}
+
+/**
+ * Generate the command sequence one state component at a time.
+ * 
+ * Reference implementation of the transition table, used for states the
+ * table does not cover.
+ * 
+ * @param target_state Target internal state
+ */
+void WoleixStateManager::generate_commands_incrementally_(const WoleixInternalState& target_state)
+{
     WoleixPowerState power = target_state.power;
     WoleixMode mode = target_state.mode;
     float temperature = target_state.temperature;
@@ -88,14 +233,13 @@ const std::vector<WoleixCommand>& WoleixStateManager::move_to(const WoleixIntern
         }
         
         ESP_LOGD(TAG, "Calculated and queued %zu commands for state transition: power=%d, mode=%d, temp=%.1f, fan=%d",
-            commands_.size(),
+            generated_,
             static_cast<int>(power),
             static_cast<int>(mode),
             temperature,
             static_cast<int>(fan_speed));
 
     }
-    return commands_;
 }
 
 /**
@@ -109,6 +253,8 @@ const std::vector<WoleixCommand>& WoleixStateManager::move_to(const WoleixIntern
 void WoleixStateManager::reset()
 {
     current_state_ = WoleixInternalState();  // Reset to defaults
+    transmitted_state_ = current_state_;
+    desired_state_ = current_state_;
     commands_.clear();
 
     ESP_LOGD(TAG, "State manager reset to defaults: ON, COOL, 25°C, LOW fan");
@@ -246,14 +392,9 @@ int WoleixStateManager::calculate_mode_steps_(WoleixMode from_mode, WoleixMode t
         (
             WoleixStatus
             (
-                WoleixStatus::Severity::WX_SEVERITY_ERROR,
-                WoleixCategory::StateManager::WX_CATEGORY_INVALID_MODE,
-                std::format
-                (
-                    "Invalid mode in sequence: from={}, to={}", 
-                    static_cast<uint8_t>(from_mode), 
-                    static_cast<uint8_t>(to_mode)
-                )
+                WoleixMessages::StateManager::WX_MESSAGE_INVALID_MODE,
+                static_cast<int>(from_mode),
+                static_cast<int>(to_mode)
             )
         );
         return 0;
@@ -270,16 +411,133 @@ int WoleixStateManager::calculate_mode_steps_(WoleixMode from_mode, WoleixMode t
     return steps;
 }
 
+/**
+ * Determine the next command on the way from one state to another.
+ * 
+ * Mirrors the ordering in move_to(): power first, then mode, then temperature
+ * (COOL mode only), then fan speed (FAN mode only).
+ * 
+ * @param from Current state
+ * @param to Target state
+ * @return Next command type, or nothing when the target is reached
+ */
+std::optional<WoleixCommand::Type> WoleixStateManager::next_command
+(
+    const WoleixInternalState& from,
+    const WoleixInternalState& to
+)
+{
+    if (from.power != to.power) return WoleixCommand::Type::POWER;
+    if (to.power == WoleixPowerState::OFF) return {};
+
+    if (from.mode != to.mode) return WoleixCommand::Type::MODE;
+
+    if (to.mode == WoleixMode::COOL)
+    {
+        float target_temp = std::clamp(to.temperature, WOLEIX_TEMP_MIN, WOLEIX_TEMP_MAX);
+        int steps = static_cast<int>(std::round(target_temp - from.temperature));
+        if (steps > 0) return WoleixCommand::Type::TEMP_UP;
+        if (steps < 0) return WoleixCommand::Type::TEMP_DOWN;
+    }
+
+    if (to.mode == WoleixMode::FAN && from.fan_speed != to.fan_speed)
+    {
+        return WoleixCommand::Type::FAN_SPEED;
+    }
+    return {};
+}
+
+/**
+ * Apply the effect of a single button press to a tracked state.
+ * 
+ * @param state State to update
+ * @param type Button pressed
+ */
+void WoleixStateManager::apply(WoleixInternalState& state, WoleixCommand::Type type)
+{
+    if (type == WoleixCommand::Type::POWER)
+    {
+        state.power = state.power == WoleixPowerState::ON
+            ? WoleixPowerState::OFF
+            : WoleixPowerState::ON;
+        return;
+    }
+    if (state.power != WoleixPowerState::ON) return;
+
+    switch (type)
+    {
+        case WoleixCommand::Type::MODE:
+        {
+            auto it = std::ranges::find(MODE_SWITCH_SEQUENCE, state.mode);
+            if (it == MODE_SWITCH_SEQUENCE.end()) return;
+            auto next = std::next(it);
+            state.mode = next == MODE_SWITCH_SEQUENCE.end() ? MODE_SWITCH_SEQUENCE.front() : *next;
+            break;
+        }
+        case WoleixCommand::Type::TEMP_UP:
+            if (state.mode == WoleixMode::COOL)
+                state.temperature = std::min(state.temperature + 1.0f, WOLEIX_TEMP_MAX);
+            break;
+        case WoleixCommand::Type::TEMP_DOWN:
+            if (state.mode == WoleixMode::COOL)
+                state.temperature = std::max(state.temperature - 1.0f, WOLEIX_TEMP_MIN);
+            break;
+        case WoleixCommand::Type::FAN_SPEED:
+            state.fan_speed = state.fan_speed == WoleixFanSpeed::LOW
+                ? WoleixFanSpeed::HIGH
+                : WoleixFanSpeed::LOW;
+            break;
+        default:
+            break;
+    }
+}
+
 /**
  * Add a command to the transmission queue.
  * 
- * Commands are queued in the order they should be transmitted.
+ * Commands are queued in the order they should be transmitted, either in
+ * commands_ or, during move_to() with a sink, directly in the sink.
  * 
  * @param command Command to add to the queue
  */
 void WoleixStateManager::enqueue_command_(const WoleixCommand& command)
 {
+    generated_++;
+    if (sink_ != nullptr)
+    {
+        WoleixCommand prioritized = command;
+        prioritized.set_priority(priority_);
+        emitted_ = sink_->emit(prioritized) && emitted_;
+        return;
+    }
     commands_.push_back(command);
+    commands_.back().set_priority(priority_);
+}
+
+/**
+ * Record commands that have gone out over IR.
+ * 
+ * @param type Button pressed
+ * @param presses Number of presses
+ */
+void WoleixStateManager::on_command_transmitted(WoleixCommand::Type type, uint32_t presses)
+{
+    for (uint32_t i = 0; i < presses; i++)
+    {
+        apply(transmitted_state_, type);
+    }
+}
+
+/**
+ * Record a button pressed on the physical remote.
+ * 
+ * @param type Button pressed
+ */
+void WoleixStateManager::on_remote_press(WoleixCommand::Type type)
+{
+    apply(transmitted_state_, type);
+    apply(current_state_, type);
+    desired_state_ = current_state_;
 }
 
 }  // namespace climate_ir_woleix
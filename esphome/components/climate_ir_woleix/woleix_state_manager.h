@@ -1,8 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
+#include <optional>
 
 #include "woleix_command.h"
 
@@ -73,7 +76,7 @@ struct WoleixInternalState {
         fan_speed(f)
     {}
 
-    bool operator==(const WoleixInternalState& other)
+    bool operator==(const WoleixInternalState& other) const
     {
         return power == other.power 
             && mode == other.mode
@@ -82,6 +85,58 @@ struct WoleixInternalState {
     }
 };
 
+/**
+ * @brief Temperature setting mode window, as seen from the start of a plan.
+ * 
+ * The AC unit leaves setting mode TEMP_SETTING_MODE_TIMEOUT_MS after the last
+ * temperature press. A press only counts on the window if it goes out at
+ * least TEMP_SETTING_MODE_GUARD_MS before the window closes; otherwise the
+ * protocol handler waits for the window to close and enters setting mode
+ * again. All times are relative to the start of the plan.
+ */
+struct WoleixSettingModeWindow {
+    /// End of a window that outlasts any plan
+    static constexpr uint32_t UNBOUNDED = UINT32_MAX;
+
+    uint32_t closes_at_ms{0};  /**< Time at which the window closes, 0 if it is closed */
+
+    /// Window that is closed
+    static constexpr WoleixSettingModeWindow closed() { return {0}; }
+    /// Window that stays open for @p remaining_ms
+    static constexpr WoleixSettingModeWindow open_for(uint32_t remaining_ms) { return {remaining_ms}; }
+    /// Window that never closes
+    static constexpr WoleixSettingModeWindow unbounded() { return {UNBOUNDED}; }
+
+    /// Whether the window is still open at @p at_ms
+    constexpr bool is_open_at(uint32_t at_ms) const { return closes_at_ms > at_ms; }
+
+    /// Whether a temperature press sent at @p at_ms can rely on the window
+    constexpr bool is_reusable_at(uint32_t at_ms) const
+    {
+        return closes_at_ms == UNBOUNDED ||
+            (closes_at_ms >= TEMP_SETTING_MODE_GUARD_MS && at_ms <= closes_at_ms - TEMP_SETTING_MODE_GUARD_MS);
+    }
+
+    /// Time to wait at @p at_ms until the window is over
+    constexpr uint32_t wait_for_close_at(uint32_t at_ms) const
+    {
+        return is_open_at(at_ms) && closes_at_ms != UNBOUNDED ? closes_at_ms - at_ms : 0;
+    }
+
+    /// Keep the window open after a temperature press sent at @p at_ms
+    constexpr void extend(uint32_t at_ms)
+    {
+        if (closes_at_ms != UNBOUNDED) closes_at_ms = std::max(closes_at_ms, at_ms + TEMP_SETTING_MODE_TIMEOUT_MS);
+    }
+
+    /// The same window, seen from a plan starting @p elapsed_ms later
+    constexpr WoleixSettingModeWindow after(uint32_t elapsed_ms) const
+    {
+        if (closes_at_ms == UNBOUNDED) return unbounded();
+        return open_for(is_open_at(elapsed_ms) ? closes_at_ms - elapsed_ms : 0);
+    }
+};
+
 /**
  * @brief Builder class for creating WoleixInternalState objects.
  * 
@@ -167,6 +222,16 @@ namespace WoleixCategory::StateManager
         Category::make(CategoryId::StateManager, 1, "StateManager.InvalidMode");
 }
 
+namespace WoleixMessages::StateManager
+{
+    inline constexpr WoleixMessage WX_MESSAGE_INVALID_MODE
+    {
+        WoleixSeverity::WX_SEVERITY_ERROR,
+        WoleixCategory::StateManager::WX_CATEGORY_INVALID_MODE,
+        "Invalid mode in sequence: from=%d, to=%d"
+    };
+}
+
 /**
  * @brief State manager for Woleix AC unit control via IR commands.
  * 
@@ -174,6 +239,12 @@ namespace WoleixCategory::StateManager
  * the necessary sequence of IR commands to transition
  * from the current state to a desired target state.
  * 
+ * Three states are tracked:
+ * - desired: the target last requested via move_to()
+ * - planned: where the generated commands lead (get_state())
+ * - transmitted: where the commands sent so far led, advanced through
+ *   on_command_transmitted() by the protocol handler
+ * 
  * Key behaviors:
  * - Power toggle affects all other states (turning ON resets to defaults)
  * - Mode cycles through COOL→DEHUM→FAN→COOL in sequence
@@ -222,6 +293,21 @@ public:
      */
     const std::vector<WoleixCommand>& move_to(const WoleixInternalState& target_state);
 
+    /**
+     * Set the target state and emit the command sequence straight into a sink.
+     * 
+     * Same planning as move_to(const WoleixInternalState&), but the commands
+     * are handed to @p sink as they are generated and committed at the end,
+     * without collecting them first. If the sink rejects the plan, the planned
+     * and desired states are left unchanged.
+     * 
+     * @param target_state Target state
+     * @param sink Destination of the generated commands, typically a
+     *             WoleixCommandQueue::Plan
+     * @return true if the sink committed the plan, false otherwise
+     */
+    bool move_to(const WoleixInternalState& target_state, WoleixCommandSink& sink);
+
     /**
      * Reset the internal state to device defaults.
      * 
@@ -239,14 +325,168 @@ public:
     /**
      * Get the current internal state.
      * 
+     * Same as get_planned_state().
+     * 
      * @return Const reference to the current state structure
      * 
      * @note This returns the tracked state, not the actual AC unit state
      */
     virtual const WoleixInternalState& get_state() const { return current_state_; }
 
+    /**
+     * Get the target last passed to move_to(), as requested.
+     * 
+     * Unlike the planned state, the temperature is neither clamped nor rounded.
+     * 
+     * @return Const reference to the desired state
+     */
+    const WoleixInternalState& get_desired_state() const { return desired_state_; }
+
+    /**
+     * Get the state the AC unit ends up in once all generated commands are transmitted.
+     * 
+     * @return Const reference to the planned state
+     */
+    const WoleixInternalState& get_planned_state() const { return current_state_; }
+
+    /**
+     * Get the state the AC unit is in according to the commands transmitted so far.
+     * 
+     * Lags behind the planned state while generated commands are still queued.
+     * 
+     * @return Const reference to the transmitted state
+     */
+    const WoleixInternalState& get_transmitted_state() const { return transmitted_state_; }
+
+    /**
+     * Record commands that have gone out over IR.
+     * 
+     * @param type Button pressed
+     * @param presses Number of presses
+     */
+    void on_command_transmitted(WoleixCommand::Type type, uint32_t presses = 1);
+
+    /**
+     * Record a button pressed on the physical remote.
+     * 
+     * The press takes effect on the AC unit right away, so it advances the
+     * transmitted state and the planned state alike. The desired state
+     * follows the planned one: the remote overrides the last requested target.
+     * 
+     * @param type Button pressed; temperature presses that only opened
+     *             setting mode are not recorded
+     */
+    void on_remote_press(WoleixCommand::Type type);
+
+    /**
+     * Discard the planned state of commands that were never transmitted.
+     * 
+     * Called after pending commands have been dropped, so that the next
+     * move_to() plans from the state actually transmitted so far.
+     */
+    void rebase_on_transmitted() { current_state_ = transmitted_state_; }
+
+    /**
+     * Account for a still pending command after rebase_on_transmitted().
+     * 
+     * @param command Command that stays queued
+     */
+    void replay_pending(const WoleixCommand& command)
+    {
+        for (uint32_t i = 0; i < command.get_repeat_count(); i++)
+        {
+            apply(current_state_, command.get_type());
+        }
+    }
+
+    /**
+     * Determine the priority class of the commands leading to a target.
+     * 
+     * Turning the unit off is high priority: it should not wait behind
+     * pending presses of a previous change.
+     * 
+     * @param target_state Requested target state
+     * @return Priority class for the commands planned by move_to()
+     */
+    WoleixCommand::Priority priority_of(const WoleixInternalState& target_state) const
+    {
+        return target_state.power == WoleixPowerState::OFF && current_state_.power == WoleixPowerState::ON
+            ? WoleixCommand::Priority::HIGH
+            : WoleixCommand::Priority::NORMAL;
+    }
+
+    /**
+     * Choose how move_to() orders the commands.
+     * 
+     * By default the commands follow a fixed order (power, mode, temperature, fan).
+     * With shortest-path planning enabled, WoleixPathPlanner searches the device
+     * state graph for the sequence with the lowest transmission time instead.
+     * 
+     * @param enabled true to use the shortest-path planner
+     */
+    void set_shortest_path_planning(bool enabled) { shortest_path_planning_ = enabled; }
+
+    /**
+     * Get the setting mode window the next plan starts into.
+     * 
+     * The shortest-path planner charges the setting mode entry only for
+     * temperature presses that cannot reuse this window. The default knows
+     * nothing about the protocol and assumes it closed; owners of a protocol
+     * handler override it with the window at the time the plan will go out.
+     * 
+     * @return Window as seen from the first command of the next plan
+     */
+    virtual WoleixSettingModeWindow setting_mode_window() const { return WoleixSettingModeWindow::closed(); }
+
+    /**
+     * Determine the next command on the way from one state to another.
+     * 
+     * Follows the same order as move_to() (power, mode, temperature, fan), so that
+     * repeatedly applying the returned command with apply() reproduces the
+     * move_to() sequence one command at a time. Used for just-in-time planning.
+     * 
+     * @param from State the AC unit is in
+     * @param to Target state, typically the result of a previous move_to()
+     *        (its temperature must be a whole number of degrees away from @p from)
+     * @return Next command type, or nothing if @p from already satisfies @p to
+     */
+    static std::optional<WoleixCommand::Type> next_command
+    (
+        const WoleixInternalState& from,
+        const WoleixInternalState& to
+    );
+
+    /**
+     * Apply the effect of a single button press to a tracked state.
+     * 
+     * Mirrors the AC unit behaviour: POWER toggles power, while the other
+     * buttons are only effective when the unit is on (and temperature
+     * buttons only in COOL mode).
+     * 
+     * @param state State to update in place
+     * @param type Button pressed
+     */
+    static void apply(WoleixInternalState& state, WoleixCommand::Type type);
+
 protected:
 
+    /**
+     * Generate IR commands from a transition table descriptor.
+     * 
+     * @param descriptor Descriptor looked up in WoleixTransitionTable
+     * @param target_state Target state the descriptor leads to
+     */
+    void generate_transition_commands_(uint8_t descriptor, const WoleixInternalState& target_state);
+
+    /**
+     * Generate IR commands one state component at a time.
+     * 
+     * Used for states outside the transition table.
+     * 
+     * @param target_state Target state
+     */
+    void generate_commands_incrementally_(const WoleixInternalState& target_state);
+
     /**
      * Generate IR commands to change power state.
      * 
@@ -293,16 +533,30 @@ protected:
     int calculate_mode_steps_(WoleixMode from_mode, WoleixMode to_mode);
 
     /**
-     * Add a command to the transmission queue.
+     * Generate the commands for a transition, see move_to().
+     * 
+     * @param target_state Target state
+     */
+    void plan_(const WoleixInternalState& target_state);
+
+    /**
+     * Add a command to the transmission queue, or emit it into the sink.
      * 
      * @param command IR command object
      */
     void enqueue_command_(const WoleixCommand& command);
 
-    WoleixInternalState current_state_;  /**< Current tracked state of the AC unit */
+    WoleixInternalState desired_state_;  /**< Target last requested via move_to() */
+    WoleixInternalState current_state_;  /**< Planned state, reached once all generated commands are transmitted */
+    WoleixInternalState transmitted_state_;  /**< State reached by the commands transmitted so far */
     std::unique_ptr<WoleixCommandFactory> command_factory_{nullptr};  /**< Factory for creating IR commands */
 
     std::vector<WoleixCommand> commands_;
+    WoleixCommandSink* sink_{nullptr};  /**< Destination of the commands being generated, commands_ if null */
+    size_t generated_{0};  /**< Number of commands generated by the current move_to() */
+    bool emitted_{true};  /**< Whether the sink took all commands generated so far */
+    WoleixCommand::Priority priority_{WoleixCommand::Priority::NORMAL};  /**< Priority class of the commands being generated */
+    bool shortest_path_planning_{false};  /**< Plan with WoleixPathPlanner instead of the fixed order */
 };
 
 }  // namespace climate_ir_woleix
@@ -1,7 +1,9 @@
 #pragma once
 
-#include <string>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
 
 namespace esphome
 {
@@ -28,57 +30,121 @@ struct Category
 {
     uint32_t value;
     const char* name;
-    
+
     constexpr uint16_t module_id() const { return value >> 16; }
     constexpr uint16_t local_id() const { return value & 0xFFFF; }
-    
+
     static constexpr Category make(uint16_t module, uint16_t local, const char* name)
     {
         return Category{(uint32_t(module) << 16) | local, name};
     }
-    
+
     constexpr bool operator==(Category other) const { return value == other.value; }
 };
 
+/**
+ * @brief Enumeration of severity levels for status messages.
+ */
+enum class WoleixSeverity: uint8_t
+{
+    WX_SEVERITY_ERROR,    ///< Error severity
+    WX_SEVERITY_WARNING,  ///< Warning severity
+    WX_SEVERITY_INFO,     ///< Information severity
+    WX_SEVERITY_DEBUG     ///< Debug severity
+};
+
+/**
+ * Deliberately never defined nor constexpr: calling it from the consteval
+ * WoleixMessage constructor is a compile error naming the problem, without
+ * relying on exceptions, which ESP-IDF builds disable.
+ */
+void woleix_message_has_too_many_args();
+
+/**
+ * @brief Entry of the compile-time message catalogue.
+ *
+ * Ties a category to its severity and a printf-style text with up to
+ * WoleixMessage::MAX_ARGS integer conversions (`%d`, `%u`, `%x`, ...). Every
+ * message is a constant living in flash; statuses only refer to it.
+ * The constructor is consteval, so a text with too many conversions does not
+ * compile.
+ */
+struct WoleixMessage
+{
+    /// Maximum number of integer arguments of a message
+    static constexpr size_t MAX_ARGS = 2;
+
+    consteval WoleixMessage(WoleixSeverity severity, Category category, const char* text)
+        : severity(severity), category(category), text(text)
+    {
+        size_t conversions = 0;
+        for (const char* c = text; *c != '\0'; c++)
+        {
+            if (*c != '%') continue;
+            if (*(c + 1) == '%')
+            {
+                c++;
+                continue;
+            }
+            conversions++;
+        }
+        if (conversions > MAX_ARGS) woleix_message_has_too_many_args();
+    }
+
+    WoleixSeverity severity;
+    Category category;
+    const char* text;
+};
+
 /**
  * @brief Represents a status message in the Woleix system.
+ *
+ * A catalogue message plus its integer arguments: trivially copyable and
+ * a few bytes in size, so reporting a status never allocates. The text is
+ * only rendered, into a caller-provided buffer, when it is logged.
  */
 class WoleixStatus
 {
 public:
-    /**
-     * @brief Enumeration of severity levels for status messages.
-     */
-    enum class Severity
-    {
-        WX_SEVERITY_ERROR,    ///< Error severity
-        WX_SEVERITY_WARNING,  ///< Warning severity
-        WX_SEVERITY_INFO,     ///< Information severity
-        WX_SEVERITY_DEBUG     ///< Debug severity
-    };
+    using Severity = WoleixSeverity;
+
+    /// Buffer size that fits every rendered message
+    static constexpr size_t MAX_TEXT_LENGTH = 80;
 
     /**
      * @brief Constructs a WoleixStatus object.
-     * @param severity The severity level of the status.
-     * @param category The category of the status.
-     * @param message The message content of the status.
+     * @param message The catalogue entry of the status.
+     * @param arg0 First argument of the message text, if any.
+     * @param arg1 Second argument of the message text, if any.
      */
-    WoleixStatus(Severity severity, Category category, std::string message)
-        : severity_(severity), category_(category), message_(message)
+    constexpr explicit WoleixStatus(const WoleixMessage& message, int arg0 = 0, int arg1 = 0)
+        : message_(&message), args_{arg0, arg1}
     {}
 
-    const Severity get_severity() const { return severity_; }
-    Category get_category() const { return category_; }
-    const std::string get_message() const { return message_; }
+    constexpr Severity get_severity() const { return message_->severity; }
+    constexpr Category get_category() const { return message_->category; }
+    constexpr const WoleixMessage& get_message() const { return *message_; }
+    constexpr int get_arg(size_t index) const { return args_[index]; }
+
+    /**
+     * @brief Render the message text with its arguments.
+     * @param buffer Destination, always NUL-terminated
+     * @param size Size of @p buffer
+     * @return @p buffer, for use in log statements
+     */
+    const char* format(char* buffer, size_t size) const
+    {
+        snprintf(buffer, size, message_->text, args_[0], args_[1]);
+        return buffer;
+    }
 
-    bool operator==(const WoleixStatus& other) const
+    constexpr bool operator==(const WoleixStatus& other) const
     {
-        return severity_ == other.severity_ && category_ == other.category_;
+        return get_severity() == other.get_severity() && get_category() == other.get_category();
     }
 protected:
-    Severity severity_;
-    Category category_;
-    std::string message_;
+    const WoleixMessage* message_;
+    std::array<int, WoleixMessage::MAX_ARGS> args_;
 };
 
 class WoleixStatusReporter;
@@ -99,30 +165,88 @@ public:
 };
 
 /**
- * @brief Class responsible for reporting status changes to observers.
+ * @brief Fixed-capacity bus delivering statuses to their observers.
+ *
+ * One bus is shared by all reporters of a component, instead of every
+ * reporter keeping its own observer list. Observers are registered once,
+ * when the component is wired up, into a fixed array: no allocation, ever.
  */
-class WoleixStatusReporter
+class WoleixStatusBus
 {
 public:
-    virtual ~WoleixStatusReporter() = default;
-    virtual void register_observer(WoleixStatusObserver* observer)
+    /// Maximum number of observers
+    static constexpr size_t MAX_OBSERVERS = 4;
+
+    /**
+     * @brief Register an observer.
+     * @param observer Observer to add
+     * @return false if the bus is full, true otherwise
+     */
+    bool subscribe(WoleixStatusObserver* observer)
     {
-        observers_.push_back(observer);
+        if (count_ == MAX_OBSERVERS) return false;
+        observers_[count_++] = observer;
+        return true;
     }
-    virtual void unregister_observer(WoleixStatusObserver* observer)
+
+    /**
+     * @brief Unregister an observer; does nothing if it is not registered.
+     * @param observer Observer to remove
+     */
+    void unsubscribe(WoleixStatusObserver* observer)
     {
-        std::erase(observers_, observer);
+        for (size_t i = 0; i < count_; i++)
+        {
+            if (observers_[i] != observer) continue;
+            for (size_t j = i + 1; j < count_; j++) observers_[j - 1] = observers_[j];
+            observers_[--count_] = nullptr;
+            return;
+        }
     }
 
-    virtual void report(const WoleixStatus& status)
+    /**
+     * @brief Deliver a status to all observers, in registration order.
+     * @param reporter The reporter that generated the status
+     * @param status The status to deliver
+     */
+    void publish(const WoleixStatusReporter& reporter, const WoleixStatus& status) const
     {
-        for (auto observer : observers_)
+        for (size_t i = 0; i < count_; i++)
         {
-            observer->observe(*this, status);
+            observers_[i]->observe(reporter, status);
         }
-    } 
+    }
+
+    size_t observer_count() const { return count_; }
+
+protected:
+    std::array<WoleixStatusObserver*, MAX_OBSERVERS> observers_{};
+    size_t count_{0};
+};
+
+/**
+ * @brief Class responsible for reporting status changes to observers.
+ *
+ * Statuses are published on the bus the reporter is attached to; without
+ * a bus, they are dropped.
+ */
+class WoleixStatusReporter
+{
+public:
+    virtual ~WoleixStatusReporter() = default;
+
+    /**
+     * @brief Attach the reporter to a status bus.
+     * @param bus Bus to publish on, nullptr to detach
+     */
+    void set_status_bus(WoleixStatusBus* bus) { status_bus_ = bus; }
+
+    virtual void report(const WoleixStatus& status)
+    {
+        if (status_bus_) status_bus_->publish(*this, status);
+    }
 protected:
-    std::vector<WoleixStatusObserver*> observers_;
+    WoleixStatusBus* status_bus_{nullptr};
 };
 
 }
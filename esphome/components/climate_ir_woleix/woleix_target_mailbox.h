@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "woleix_constants.h"
+#include "woleix_command.h"
+#include "woleix_state_manager.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Single-slot, last-writer-wins command source with just-in-time planning.
+ *
+ * Instead of planning the whole command sequence up front and queueing it,
+ * the mailbox keeps only two states:
+ * - the desired state, overwritten by every post()
+ * - the transmitted state, advanced by every dequeue()
+ *
+ * Whenever the protocol handler is ready to send, get() plans just the next
+ * command from the transmitted state towards the desired one. Memory use is
+ * constant, no request is ever dropped, and the AC unit converges on the latest
+ * target instead of replaying stale intermediate ones.
+ *
+ * Usage example:
+ * @code
+ * WoleixTargetMailbox mailbox;
+ * mailbox.reset(state_manager.get_state());
+ * state_manager.move_to(target);
+ * mailbox.post(state_manager.get_state());  // handler pulls commands on its own pace
+ * @endcode
+ */
+class WoleixTargetMailbox : public WoleixCommandSource
+{
+public:
+    /**
+     * @brief Construct a new mailbox.
+     * @param address NEC address used for the planned commands
+     */
+    WoleixTargetMailbox(uint16_t address = ADDRESS_NEC)
+      : command_factory_(address)
+    {}
+
+    /**
+     * @brief Replace the desired state.
+     *
+     * Notifies the consumers if the mailbox had nothing left to transmit.
+     *
+     * @param desired State the AC unit should eventually reach, as resolved
+     *        by WoleixStateManager::move_to()
+     */
+    void post(const WoleixInternalState& desired)
+    {
+        bool was_empty = is_empty();
+        desired_ = desired;
+        if (was_empty && !is_empty())
+        {
+            on_command_enqueued();
+        }
+    }
+
+    /**
+     * @brief Forget any pending target and assume the AC unit is in @p state.
+     * @param state Known state of the AC unit
+     */
+    void reset(const WoleixInternalState& state)
+    {
+        desired_ = state;
+        transmitted_ = state;
+    }
+
+    std::optional<WoleixCommand> get() const override
+    {
+        auto type = WoleixStateManager::next_command(transmitted_, desired_);
+        if (!type.has_value()) return {};
+        return command_factory_.create(type.value());
+    }
+
+    bool dequeue() override
+    {
+        auto type = WoleixStateManager::next_command(transmitted_, desired_);
+        if (!type.has_value()) return false;
+        WoleixStateManager::apply(transmitted_, type.value());
+        return true;
+    }
+
+    bool is_empty() const override
+    {
+        return !WoleixStateManager::next_command(transmitted_, desired_).has_value();
+    }
+
+    const WoleixInternalState& get_desired() const { return desired_; }
+    const WoleixInternalState& get_transmitted() const { return transmitted_; }
+
+protected:
+    WoleixCommandFactory command_factory_;  /**< Factory for the planned commands */
+    WoleixInternalState desired_;           /**< Latest target (last writer wins) */
+    WoleixInternalState transmitted_;       /**< State reached by the commands dequeued so far */
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
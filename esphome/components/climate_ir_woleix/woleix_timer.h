@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Identifiers of the timers used by the component.
+ *
+ * Small integers instead of string names, so that scheduling a timer never
+ * builds or hashes a string.
+ */
+enum class WoleixTimerId: uint8_t
+{
+    NEXT_COMMAND,   ///< Delay before the protocol handler processes the next command
+    SETTING_MODE,   ///< Expiry of the temperature setting mode
+    METRICS,        ///< Next publication of the metrics sensors
+    DEBOUNCE,       ///< End of the transmit_state() debounce window
+    READINGS        ///< Next publication of coalesced sensor readings
+};
+
+/**
+ * @brief Number of WoleixTimerId values.
+ */
+inline constexpr size_t WOLEIX_TIMER_COUNT = 5;
+
+/**
+ * @brief Fixed-size, non-allocating timer callback.
+ *
+ * Stores a small, trivially copyable callable (typically a lambda capturing
+ * `this`) inline, unlike std::function, which may allocate depending on the
+ * callable. Callables that do not fit are rejected at compile time.
+ */
+class WoleixTimerCallback
+{
+public:
+    /// Inline storage size, enough for a lambda capturing two pointers
+    static constexpr size_t STORAGE_SIZE = 2 * sizeof(void*);
+
+    WoleixTimerCallback() = default;
+
+    template<typename F>
+        requires (!std::is_same_v<std::decay_t<F>, WoleixTimerCallback>)
+    WoleixTimerCallback(F callable)
+    {
+        static_assert(sizeof(F) <= STORAGE_SIZE, "Callable too large for WoleixTimerCallback");
+        static_assert(alignof(F) <= alignof(void*), "Callable over-aligned for WoleixTimerCallback");
+        static_assert(std::is_trivially_copyable_v<F>, "WoleixTimerCallback requires a trivially copyable callable");
+
+        ::new (static_cast<void*>(storage_)) F(callable);
+        invoke_ = [](void* storage) { (*static_cast<F*>(storage))(); };
+    }
+
+    /**
+     * @brief Invoke the stored callable, if any.
+     */
+    void operator()() const
+    {
+        if (invoke_) invoke_(storage_);
+    }
+
+    explicit operator bool() const { return invoke_ != nullptr; }
+
+private:
+    alignas(void*) mutable unsigned char storage_[STORAGE_SIZE]{};
+    void (*invoke_)(void*){nullptr};
+};
+
+/**
+ * @brief Interface for scheduling one-shot timers by ID.
+ *
+ * Scheduling a timer with an ID that is already pending replaces it. The
+ * scheduler also provides the clock the timers run on.
+ */
+class WoleixTimerScheduler
+{
+public:
+    virtual ~WoleixTimerScheduler() = default;
+
+    /**
+     * @brief Schedule a one-shot timer.
+     * @param id Timer to (re)schedule
+     * @param delay_ms Delay in milliseconds
+     * @param callback Function to call when the timer fires
+     */
+    virtual void schedule_timer(WoleixTimerId id, uint32_t delay_ms, WoleixTimerCallback callback) = 0;
+
+    /**
+     * @brief Cancel a pending timer; does nothing if it is not pending.
+     * @param id Timer to cancel
+     */
+    virtual void cancel_timer(WoleixTimerId id) = 0;
+
+    /**
+     * @brief Current time on the scheduler's clock.
+     * @return Milliseconds since an arbitrary epoch, wrapping around at 2^32
+     */
+    virtual uint32_t now_ms() const = 0;
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
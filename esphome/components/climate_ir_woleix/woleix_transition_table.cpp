@@ -0,0 +1,115 @@
+#include <cmath>
+#include <algorithm>
+#include <array>
+
+#include "woleix_transition_table.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+using TransitionTable = std::array<std::array<uint8_t, WoleixTransitionTable::STATE_COUNT>, WoleixTransitionTable::STATE_COUNT>;
+
+/**
+ * All-pairs transition descriptors, generated at compile time into flash.
+ */
+static constexpr TransitionTable TRANSITION_TABLE = []()
+{
+    TransitionTable table{};
+    for (size_t from = 0; from < WoleixTransitionTable::STATE_COUNT; from++)
+    {
+        for (size_t to = 0; to < WoleixTransitionTable::STATE_COUNT; to++)
+        {
+            table[from][to] = WoleixTransitionTable::describe
+            (
+                static_cast<WoleixPackedState>(from),
+                static_cast<WoleixPackedState>(to)
+            );
+        }
+    }
+    return table;
+}();
+
+static bool is_valid_(const WoleixInternalState& state)
+{
+    return (state.power == WoleixPowerState::OFF || state.power == WoleixPowerState::ON)
+        && static_cast<size_t>(state.mode) < MODE_CYCLE_LENGTH
+        && (state.fan_speed == WoleixFanSpeed::LOW || state.fan_speed == WoleixFanSpeed::HIGH);
+}
+
+/**
+ * Pack a tracked state.
+ *
+ * @param state State to pack
+ * @return Packed state, or nothing if the state is outside the table
+ */
+std::optional<WoleixPackedState> WoleixTransitionTable::pack(const WoleixInternalState& state)
+{
+    if (!is_valid_(state)) return {};
+    if (!(state.temperature >= WOLEIX_TEMP_MIN && state.temperature <= WOLEIX_TEMP_MAX)) return {};
+
+    float steps = state.temperature - WOLEIX_TEMP_MIN;
+    if (std::trunc(steps) != steps) return {};
+
+    return pack(state.power, state.mode, static_cast<uint8_t>(steps), state.fan_speed);
+}
+
+/**
+ * Pack a target state the way move_to() resolves it.
+ *
+ * @param from Current state
+ * @param to Requested target state
+ * @return Packed target state, or nothing if either state is outside the table
+ */
+std::optional<WoleixPackedState> WoleixTransitionTable::pack_target
+(
+    const WoleixInternalState& from,
+    const WoleixInternalState& to
+)
+{
+    auto packed_from = pack(from);
+    if (!packed_from.has_value() || !is_valid_(to)) return {};
+
+    uint8_t temp_index = temp_index_of(packed_from.value());
+    if (to.mode == WoleixMode::COOL)
+    {
+        float target_temp = std::clamp(to.temperature, WOLEIX_TEMP_MIN, WOLEIX_TEMP_MAX);
+        if (std::isnan(target_temp)) return {};
+        // Round the difference, not the target, so that x.5 targets resolve like move_to()
+        temp_index += static_cast<int>(std::round(target_temp - from.temperature));
+    }
+    return pack(to.power, to.mode, temp_index, to.fan_speed);
+}
+
+/**
+ * Expand a packed state.
+ *
+ * @param state Packed state
+ * @return Tracked state
+ */
+WoleixInternalState WoleixTransitionTable::unpack(WoleixPackedState state)
+{
+    return WoleixInternalState
+    (
+        power_of(state),
+        mode_of(state),
+        WOLEIX_TEMP_MIN + static_cast<float>(temp_index_of(state)),
+        fan_speed_of(state)
+    );
+}
+
+/**
+ * Look up the transition descriptor between two packed states.
+ *
+ * @param from Packed current state
+ * @param to Packed target state
+ * @return Transition descriptor
+ */
+uint8_t WoleixTransitionTable::lookup(WoleixPackedState from, WoleixPackedState to)
+{
+    return TRANSITION_TABLE[from][to];
+}
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "woleix_constants.h"
+#include "woleix_state_manager.h"
+
+namespace esphome
+{
+namespace climate_ir_woleix
+{
+
+/**
+ * @brief Device state packed into a single byte.
+ *
+ * Dense index over (power, mode, temperature step, fan speed), so the 192
+ * reachable states map to 0..191 and can index the transition table directly.
+ */
+using WoleixPackedState = uint8_t;
+
+/**
+ * @brief Precomputed all-pairs transition table.
+ *
+ * For every pair of packed states, the table holds a one-byte descriptor of
+ * the command sequence move_to() generates between them:
+ *
+ * | Bits | Meaning                                                        |
+ * |------|----------------------------------------------------------------|
+ * | 7    | POWER press                                                    |
+ * | 5-6  | Number of MODE presses (0-2)                                   |
+ * | 0-4  | 0: nothing, 1-15: TEMP_UP x n, 16-30: TEMP_DOWN x (n - 15),    |
+ * |      | 31: FAN_SPEED press                                            |
+ *
+ * Temperature and fan speed changes never happen in the same transition
+ * (temperature is only set in COOL mode, fan speed only in FAN mode), so they
+ * share the payload bits. The table is generated at compile time and lives in
+ * flash (192 x 192 bytes); planning becomes a single lookup without floating
+ * point arithmetic.
+ */
+class WoleixTransitionTable
+{
+public:
+    /// Number of whole-degree temperature steps (15-30°C)
+    static constexpr size_t TEMP_STEP_COUNT = static_cast<size_t>(WOLEIX_TEMP_MAX - WOLEIX_TEMP_MIN) + 1;
+    /// Number of packed states
+    static constexpr size_t STATE_COUNT = 2 * MODE_CYCLE_LENGTH * TEMP_STEP_COUNT * 2;
+
+    static constexpr uint8_t POWER_BIT = 0x80;
+    static constexpr uint8_t MODE_SHIFT = 5;
+    static constexpr uint8_t MODE_MASK = 0x03;
+    static constexpr uint8_t PAYLOAD_MASK = 0x1F;
+    static constexpr uint8_t PAYLOAD_DOWN_BASE = 15;
+    static constexpr uint8_t PAYLOAD_FAN = 31;
+
+    static_assert(STATE_COUNT <= 256, "Packed state must fit into a byte");
+
+    /**
+     * @brief Pack state fields into a byte.
+     * @param temp_index Temperature step above WOLEIX_TEMP_MIN (0-15)
+     */
+    static constexpr WoleixPackedState pack
+    (
+        WoleixPowerState power,
+        WoleixMode mode,
+        uint8_t temp_index,
+        WoleixFanSpeed fan_speed
+    )
+    {
+        size_t index = static_cast<size_t>(power);
+        index = index * MODE_CYCLE_LENGTH + static_cast<size_t>(mode);
+        index = index * TEMP_STEP_COUNT + temp_index;
+        index = index * 2 + static_cast<size_t>(fan_speed);
+        return static_cast<WoleixPackedState>(index);
+    }
+
+    static constexpr WoleixFanSpeed fan_speed_of(WoleixPackedState state)
+    {
+        return static_cast<WoleixFanSpeed>(state % 2);
+    }
+
+    static constexpr uint8_t temp_index_of(WoleixPackedState state)
+    {
+        return static_cast<uint8_t>((state / 2) % TEMP_STEP_COUNT);
+    }
+
+    static constexpr WoleixMode mode_of(WoleixPackedState state)
+    {
+        return static_cast<WoleixMode>((state / (2 * TEMP_STEP_COUNT)) % MODE_CYCLE_LENGTH);
+    }
+
+    static constexpr WoleixPowerState power_of(WoleixPackedState state)
+    {
+        return static_cast<WoleixPowerState>(state / (2 * TEMP_STEP_COUNT * MODE_CYCLE_LENGTH));
+    }
+
+    /**
+     * @brief Pack a tracked state.
+     * @return Packed state, or nothing if the state is outside the table
+     *         (invalid enum value, temperature off the whole-degree grid)
+     */
+    static std::optional<WoleixPackedState> pack(const WoleixInternalState& state);
+
+    /**
+     * @brief Pack a target state the way move_to() resolves it.
+     *
+     * The target temperature is clamped and rounded to a whole number of
+     * degrees away from @p from.
+     *
+     * @param from Current state, as accepted by pack()
+     * @param to Requested target state
+     * @return Packed target state, or nothing if either state is outside the table
+     */
+    static std::optional<WoleixPackedState> pack_target(const WoleixInternalState& from, const WoleixInternalState& to);
+
+    /**
+     * @brief Expand a packed state.
+     */
+    static WoleixInternalState unpack(WoleixPackedState state);
+
+    /**
+     * @brief Look up the transition descriptor between two packed states.
+     */
+    static uint8_t lookup(WoleixPackedState from, WoleixPackedState to);
+
+    /**
+     * @brief Compute a transition descriptor; used to generate the table.
+     *
+     * Follows move_to(): power first, stop if the target is OFF, then mode
+     * (forward only), then temperature in COOL or fan speed in FAN mode.
+     */
+    static constexpr uint8_t describe(WoleixPackedState from, WoleixPackedState to)
+    {
+        uint8_t descriptor = 0;
+        if (power_of(from) != power_of(to)) descriptor |= POWER_BIT;
+        if (power_of(to) == WoleixPowerState::OFF) return descriptor;
+
+        size_t from_mode = static_cast<size_t>(mode_of(from));
+        size_t to_mode = static_cast<size_t>(mode_of(to));
+        size_t mode_steps = (to_mode + MODE_CYCLE_LENGTH - from_mode) % MODE_CYCLE_LENGTH;
+        descriptor |= static_cast<uint8_t>(mode_steps << MODE_SHIFT);
+
+        if (mode_of(to) == WoleixMode::COOL)
+        {
+            int steps = static_cast<int>(temp_index_of(to)) - static_cast<int>(temp_index_of(from));
+            if (steps > 0) descriptor |= static_cast<uint8_t>(steps);
+            if (steps < 0) descriptor |= static_cast<uint8_t>(PAYLOAD_DOWN_BASE - steps);
+        }
+        else if (mode_of(to) == WoleixMode::FAN && fan_speed_of(from) != fan_speed_of(to))
+        {
+            descriptor |= PAYLOAD_FAN;
+        }
+        return descriptor;
+    }
+
+    static constexpr bool toggles_power(uint8_t descriptor) { return (descriptor & POWER_BIT) != 0; }
+
+    static constexpr uint8_t mode_steps(uint8_t descriptor) { return (descriptor >> MODE_SHIFT) & MODE_MASK; }
+
+    /// Signed number of temperature steps (positive: TEMP_UP, negative: TEMP_DOWN)
+    static constexpr int temp_steps(uint8_t descriptor)
+    {
+        uint8_t payload = descriptor & PAYLOAD_MASK;
+        if (payload == PAYLOAD_FAN) return 0;
+        if (payload > PAYLOAD_DOWN_BASE) return PAYLOAD_DOWN_BASE - payload;
+        return payload;
+    }
+
+    static constexpr bool toggles_fan(uint8_t descriptor) { return (descriptor & PAYLOAD_MASK) == PAYLOAD_FAN; }
+};
+
+}  // namespace climate_ir_woleix
+}  // namespace esphome
@@ -1,6 +1,9 @@
 #include <optional>
 #include <functional>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -11,6 +14,7 @@
 #include "climate_ir_woleix.h"
 #include "woleix_state_mapper.h"
 #include "woleix_command.h"
+#include "woleix_nec_pulse_cache.h"
 #include "woleix_protocol_handler.h"
 #include "woleix_status.h"
 
@@ -26,11 +30,17 @@ using testing::Return;
 using testing::AtLeast;
 using testing::Invoke;
 
-// namespace WoleixCategory::Testing
-// {
-//     inline constexpr auto WX_CATEGORY_JUST_TESTING =
-//         Category::make(CategoryId::Testing, 1, "Testing.Whatever");
-// }
+namespace TestMessages
+{
+    inline constexpr WoleixMessage WX_MESSAGE_INFO
+    {
+        WoleixSeverity::WX_SEVERITY_INFO, Category::make(99, 99, "Testing.Testing"), "Test message"
+    };
+    inline constexpr WoleixMessage WX_MESSAGE_WARNING
+    {
+        WoleixSeverity::WX_SEVERITY_WARNING, Category::make(99, 99, "Testing.Testing"), "Test warning message"
+    };
+}
 
 // Custom GMock matcher for checking WoleixCommand type
 MATCHER_P(IsCommandOfType, expected_type, "")
@@ -41,7 +51,7 @@ MATCHER_P(IsCommandOfType, expected_type, "")
 class MockRemoteTransmitterBase : public RemoteTransmitterBase
 {
 public:
-    MOCK_METHOD(void, send_, (const NECProtocol::ProtocolData& data, uint32_t repeats, uint32_t wait), ());
+    MOCK_METHOD(void, send_internal, (uint32_t send_times, uint32_t send_wait), (override));
 };
 
 
@@ -116,6 +126,15 @@ public:
         current_state_.mode = woleix_mode;
         current_state_.temperature = temperature;
         current_state_.fan_speed = woleix_fan_speed;
+        transmitted_state_ = current_state_;
+        target_mailbox_.reset(current_state_);
+    }
+
+    // Switch to just-in-time planning after setup() already ran
+    void use_just_in_time_planning()
+    {
+        set_planning(WoleixPlanning::JUST_IN_TIME);
+        WoleixProtocolHandler::setup(command_source_());
     }
 
     WoleixInternalState get_internal_state()
@@ -131,31 +150,37 @@ public:
     // Add convenience method to run until empty
     void run_until_empty()
     {
-        if (scheduler_ && command_queue_)
+        if (scheduler_)
         {
             // Process commands one at a time without triggering setting mode timeout
-            while (!command_queue_->is_empty())
+            while (!command_source_()->is_empty())
             {
-                scheduler_->fire_timeout("proto_next_cmd");
+                scheduler_->fire_timeout(WoleixTimerId::NEXT_COMMAND);
             }
         }
     }
     
+    // Run the clock of the mock scheduler
+    uint32_t now_ms() const override
+    {
+        return scheduler_ ? scheduler_->now_ms() : 0;
+    }
+
     // Override Component's set_timeout to use our mock scheduler
-    void set_timeout(const std::string& name, uint32_t delay_ms, std::function<void()>&& callback) override
+    void set_timeout(uint32_t id, uint32_t delay_ms, std::function<void()>&& callback) override
     {
         if (scheduler_)
         {
-            scheduler_->get_setter()(name, delay_ms, std::move(callback));
+            scheduler_->schedule(static_cast<WoleixTimerId>(id), delay_ms, std::move(callback));
         }
     }
     
     // Override Component's cancel_timeout to use our mock scheduler
-    bool cancel_timeout(const std::string& name) override
+    bool cancel_timeout(uint32_t id) override
     {
         if (scheduler_)
         {
-            scheduler_->get_canceller()(name);
+            scheduler_->cancel(static_cast<WoleixTimerId>(id));
         }
         return true;
     }
@@ -167,8 +192,18 @@ public:
 
     void enqueue_commands(const std::vector<WoleixCommand>& commands)
     {
-        command_queue_->enqueue(commands);
+        command_queue_.enqueue(commands);
+    }
+
+    size_t queued_commands() const { return command_queue_.length(); }
+
+    // Record the setting mode window the last plan was made for
+    WoleixSettingModeWindow setting_mode_window() const override
+    {
+        planned_window = WoleixClimate::setting_mode_window();
+        return planned_window;
     }
+    mutable WoleixSettingModeWindow planned_window{};
 
     MOCK_METHOD(const WoleixInternalState&, get_state, (), (const, override));
     MOCK_METHOD(void, publish_state, (), (override)); 
@@ -177,6 +212,39 @@ public:
     
     // Make observe method public for testing
     using WoleixClimate::observe;
+    using WoleixClimate::command_source_;
+    using WoleixClimate::control;
+    using WoleixClimate::publish_metrics_;
+    using WoleixClimate::on_receive;
+
+    bool in_setting_mode() const { return is_in_temp_setting_mode_(); }
+
+    // Send frames through the transmitter instead of only recording the call
+    void send_frames()
+    {
+        ON_CALL(*this, transmit_(_)).WillByDefault(Invoke([this](const WoleixCommand& command)
+        {
+            WoleixHandler::transmit_(command);
+        }));
+    }
+
+    // Report statuses through the climate instead of only recording the call
+    void report_statuses(std::function<void()> reported = {})
+    {
+        ON_CALL(*this, report_status(_)).WillByDefault(Invoke([this, reported](const WoleixStatus& status)
+        {
+            WoleixClimate::report_status(status);
+            if (reported) reported();
+        }));
+    }
+
+    // Hand a frame to the climate as the remote receiver would
+    bool receive(uint16_t command, uint16_t address = ADDRESS_NEC)
+    {
+        RawTimings timings;
+        WoleixNecPulseCache::encode(address, command, timings);
+        return on_receive(RemoteReceiveData(timings));
+    }
         
     MockScheduler* scheduler_{nullptr};
 };
@@ -202,10 +270,15 @@ protected:
         delete mock_transmitter;
     }
 
-    const std::vector<WoleixCommand>& fill_commands(size_t number)
+    const std::vector<WoleixCommand>& fill_commands
+    (
+        size_t number,
+        WoleixCommand::Priority priority = WoleixCommand::Priority::NORMAL
+    )
     {
         commands.clear();
         WoleixCommand cmd(WoleixCommand::Type::POWER, 0, 1);
+        cmd.set_priority(priority);
         for (int i = 0; i < number; i++)
         {
             commands.push_back(cmd);
@@ -662,6 +735,136 @@ TEST_F(WoleixClimateTest, CompleteStateChangeSequence)
     mock_climate->run_until_empty();
 }
 
+// ============================================================================
+// Test: Command Coalescing
+// ============================================================================
+
+/**
+ * Test: A round trip of the target temperature transmits nothing
+ * 
+ * 24 -> 26 -> 24 in quick succession: the second target replaces the pending
+ * TEMP_UP presses, and planning from the transmitted 24 needs no press at all.
+ */
+TEST_F(WoleixClimateTest, TemperatureRoundTripTransmitsNothing)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 24.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+
+    EXPECT_CALL(*mock_climate, transmit_(_))
+        .Times(0);
+
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 26.0f;
+    mock_climate->transmit_state();
+    mock_climate->target_temperature = 24.0f;
+    mock_climate->transmit_state();
+    mock_climate->run_until_empty();
+
+    EXPECT_EQ(mock_climate->get_internal_state().temperature, 24.0f);
+}
+
+/**
+ * Test: Overlapping requests only transmit the net change
+ * 
+ * 20 -> 24 -> 22 leaves two TEMP_UP presses (n+1 = 3 transmissions).
+ */
+TEST_F(WoleixClimateTest, OverlappingTemperatureChangesTransmitNetChange)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 20.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_UP)))
+        .Times(3);
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_DOWN)))
+        .Times(0);
+
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 24.0f;
+    mock_climate->transmit_state();
+    mock_climate->target_temperature = 22.0f;
+    mock_climate->transmit_state();
+    mock_climate->run_until_empty();
+}
+
+// ============================================================================
+// Test: Just-in-Time Planning
+// ============================================================================
+
+/**
+ * Test: Just-in-time planning transmits the same commands as the queue
+ * 
+ * COOL 25°C -> FAN HIGH from OFF: POWER, 2x MODE, FAN_SPEED.
+ */
+TEST_F(WoleixClimateTest, JustInTimePlanningReachesTarget)
+{
+    mock_climate->use_just_in_time_planning();
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_OFF);
+
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::POWER)))
+        .Times(1);
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::MODE)))
+        .Times(2);
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::FAN_SPEED)))
+        .Times(1);
+
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_FAN_ONLY;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_HIGH;
+    mock_climate->transmit_state();
+    mock_climate->run_until_empty();
+
+    EXPECT_TRUE(mock_climate->command_source_()->is_empty());
+}
+
+/**
+ * Test: A target changed mid-sequence replaces the stale one
+ * 
+ * 20 -> 28 is interrupted after one TEMP_UP transmission (the setting mode
+ * entry press, still at 20) by a new target of 22. Only two more TEMP_UP
+ * presses are needed, and the remaining presses towards 28 are never sent.
+ */
+TEST_F(WoleixClimateTest, JustInTimePlanningConvergesOnLatestTarget)
+{
+    mock_climate->use_just_in_time_planning();
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 20.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_UP)))
+        .Times(3);
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_DOWN)))
+        .Times(0);
+
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 28.0f;
+    mock_climate->transmit_state();
+    mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+
+    mock_climate->target_temperature = 22.0f;
+    mock_climate->transmit_state();
+    mock_climate->run_until_empty();
+
+    EXPECT_EQ(mock_climate->get_internal_state().temperature, 22.0f);
+}
+
+/**
+ * Test: Just-in-time planning never puts the producer on hold
+ * 
+ * The mailbox holds a single target, so a burst of requests cannot overflow it.
+ */
+TEST_F(WoleixClimateTest, JustInTimePlanningNeverHolds)
+{
+    mock_climate->use_just_in_time_planning();
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 15.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    for (int i = 0; i < 10; i++)
+    {
+        mock_climate->target_temperature = (i % 2 == 0) ? 30.0f : 15.0f;
+        mock_climate->transmit_state();
+        EXPECT_FALSE(mock_climate->get_on_hold());
+    }
+}
+
 // ============================================================================
 // Test: Temperature Bounds
 // ============================================================================
@@ -785,6 +988,89 @@ TEST_F(WoleixClimateTest, HumiditySensorCallbackReceivesUpdates)
     EXPECT_EQ(humidity_sensor.state, 70.0f);
 }
 
+/**
+ * Test: Every reading is published when no publishing policy is configured
+ */
+TEST_F(WoleixClimateTest, ReadingsArePublishedByDefault)
+{
+    esphome::sensor::Sensor temperature_sensor;
+    esphome::sensor::Sensor humidity_sensor;
+    mock_climate->set_sensor(&temperature_sensor);
+    mock_climate->set_humidity_sensor(&humidity_sensor);
+    mock_climate->setup();
+
+    // ClimateIR no longer publishes temperature readings itself
+    EXPECT_CALL(*mock_climate, publish_state()).Times(3);
+    temperature_sensor.publish_state(21.0f);
+    temperature_sensor.publish_state(21.0f);
+    humidity_sensor.publish_state(50.0f);
+
+    EXPECT_FLOAT_EQ(mock_climate->current_temperature, 21.0f);
+    EXPECT_FLOAT_EQ(mock_climate->current_humidity, 50.0f);
+}
+
+/**
+ * Test: NaN readings are dropped before reaching the reading throttle
+ */
+TEST_F(WoleixClimateTest, NanReadingsAreIgnored)
+{
+    esphome::sensor::Sensor temperature_sensor;
+    esphome::sensor::Sensor humidity_sensor;
+    mock_climate->set_sensor(&temperature_sensor);
+    mock_climate->set_humidity_sensor(&humidity_sensor);
+    mock_climate->setup();
+
+    EXPECT_CALL(*mock_climate, publish_state()).Times(2);
+    temperature_sensor.publish_state(21.0f);
+    humidity_sensor.publish_state(50.0f);
+    testing::Mock::VerifyAndClearExpectations(mock_climate);
+
+    EXPECT_CALL(*mock_climate, publish_state()).Times(0);
+    temperature_sensor.publish_state(NAN);
+    humidity_sensor.publish_state(NAN);
+    EXPECT_FLOAT_EQ(mock_climate->current_temperature, 21.0f);
+    EXPECT_FLOAT_EQ(mock_climate->current_humidity, 50.0f);
+}
+
+/**
+ * Test: Readings within the minimum interval are coalesced into one publication
+ */
+TEST_F(WoleixClimateTest, ReadingsAreThrottledAndCoalesced)
+{
+    esphome::sensor::Sensor temperature_sensor;
+    esphome::sensor::Sensor humidity_sensor;
+    mock_climate->set_sensor(&temperature_sensor);
+    mock_climate->set_humidity_sensor(&humidity_sensor);
+    mock_climate->set_reading_publishing(10000, 0);
+    mock_climate->set_reading_delta(WoleixReading::CURRENT_TEMPERATURE, 0.2f);
+    mock_climate->set_reading_delta(WoleixReading::CURRENT_HUMIDITY, 1.0f);
+    mock_climate->setup();
+
+    EXPECT_CALL(*mock_climate, publish_state()).Times(1);
+    temperature_sensor.publish_state(21.0f);
+    testing::Mock::VerifyAndClearExpectations(mock_climate);
+
+    // Below the delta: skipped, but the value is kept
+    EXPECT_CALL(*mock_climate, publish_state()).Times(0);
+    mock_scheduler->advance_time(1000);
+    temperature_sensor.publish_state(21.1f);
+    EXPECT_FALSE(mock_scheduler->has_timeout(WoleixTimerId::READINGS));
+    EXPECT_FLOAT_EQ(mock_climate->current_temperature, 21.1f);
+
+    // Significant changes wait for the end of the interval
+    mock_scheduler->advance_time(1000);
+    humidity_sensor.publish_state(50.0f);
+    mock_scheduler->advance_time(1000);
+    temperature_sensor.publish_state(21.5f);
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::READINGS), 7000u);
+    EXPECT_FLOAT_EQ(mock_climate->current_humidity, 50.0f);
+    testing::Mock::VerifyAndClearExpectations(mock_climate);
+
+    EXPECT_CALL(*mock_climate, publish_state()).Times(1);
+    mock_scheduler->advance_time(7000);
+    EXPECT_FALSE(mock_scheduler->has_timeout(WoleixTimerId::READINGS));
+}
+
 /**
  * Test: Setup() handles null humidity sensor gracefully
  * 
@@ -1098,11 +1384,47 @@ TEST_F(WoleixClimateTest, TransmitStateOnHoldFalse)
     mock_climate->transmit_state();
 }
 
+/**
+ * Test: What the queue watermarks still guard
+ *
+ * Re-planning drops pending normal-priority commands, so plans alone never
+ * reach the high watermark. High-priority commands survive re-planning,
+ * though: a backlog of them puts new normal-priority plans on hold until the
+ * queue drains to its low watermark.
+ */
+TEST_F(WoleixClimateTest, HighPriorityBacklogHoldsNormalPlans)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 22.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+    const size_t backlog = static_cast<size_t>(QUEUE_MAX_CAPACITY * QUEUE_HIGH_WATERMARK) + 1;
+    mock_climate->enqueue_commands(fill_commands(backlog, WoleixCommand::Priority::HIGH));
+    ASSERT_TRUE(mock_climate->get_on_hold());
+
+    EXPECT_CALL(*mock_climate, report_status(_)).Times(1);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 24.0f;
+    mock_climate->transmit_state();
+    EXPECT_EQ(mock_climate->queued_commands(), backlog);
+    testing::Mock::VerifyAndClearExpectations(mock_climate);
+
+    while (mock_climate->get_on_hold())
+    {
+        mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    }
+    EXPECT_LE(mock_climate->queued_commands(), QUEUE_MAX_CAPACITY * QUEUE_LOW_WATERMARK);
+
+    size_t drained = mock_climate->queued_commands();
+    mock_climate->target_temperature = 24.0f;
+    mock_climate->transmit_state();
+    EXPECT_GT(mock_climate->queued_commands(), drained);
+}
+
 TEST_F(WoleixClimateTest, EnqueueCommandsFailure)
 {
     mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 22.0f, ClimateFanMode::CLIMATE_FAN_LOW);
 
-    mock_climate->enqueue_commands(fill_commands(QUEUE_MAX_CAPACITY - 2));
+    // High-priority commands survive re-planning, so the queue stays nearly full
+    mock_climate->enqueue_commands(fill_commands(QUEUE_MAX_CAPACITY - 2, WoleixCommand::Priority::HIGH));
     mock_climate->set_on_hold(false);
 
     EXPECT_CALL(*mock_climate, report_status(testing::_))
@@ -1164,7 +1486,7 @@ TEST_F(WoleixClimateTest, UpdateStateRollbackTest)
 TEST_F(WoleixClimateTest, ObserveMethodTest)
 {
     // Create a mock WoleixStatus object
-    WoleixStatus mock_status(WoleixStatus::Severity::WX_SEVERITY_INFO, Category::make(99, 99, "Testing.Testing"), "Test message");
+    WoleixStatus mock_status(TestMessages::WX_MESSAGE_INFO);
 
     // Create a mock WoleixStatusReporter
     MockWoleixStatusReporter mock_reporter;
@@ -1188,7 +1510,7 @@ TEST_F(WoleixClimateTest, ObserveMethodTest)
 TEST_F(WoleixClimateTest, ReportStatusMethodTest)
 {
     // Create a WoleixStatus object
-    WoleixStatus mock_status(WoleixStatus::Severity::WX_SEVERITY_WARNING, Category::make(99, 99, "Testing.Testing"), "Test warning message");
+    WoleixStatus mock_status(TestMessages::WX_MESSAGE_WARNING);
 
     EXPECT_CALL(*mock_climate, report_status(testing::_))
         .Times(1)
@@ -1202,11 +1524,725 @@ TEST_F(WoleixClimateTest, ReportStatusMethodTest)
 }
 
 // ============================================================================
-// Main
+// Test: Speculative Setting Mode
 // ============================================================================
 
-int main(int argc, char **argv) 
+TEST_F(WoleixClimateTest, SpeculativeSettingModeDisabledByDefault)
 {
-    testing::InitGoogleTest(&argc, argv);
-    return RUN_ALL_TESTS();
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+
+    EXPECT_CALL(*mock_climate, transmit_(_)).Times(0);
+
+    EXPECT_FALSE(mock_climate->prepare_temperature_change());
+    EXPECT_FALSE(mock_climate->in_setting_mode());
+}
+
+/**
+ * Test: After prepare_temperature_change() the change needs no entry press
+ * 
+ * 25 -> 27 normally takes three TEMP_UP presses; once setting mode has been
+ * opened ahead of time, only the two that change the temperature are left.
+ */
+TEST_F(WoleixClimateTest, PreparedTemperatureChangeSkipsEntryPress)
+{
+    mock_climate->set_speculative_setting_mode(true);
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_UP)))
+        .Times(1);
+    EXPECT_TRUE(mock_climate->prepare_temperature_change());
+    EXPECT_TRUE(mock_climate->in_setting_mode());
+    testing::Mock::VerifyAndClearExpectations(mock_climate);
+
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_UP)))
+        .Times(2);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->target_temperature = 27.0f;
+    mock_climate->transmit_state();
+    mock_climate->run_until_empty();
+
+    EXPECT_FLOAT_EQ(mock_climate->get_internal_state().temperature, 27.0f);
+}
+
+TEST_F(WoleixClimateTest, TemperatureOnlyControlEntersSettingModeImmediately)
+{
+    mock_climate->set_speculative_setting_mode(true);
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_UP)))
+        .Times(3);
+
+    auto call = mock_climate->make_call();
+    call.set_target_temperature(27.0f);
+    mock_climate->control(call);
+
+    // Entry press is out before any command timer fired
+    EXPECT_TRUE(mock_climate->in_setting_mode());
+    mock_climate->run_until_empty();
+}
+
+TEST_F(WoleixClimateTest, NoSpeculationOutsideCoolMode)
+{
+    mock_climate->set_speculative_setting_mode(true);
+
+    EXPECT_CALL(*mock_climate, transmit_(_)).Times(0);
+
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_DRY, 25.0f);
+    EXPECT_FALSE(mock_climate->prepare_temperature_change());
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_OFF, 25.0f);
+    EXPECT_FALSE(mock_climate->prepare_temperature_change());
+}
+
+TEST_F(WoleixClimateTest, NoSpeculationForModeChange)
+{
+    mock_climate->set_speculative_setting_mode(true);
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+
+    auto call = mock_climate->make_call();
+    call.set_mode(ClimateMode::CLIMATE_MODE_FAN_ONLY);
+    mock_climate->control(call);
+
+    EXPECT_FALSE(mock_climate->in_setting_mode());
+}
+
+// ============================================================================
+// Test: Priority Lanes
+// ============================================================================
+
+/**
+ * Test: Turning off pre-empts a long temperature change
+ *
+ * The pending TEMP_UP presses are dropped and the POWER press goes out next.
+ * The tracked state is re-planned from what was transmitted so far, so it
+ * reflects the one press that already went out.
+ */
+TEST_F(WoleixClimateTest, PowerOffPreemptsPendingTemperatureChange)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 18.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 30.0f;
+    mock_climate->transmit_state();
+    ASSERT_EQ(mock_climate->queued_commands(), 12u);
+
+    // Setting mode entry, then the first TEMP_UP
+    mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    ASSERT_FLOAT_EQ(mock_climate->get_transmitted_state().temperature, 19.0f);
+
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_OFF;
+    mock_climate->transmit_state();
+
+    ASSERT_EQ(mock_climate->queued_commands(), 1u);
+    EXPECT_EQ(mock_climate->command_source_()->get()->get_type(), WoleixCommand::Type::POWER);
+    EXPECT_EQ(mock_climate->get_internal_state().power, WoleixPowerState::OFF);
+    EXPECT_FLOAT_EQ(mock_climate->get_internal_state().temperature, 19.0f);
+
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_UP))).Times(0);
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::POWER))).Times(1);
+    mock_climate->run_until_empty();
+
+    EXPECT_TRUE(mock_climate->get_transmitted_state() == mock_climate->get_internal_state());
+}
+
+/**
+ * Test: Turning off is not held back by a nearly full queue
+ */
+TEST_F(WoleixClimateTest, PowerOffBypassesHold)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->set_on_hold(true);
+
+    EXPECT_CALL(*mock_climate, report_status(_)).Times(0);
+
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_OFF;
+    mock_climate->transmit_state();
+
+    EXPECT_EQ(mock_climate->get_internal_state().power, WoleixPowerState::OFF);
+    EXPECT_EQ(mock_climate->queued_commands(), 1u);
+}
+
+// ============================================================================
+// Test: Re-planning from the Transmitted State
+// ============================================================================
+
+/**
+ * Test: A new target mid-sequence replaces the rest of the pending plan
+ *
+ * Switching to FAN mode while a temperature change is under way only needs
+ * the MODE presses; the remaining TEMP_UP presses are never sent.
+ */
+TEST_F(WoleixClimateTest, RetargetMidSequenceReplansFromTransmittedState)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 20.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 28.0f;
+    mock_climate->transmit_state();
+
+    // Setting mode entry, then two TEMP_UP presses
+    for (int i = 0; i < 3; i++) mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    ASSERT_FLOAT_EQ(mock_climate->get_transmitted_state().temperature, 22.0f);
+
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_FAN_ONLY;
+    mock_climate->transmit_state();
+
+    EXPECT_EQ(mock_climate->queued_commands(), 2u);
+    EXPECT_EQ(mock_climate->get_desired_state().mode, WoleixMode::FAN);
+    EXPECT_EQ(mock_climate->get_planned_state().mode, WoleixMode::FAN);
+    EXPECT_FLOAT_EQ(mock_climate->get_planned_state().temperature, 22.0f);
+
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_UP))).Times(0);
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::MODE))).Times(2);
+    mock_climate->run_until_empty();
+
+    EXPECT_TRUE(mock_climate->get_transmitted_state() == mock_climate->get_planned_state());
+}
+
+/**
+ * Test: The setting mode window is seen from the end of the queue
+ *
+ * Queued temperature presses keep the window open; once they are sent, it
+ * runs down with the gap after the last one.
+ */
+TEST_F(WoleixClimateTest, SettingModeWindowAccountsForQueuedPresses)
+{
+    EXPECT_EQ(mock_climate->setting_mode_window().closes_at_ms, 0u);
+
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 20.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 22.0f;
+    mock_climate->transmit_state();
+
+    // Setting mode entry, two TEMP_UP presses still queued
+    mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    ASSERT_EQ(mock_climate->queued_commands(), 2u);
+    EXPECT_EQ(mock_climate->setting_mode_window().closes_at_ms,
+        TEMP_SETTING_MODE_TIMEOUT_MS - WoleixPathPlanner::press_cost_ms(WoleixCommand::Type::TEMP_UP));
+
+    mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    ASSERT_EQ(mock_climate->queued_commands(), 0u);
+    EXPECT_EQ(mock_climate->setting_mode_window().closes_at_ms,
+        mock_climate->setting_mode_remaining_ms() - mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND));
+}
+
+// ============================================================================
+// Test: Remote Receiver
+// ============================================================================
+
+TEST_F(WoleixClimateTest, RemotePressIsTrackedAndPublished)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+
+    EXPECT_CALL(*mock_climate, publish_state()).Times(1);
+    EXPECT_TRUE(mock_climate->receive(MODE_NEC));
+
+    EXPECT_EQ(mock_climate->get_transmitted_state().mode, WoleixMode::DEHUM);
+    EXPECT_TRUE(mock_climate->get_desired_state() == mock_climate->get_transmitted_state());
+    EXPECT_EQ(mock_climate->mode, ClimateMode::CLIMATE_MODE_DRY);
+}
+
+/**
+ * Test: The first temperature press on the remote only opens setting mode
+ */
+TEST_F(WoleixClimateTest, RemoteTemperaturePressesFollowSettingModeQuirk)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+
+    EXPECT_TRUE(mock_climate->receive(TEMP_UP_NEC));
+    EXPECT_FLOAT_EQ(mock_climate->get_transmitted_state().temperature, 25.0f);
+    EXPECT_TRUE(mock_climate->in_setting_mode());
+
+    EXPECT_TRUE(mock_climate->receive(TEMP_UP_NEC));
+    EXPECT_FLOAT_EQ(mock_climate->get_transmitted_state().temperature, 26.0f);
+    EXPECT_FLOAT_EQ(mock_climate->target_temperature, 26.0f);
+
+    // Our next temperature press goes out without an entry press
+    EXPECT_CALL(*mock_climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_UP))).Times(1);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->target_temperature = 27.0f;
+    mock_climate->transmit_state();
+    mock_climate->run_until_empty();
+}
+
+TEST_F(WoleixClimateTest, RemoteTemperaturePressOutsideCoolDoesNothing)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_FAN_ONLY, 25.0f);
+
+    EXPECT_CALL(*mock_climate, publish_state()).Times(0);
+    EXPECT_TRUE(mock_climate->receive(TEMP_DOWN_NEC));
+
+    EXPECT_FALSE(mock_climate->in_setting_mode());
+    EXPECT_FLOAT_EQ(mock_climate->get_transmitted_state().temperature, 25.0f);
+}
+
+TEST_F(WoleixClimateTest, ForeignFramesAreIgnored)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    const WoleixInternalState before = mock_climate->get_transmitted_state();
+
+    EXPECT_FALSE(mock_climate->receive(POWER_NEC, 0x1234));
+    EXPECT_FALSE(mock_climate->receive(TIMER_NEC));
+
+    RawTimings noise = { 9000, -2250, 560 };
+    EXPECT_FALSE(mock_climate->on_receive(RemoteReceiveData(noise)));
+
+    EXPECT_TRUE(mock_climate->get_transmitted_state() == before);
+}
+
+/**
+ * Test: Our own frames, picked up by the receiver, are not taken for remote presses
+ */
+TEST_F(WoleixClimateTest, EchoesOfOwnFramesAreFiltered)
+{
+    mock_climate->send_frames();
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 26.0f;
+    mock_climate->transmit_state();
+    mock_climate->run_until_empty();
+    ASSERT_FLOAT_EQ(mock_climate->get_transmitted_state().temperature, 26.0f);
+
+    // Entry press and temperature press
+    EXPECT_TRUE(mock_climate->receive(TEMP_UP_NEC));
+    EXPECT_TRUE(mock_climate->receive(TEMP_UP_NEC));
+    EXPECT_FLOAT_EQ(mock_climate->get_transmitted_state().temperature, 26.0f);
+
+    // Then the remote
+    EXPECT_TRUE(mock_climate->receive(TEMP_UP_NEC));
+    EXPECT_FLOAT_EQ(mock_climate->get_transmitted_state().temperature, 27.0f);
+}
+
+/**
+ * Test: A remote press drops the pending plan and becomes the new target
+ */
+TEST_F(WoleixClimateTest, RemotePressOverridesPendingPlan)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 20.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 28.0f;
+    mock_climate->transmit_state();
+
+    // Setting mode entry, then two TEMP_UP presses
+    for (int i = 0; i < 3; i++) mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    ASSERT_GT(mock_climate->queued_commands(), 0u);
+
+    EXPECT_TRUE(mock_climate->receive(MODE_NEC));
+
+    WoleixInternalState expected(WoleixPowerState::ON, WoleixMode::DEHUM, 22.0f, WoleixFanSpeed::LOW);
+    EXPECT_EQ(mock_climate->queued_commands(), 0u);
+    EXPECT_TRUE(mock_climate->get_transmitted_state() == expected);
+    EXPECT_TRUE(mock_climate->get_planned_state() == expected);
+    EXPECT_EQ(mock_climate->mode, ClimateMode::CLIMATE_MODE_DRY);
+    EXPECT_FLOAT_EQ(mock_climate->target_temperature, 22.0f);
+}
+
+TEST_F(WoleixClimateTest, RemotePressOverridesJustInTimeTarget)
+{
+    mock_climate->use_just_in_time_planning();
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 20.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 28.0f;
+    mock_climate->transmit_state();
+    for (int i = 0; i < 3; i++) mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+
+    EXPECT_TRUE(mock_climate->receive(POWER_NEC));
+
+    EXPECT_TRUE(mock_climate->command_source_()->is_empty());
+    EXPECT_EQ(mock_climate->get_planned_state().power, WoleixPowerState::OFF);
+    EXPECT_EQ(mock_climate->mode, ClimateMode::CLIMATE_MODE_OFF);
+}
+
+/**
+ * Test: Pending high-priority commands survive re-planning
+ */
+TEST_F(WoleixClimateTest, RetargetKeepsPendingHighPriorityCommands)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_OFF;
+    mock_climate->transmit_state();
+
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->target_temperature = 27.0f;
+    mock_climate->transmit_state();
+    mock_climate->target_temperature = 28.0f;
+    mock_climate->transmit_state();
+
+    // POWER off (high priority), then POWER on and three TEMP_UP
+    ASSERT_EQ(mock_climate->queued_commands(), 5u);
+    EXPECT_EQ(mock_climate->command_source_()->get()->get_priority(), WoleixCommand::Priority::HIGH);
+    EXPECT_EQ(mock_climate->get_planned_state().power, WoleixPowerState::ON);
+    EXPECT_FLOAT_EQ(mock_climate->get_planned_state().temperature, 28.0f);
+
+    mock_climate->run_until_empty();
+
+    EXPECT_TRUE(mock_climate->get_transmitted_state() == mock_climate->get_planned_state());
+}
+
+// ============================================================================
+// Debounce Tests
+// ============================================================================
+
+/**
+ * Test: Only the final target of a burst of changes is planned
+ */
+TEST_F(WoleixClimateTest, DebouncedBurstPlansOnlyFinalTarget)
+{
+    mock_climate->set_debounce(300, 1000);
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+
+    for (float temperature : { 26.0f, 27.0f, 28.0f })
+    {
+        mock_climate->target_temperature = temperature;
+        mock_climate->transmit_state();
+        mock_scheduler->advance_time(100);
+    }
+
+    // Nothing planned yet, and the requested target is left alone
+    EXPECT_EQ(mock_climate->queued_commands(), 0u);
+    EXPECT_FLOAT_EQ(mock_climate->target_temperature, 28.0f);
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::DEBOUNCE), 200u);
+
+    EXPECT_CALL(*mock_climate, publish_state()).Times(1);
+    mock_scheduler->fire_timeout(WoleixTimerId::DEBOUNCE);
+
+    EXPECT_EQ(mock_climate->queued_commands(), 3u);
+    EXPECT_FLOAT_EQ(mock_climate->get_planned_state().temperature, 28.0f);
+}
+
+/**
+ * Test: A continuous burst is planned once the maximum latency is reached
+ */
+TEST_F(WoleixClimateTest, DebounceIsCappedByMaxLatency)
+{
+    mock_climate->set_debounce(300, 500);
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+
+    mock_climate->target_temperature = 26.0f;
+    mock_climate->transmit_state();
+    mock_scheduler->advance_time(200);
+    mock_climate->target_temperature = 27.0f;
+    mock_climate->transmit_state();
+    mock_scheduler->advance_time(200);
+    mock_climate->target_temperature = 28.0f;
+    mock_climate->transmit_state();
+
+    // Only 100 ms left until the cap
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::DEBOUNCE), 100u);
+
+    mock_scheduler->advance_time(100);
+    EXPECT_FLOAT_EQ(mock_climate->get_planned_state().temperature, 28.0f);
+    EXPECT_FALSE(mock_scheduler->has_timeout(WoleixTimerId::DEBOUNCE));
+}
+
+/**
+ * Test: Turning off is planned right away, dropping the pending burst
+ */
+TEST_F(WoleixClimateTest, PowerOffIsNotDebounced)
+{
+    mock_climate->set_debounce(300, 1000);
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+
+    mock_climate->target_temperature = 28.0f;
+    mock_climate->transmit_state();
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_OFF;
+    mock_climate->transmit_state();
+
+    EXPECT_EQ(mock_climate->queued_commands(), 1u);
+    EXPECT_EQ(mock_climate->get_planned_state().power, WoleixPowerState::OFF);
+    EXPECT_FALSE(mock_scheduler->has_timeout(WoleixTimerId::DEBOUNCE));
+}
+
+// ============================================================================
+// Metrics Tests
+// ============================================================================
+
+TEST_F(WoleixClimateTest, PublishesMetricsSensors)
+{
+    esphome::sensor::Sensor depth, peak, rate, rejected;
+    mock_climate->set_metrics_sensor(WoleixMetric::QUEUE_DEPTH, &depth);
+    mock_climate->set_metrics_sensor(WoleixMetric::PEAK_QUEUE_DEPTH, &peak);
+    mock_climate->set_metrics_sensor(WoleixMetric::COMMANDS_PER_MINUTE, &rate);
+    mock_climate->set_metrics_sensor(WoleixMetric::REJECTED_PLANS, &rejected);
+    mock_climate->set_metrics_update_interval(30000);
+
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 28.0f;
+    mock_climate->transmit_state();
+
+    mock_climate->publish_metrics_();
+
+    EXPECT_FLOAT_EQ(depth.state, 3.0f);
+    EXPECT_FLOAT_EQ(peak.state, 3.0f);
+    EXPECT_FLOAT_EQ(rate.state, 0.0f);
+    EXPECT_FLOAT_EQ(rejected.state, 0.0f);
+}
+
+TEST_F(WoleixClimateTest, RejectedPlanIsCountedAndRolledBack)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 22.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+    mock_climate->enqueue_commands(fill_commands(QUEUE_MAX_CAPACITY - 2, WoleixCommand::Priority::HIGH));
+    mock_climate->set_on_hold(false);
+    EXPECT_CALL(*mock_climate, report_status(testing::_)).Times(AtLeast(1));
+
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->target_temperature = 25.0f;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->transmit_state();
+
+    EXPECT_EQ(mock_climate->get_metrics().snapshot().rejected_plans, 1u);
+    EXPECT_FLOAT_EQ(mock_climate->get_planned_state().temperature, 22.0f);
+}
+
+/**
+ * Test: A replacing plan may use the room of the pending plan
+ */
+TEST_F(WoleixClimateTest, ReplacingPlanReusesRoomOfPendingPlan)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 20.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 28.0f;
+    mock_climate->transmit_state();
+    const size_t pending = mock_climate->queued_commands();
+    ASSERT_GT(pending, 0u);
+
+    mock_climate->enqueue_commands(fill_commands(QUEUE_MAX_CAPACITY - 2 - pending, WoleixCommand::Priority::HIGH));
+    mock_climate->set_on_hold(false);
+
+    // Ten presses from the transmitted 20 fit into the free slots and the room of the pending presses
+    mock_climate->target_temperature = 30.0f;
+    mock_climate->transmit_state();
+
+    EXPECT_EQ(mock_climate->get_metrics().snapshot().rejected_plans, 0u);
+    EXPECT_FLOAT_EQ(mock_climate->get_planned_state().temperature, 30.0f);
+}
+
+/**
+ * Test: A plan too large even for the room of the pending plan is rejected,
+ * and the pending presses it dropped to make room stay dropped
+ */
+TEST_F(WoleixClimateTest, OversizedReplacingPlanDropsPendingPlan)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 20.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 28.0f;
+    mock_climate->transmit_state();
+    const size_t pending = mock_climate->queued_commands();
+    ASSERT_LT(pending + 1, 10u);
+
+    const size_t backlog = QUEUE_MAX_CAPACITY - 1 - pending;
+    mock_climate->enqueue_commands(fill_commands(backlog, WoleixCommand::Priority::HIGH));
+    mock_climate->set_on_hold(false);
+
+    // Ten presses from the transmitted 20 do not fit
+    mock_climate->target_temperature = 30.0f;
+    mock_climate->transmit_state();
+
+    EXPECT_EQ(mock_climate->get_metrics().snapshot().rejected_plans, 1u);
+    EXPECT_EQ(mock_climate->queued_commands(), backlog);
+    EXPECT_FLOAT_EQ(mock_climate->get_planned_state().temperature, 20.0f);
+}
+
+/**
+ * Test: A replacing plan sees the setting mode window without the presses it replaces
+ */
+TEST_F(WoleixClimateTest, ReplacingPlanSeesWindowWithoutReplacedPresses)
+{
+    mock_climate->set_shortest_path_planning(true);
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 20.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 25.0f;
+    mock_climate->transmit_state();
+
+    // Setting mode entry and one TEMP_UP sent, the rest still queued
+    mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    ASSERT_GT(mock_climate->queued_commands(), 1u);
+    const uint32_t expected =
+        mock_climate->setting_mode_remaining_ms() - mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND);
+
+    mock_climate->target_temperature = 22.0f;
+    mock_climate->transmit_state();
+
+    EXPECT_EQ(mock_climate->planned_window.closes_at_ms, expected);
+    EXPECT_EQ(mock_climate->get_transmitted_state().temperature, 21.0f);
+    EXPECT_EQ(mock_climate->queued_commands(), 1u);
+    EXPECT_FLOAT_EQ(mock_climate->get_planned_state().temperature, 22.0f);
+}
+
+/**
+ * Test: Plan latency runs from enqueueing to the last frame of the plan
+ */
+TEST_F(WoleixClimateTest, RecordsPlanLatencyUntilLastFrame)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 27.0f;
+    mock_scheduler->advance_time(1000);
+    mock_climate->transmit_state();
+
+    // Entry press, then two TEMP_UP presses one gap apart
+    mock_scheduler->advance_time(2000);
+
+    WoleixMetricsSnapshot snapshot = mock_climate->get_metrics().snapshot();
+    EXPECT_EQ(mock_climate->get_metrics().plan_latency().count(), 1u);
+    EXPECT_EQ(snapshot.plan_latency_max_ms, TEMP_ENTER_DELAY_MS + command_gap_ms(TEMP_UP_NEC));
+    EXPECT_EQ(snapshot.plan_latency_p50_ms, snapshot.plan_latency_max_ms);
+}
+
+/**
+ * Test: Plan latency includes the debounce delay of the burst
+ */
+TEST_F(WoleixClimateTest, PlanLatencyIncludesDebounce)
+{
+    mock_climate->set_debounce(300, 1000);
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 26.0f;
+    mock_climate->transmit_state();
+    mock_scheduler->advance_time(100);
+    mock_climate->target_temperature = 27.0f;
+    mock_climate->transmit_state();
+
+    mock_scheduler->advance_time(5000);
+
+    EXPECT_EQ(mock_climate->get_metrics().plan_latency().count(), 1u);
+    EXPECT_EQ(mock_climate->get_metrics().plan_latency().max(), 100 + 300 + TEMP_ENTER_DELAY_MS + command_gap_ms(TEMP_UP_NEC));
+}
+
+/**
+ * Test: A plan replaced before completion is not recorded
+ */
+TEST_F(WoleixClimateTest, ReplacedPlanRestartsLatencyClock)
+{
+    mock_climate->set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f);
+    mock_climate->mode = ClimateMode::CLIMATE_MODE_COOL;
+    mock_climate->fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+    mock_climate->target_temperature = 30.0f;
+    mock_climate->transmit_state();
+    mock_scheduler->advance_time(TEMP_ENTER_DELAY_MS);
+
+    mock_climate->target_temperature = 27.0f;
+    mock_climate->transmit_state();
+    mock_scheduler->advance_time(5000);
+
+    EXPECT_EQ(mock_climate->get_metrics().plan_latency().count(), 1u);
+    EXPECT_LT(mock_climate->get_metrics().plan_latency().max(), TEMP_ENTER_DELAY_MS + 5 * command_gap_ms(TEMP_UP_NEC));
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv) 
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
+
+// ============================================================================
+// Test: Dedicated executor
+// ============================================================================
+
+/**
+ * Test: With the dedicated executor, commands go out without the main loop
+ *
+ * The protocol timers move to the executor thread; the main loop scheduler
+ * never sees them, yet the planned commands are transmitted.
+ */
+TEST_F(WoleixClimateTest, DedicatedExecutorTransmitsOffTheMainLoop)
+{
+    MockScheduler main_loop;
+    testing::NiceMock<MockWoleixClimate> climate;
+    climate.set_scheduler(&main_loop);
+    climate.set_transmitter(mock_transmitter);
+    climate.set_dedicated_executor(true);
+    climate.setup();
+    climate.set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+    climate.mode = ClimateMode::CLIMATE_MODE_COOL;
+    climate.target_temperature = 25.0f;
+    climate.fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+
+    std::atomic<int> transmitted{0};
+    EXPECT_CALL(climate, transmit_(IsCommandOfType(WoleixCommand::Type::TEMP_UP)))
+        .WillRepeatedly(Invoke([&transmitted](const WoleixCommand&) { transmitted++; }));
+
+    // Setting mode entry plus one press
+    auto call = climate.make_call();
+    call.set_target_temperature(26.0f);
+    climate.control(call);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (transmitted < 2 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(transmitted, 2);
+    EXPECT_FALSE(main_loop.has_timeout(WoleixTimerId::NEXT_COMMAND));
+
+    // Setting mode is still open; stop its timer before tearing down
+    climate.on_shutdown();
+}
+
+/**
+ * Test: Statuses raised on the executor's task reach the component from the main loop
+ *
+ * Without a transmitter, the protocol handler reports an error from the
+ * executor thread; the component's error state is only set by loop().
+ */
+TEST_F(WoleixClimateTest, DedicatedExecutorLeavesStatusToMainLoop)
+{
+    MockScheduler main_loop;
+    testing::NiceMock<MockWoleixClimate> climate;
+    climate.set_scheduler(&main_loop);
+    climate.set_dedicated_executor(true);
+    climate.send_frames();
+    climate.setup();
+    climate.set_climate_state(ClimateMode::CLIMATE_MODE_COOL, 25.0f, ClimateFanMode::CLIMATE_FAN_LOW);
+    climate.mode = ClimateMode::CLIMATE_MODE_COOL;
+    climate.target_temperature = 25.0f;
+    climate.fan_mode = ClimateFanMode::CLIMATE_FAN_LOW;
+
+    std::atomic<bool> reported{false};
+    climate.report_statuses([&reported]() { reported = true; });
+
+    auto call = climate.make_call();
+    call.set_target_temperature(26.0f);
+    climate.control(call);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!reported && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ASSERT_TRUE(reported);
+    EXPECT_FALSE(climate.status_has_error());
+
+    climate.loop();
+    EXPECT_TRUE(climate.status_has_error());
+
+    climate.on_shutdown();
 }
@@ -4,28 +4,30 @@
 
 using esphome::climate_ir_woleix::WoleixCommand;
 using esphome::climate_ir_woleix::WoleixCommandQueue;
+using esphome::climate_ir_woleix::WoleixStaticCommandQueue;
 
-class MockWoleixCommandQueue: public WoleixCommandQueue
+class MockWoleixCommandQueue: public WoleixStaticCommandQueue<16>
 {
 public:
-    MockWoleixCommandQueue() : WoleixCommandQueue(16) {}
+    MockWoleixCommandQueue() : WoleixStaticCommandQueue<16>() {}
     
     // Bring the base class get() method into scope
     using WoleixCommandQueue::get;
     // Helper to count specific commands in the queue and sum their repeat counts
     int count_command(WoleixCommand::Type type)
     {
-        return std::accumulate(queue_->begin(), queue_->end(), 0,
-            [this, type](int sum, const WoleixCommand& cmd)
-            {
-                return sum + (cmd.get_type() == type ? cmd.get_repeat_count() : 0);
-            }
-        );
+        int sum = 0;
+        for (size_t i = 0; i < queue_.size(); i++)
+        {
+            WoleixCommand command = at(i);
+            sum += (command.get_type() == type ? command.get_repeat_count() : 0);
+        }
+        return sum;
     }
 
     std::optional<WoleixCommand> get(int index) const 
     {
-        if (index >= queue_->size()) return {};
-        return queue_->at(index);
+        if (index >= queue_.size()) return {};
+        return at(index);
     }
 };
@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <map>
+#include <optional>
 #include <set>
 #include <string>
 #include <cstdint>
@@ -9,9 +10,13 @@
 #include <stdexcept>
 
 #include "woleix_protocol_handler.h"
+#include "woleix_timer.h"
 
 using esphome::climate_ir_woleix::WoleixCommandQueue;
 using esphome::climate_ir_woleix::WoleixProtocolHandler;
+using esphome::climate_ir_woleix::WoleixTimerId;
+using esphome::climate_ir_woleix::WoleixTimerCallback;
+using esphome::climate_ir_woleix::WoleixTimerScheduler;
 
 /**
  * @brief A deterministic time-based mock scheduler for testing async behavior.
@@ -25,23 +30,23 @@ using esphome::climate_ir_woleix::WoleixProtocolHandler;
  * - Timeouts are stored with absolute fire times, not relative delays
  * - advance_time() fires ONE timeout at a time in chronological order
  * - Callbacks that schedule new timeouts don't affect the current advance
- * - Named timeouts can be inspected, cancelled, and manually fired
+ * - Timeouts (keyed by WoleixTimerId) can be inspected, cancelled, and manually fired
  */
-class MockScheduler
+class MockScheduler : public WoleixTimerScheduler
 {
 public:
     struct ScheduledTimeout
     {
-        std::string name;
+        WoleixTimerId id;
         uint64_t fire_at_ms;  // Absolute time when this should fire
         std::function<void()> callback;
         
         bool operator<(const ScheduledTimeout& other) const
         {
-            // Sort by fire time, then by name for determinism
+            // Sort by fire time, then by ID for determinism
             if (fire_at_ms != other.fire_at_ms)
                 return fire_at_ms < other.fire_at_ms;
-            return name < other.name;
+            return id < other.id;
         }
     };
 
@@ -51,25 +56,38 @@ public:
     // Interface for WoleixProtocolHandler
     // ========================================================================
     
-    WoleixProtocolHandler::TimeoutSetter get_setter()
+    void schedule_timer(WoleixTimerId id, uint32_t delay_ms, WoleixTimerCallback callback) override
     {
-        return [this](const std::string& name, uint32_t delay_ms, std::function<void()> callback)
-        {
-            // Cancel any existing timeout with same name first
-            cancel_timeout_internal(name);
-            
-            uint64_t fire_at = current_time_ms_ + delay_ms;
-            timeouts_.insert({name, fire_at, std::move(callback)});
-        };
+        schedule(id, delay_ms, [callback]() { callback(); });
     }
-    
-    WoleixProtocolHandler::TimeoutCanceller get_canceller()
+
+    void cancel_timer(WoleixTimerId id) override
     {
-        return [this](const std::string& name)
-        {
-            cancel_timeout_internal(name);
-            cancelled_names_.insert(name);
-        };
+        cancel(id);
+    }
+
+    uint32_t now_ms() const override
+    {
+        return static_cast<uint32_t>(current_time_ms_);
+    }
+
+    // ========================================================================
+    // Interface for ESPHome Component timeouts (numeric IDs)
+    // ========================================================================
+
+    void schedule(WoleixTimerId id, uint32_t delay_ms, std::function<void()> callback)
+    {
+        // Cancel any existing timeout with same ID first
+        cancel_timeout_internal(id);
+
+        uint64_t fire_at = current_time_ms_ + delay_ms;
+        timeouts_.insert({id, fire_at, std::move(callback)});
+    }
+
+    void cancel(WoleixTimerId id)
+    {
+        cancel_timeout_internal(id);
+        cancelled_ids_.insert(id);
     }
 
     // ========================================================================
@@ -118,15 +136,15 @@ public:
     }
     
     /**
-     * @brief Advance time until a specific named timeout fires.
+     * @brief Advance time until a specific timeout fires.
      * 
      * Useful for testing: "advance until the setting mode timeout fires"
      * 
-     * @param name Name of the timeout to wait for
+     * @param id ID of the timeout to wait for
      * @param max_ms Maximum time to advance (safety limit)
-     * @return true if the named timeout was fired, false if max_ms reached
+     * @return true if the timeout was fired, false if max_ms reached
      */
-    bool advance_until(const std::string& name, uint32_t max_ms = 60000)
+    bool advance_until(WoleixTimerId id, uint32_t max_ms = 60000)
     {
         uint64_t deadline = current_time_ms_ + max_ms;
         
@@ -137,12 +155,12 @@ public:
                 break;
             
             current_time_ms_ = it->fire_at_ms;
-            std::string fired_name = it->name;
+            WoleixTimerId fired_id = it->id;
             auto callback = std::move(it->callback);
             timeouts_.erase(it);
             callback();
             
-            if (fired_name == name)
+            if (fired_id == id)
                 return true;
         }
         
@@ -155,35 +173,35 @@ public:
      * 
      * Time advances to that timeout's scheduled time.
      * 
-     * @return Name of the fired timeout, or empty string if none pending
+     * @return ID of the fired timeout, or nothing if none pending
      */
-    std::string fire_next()
+    std::optional<WoleixTimerId> fire_next()
     {
         if (timeouts_.empty())
-            return "";
+            return {};
         
         auto it = timeouts_.begin();
         current_time_ms_ = it->fire_at_ms;
-        std::string name = it->name;
+        WoleixTimerId id = it->id;
         auto callback = std::move(it->callback);
         timeouts_.erase(it);
         callback();
-        return name;
+        return id;
     }
     
     /**
-     * @brief Fire a specific timeout by name, regardless of time.
+     * @brief Fire a specific timeout by ID, regardless of time.
      * 
      * Does NOT advance time. Useful for testing specific scenarios.
      * 
-     * @param name Timeout name to fire
+     * @param id Timeout ID to fire
      * @return true if found and fired, false otherwise
      */
-    bool fire_timeout(const std::string& name)
+    bool fire_timeout(WoleixTimerId id)
     {
         for (auto it = timeouts_.begin(); it != timeouts_.end(); ++it)
         {
-            if (it->name == name)
+            if (it->id == id)
             {
                 auto callback = std::move(it->callback);
                 timeouts_.erase(it);
@@ -210,7 +228,7 @@ public:
         while (!queue->is_empty() && iterations++ < max_iterations)
         {
             // Fire the next command processing timeout
-            if (!fire_timeout("proto_next_cmd"))
+            if (!fire_timeout(WoleixTimerId::NEXT_COMMAND))
             {
                 // No command timeout pending, try advancing a bit
                 advance_time(100);
@@ -222,67 +240,67 @@ public:
     // Inspection Methods
     // ========================================================================
     
-    bool has_timeout(const std::string& name) const
+    bool has_timeout(WoleixTimerId id) const
     {
         return std::any_of(timeouts_.begin(), timeouts_.end(),
-            [&name](const auto& t) { return t.name == name; });
+            [id](const auto& t) { return t.id == id; });
     }
     
     /**
-     * @brief Get the scheduled fire time for a named timeout.
+     * @brief Get the scheduled fire time for a timeout.
      * @throws std::runtime_error if not found
      */
-    uint64_t get_timeout_time(const std::string& name) const
+    uint64_t get_timeout_time(WoleixTimerId id) const
     {
         for (const auto& t : timeouts_)
         {
-            if (t.name == name)
+            if (t.id == id)
                 return t.fire_at_ms;
         }
-        throw std::runtime_error("Timeout not found: " + name);
+        throw std::runtime_error("Timeout not found: " + std::to_string(static_cast<int>(id)));
     }
     
     /**
-     * @brief Get time remaining until a named timeout fires.
+     * @brief Get time remaining until a timeout fires.
      */
-    uint32_t time_until(const std::string& name) const
+    uint32_t time_until(WoleixTimerId id) const
     {
-        uint64_t fire_at = get_timeout_time(name);
+        uint64_t fire_at = get_timeout_time(id);
         if (fire_at <= current_time_ms_)
             return 0;
         return static_cast<uint32_t>(fire_at - current_time_ms_);
     }
     
-    bool was_cancelled(const std::string& name) const
+    bool was_cancelled(WoleixTimerId id) const
     {
-        return cancelled_names_.count(name) > 0;
+        return cancelled_ids_.count(id) > 0;
     }
     
     size_t pending_count() const { return timeouts_.size(); }
     
     /**
-     * @brief Get all pending timeout names (for debugging).
+     * @brief Get all pending timeout IDs (for debugging).
      */
-    std::vector<std::string> pending_names() const
+    std::vector<WoleixTimerId> pending_ids() const
     {
-        std::vector<std::string> names;
+        std::vector<WoleixTimerId> ids;
         for (const auto& t : timeouts_)
-            names.push_back(t.name);
-        return names;
+            ids.push_back(t.id);
+        return ids;
     }
     
     void reset()
     {
         timeouts_.clear();
-        cancelled_names_.clear();
+        cancelled_ids_.clear();
         current_time_ms_ = 0;
     }
 
-    void cancel_timeout_internal(const std::string& name)
+    void cancel_timeout_internal(WoleixTimerId id)
     {
         for (auto it = timeouts_.begin(); it != timeouts_.end(); )
         {
-            if (it->name == name)
+            if (it->id == id)
                 it = timeouts_.erase(it);
             else
                 ++it;
@@ -290,6 +308,6 @@ public:
     }
 
     std::set<ScheduledTimeout> timeouts_;  // Sorted by fire time
-    std::set<std::string> cancelled_names_;
+    std::set<WoleixTimerId> cancelled_ids_;
     uint64_t current_time_ms_;
 };
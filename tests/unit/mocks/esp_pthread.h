@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+// Mock of the ESP-IDF pthread configuration, for compiling the USE_ESP32 code paths
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+
+typedef struct
+{
+    size_t stack_size;
+    size_t prio;
+    bool inherit_cfg;
+    const char* thread_name;
+    int pin_to_core;
+} esp_pthread_cfg_t;
+
+inline esp_pthread_cfg_t esp_pthread_get_default_config()
+{
+    return esp_pthread_cfg_t{4096, 5, false, nullptr, -1};
+}
+
+inline esp_err_t esp_pthread_set_cfg(const esp_pthread_cfg_t* /* cfg */)
+{
+    return ESP_OK;
+}
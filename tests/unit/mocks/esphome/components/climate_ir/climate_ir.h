@@ -10,6 +10,7 @@
 #include "esphome/components/climate/climate.h"
 #include "esphome/components/climate/climate_mode.h"
 #include "esphome/components/remote_base/remote_base.h"
+#include "esphome/components/sensor/sensor.h"
 
 namespace esphome {
 namespace climate_ir {
@@ -19,11 +20,13 @@ using climate::ClimateMode;
 using climate::ClimateFanMode;
 using climate::ClimateSwingMode;
 using climate::ClimateTraits;
+using remote_base::RemoteReceiverListener;
 using remote_base::RemoteTransmittable;
 
 // Mock ClimateIR base class
 class ClimateIR
-  : public RemoteTransmittable,
+  : public RemoteReceiverListener,
+    public RemoteTransmittable,
     public Climate
 {
 public:
@@ -56,8 +59,21 @@ public:
       return traits();
     }
     
-    // Setup method (can be overridden)
-    virtual void setup() {}
+    // Setter for the current temperature sensor
+    void set_sensor(sensor::Sensor* sensor) {
+      sensor_ = sensor;
+    }
+
+    // Setup method (can be overridden), publishes every temperature reading
+    virtual void setup() {
+      if (sensor_ != nullptr) {
+        sensor_->add_on_state_callback([this](float state) {
+          current_temperature = state;
+          publish_state();
+        });
+        current_temperature = sensor_->state;
+      }
+    }
     
     void control(const climate::ClimateCall &call)
     {
@@ -75,33 +91,46 @@ public:
     virtual ClimateTraits traits() {
       return climate::ClimateTraits();
     }
+    // Dummy implementation, as in ESPHome: decoding is optional for child classes
+    bool on_receive(remote_base::RemoteReceiveData data) override { return false; }
     virtual void publish_state() {}
+    virtual void on_shutdown() {}
+    virtual void loop() {}
     // Protected members accessible to derived classes
     remote_base::RemoteTransmitterBase* transmitter_ = nullptr;
     float temperature_step_;
     float min_temperature_;
     float max_temperature_;
 
+    sensor::Sensor* sensor_ = nullptr;
+
+    float current_temperature{NAN};
     float current_humidity{NAN};
     
     virtual void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {}
     virtual bool cancel_timeout(const std::string &name) { return true; }
+    virtual void set_timeout(uint32_t id, uint32_t timeout, std::function<void()> &&f) {}
+    virtual bool cancel_timeout(uint32_t id) { return true; }
 
-    void status_set_warning(const char* message = nullptr) {}
-    void status_set_error(const char* message = nullptr) {}
-    void status_clear_warning() {}
-    void status_clear_error() {}
+    void status_set_warning(const char* message = nullptr) { status_warning_ = true; }
+    void status_set_error(const char* message = nullptr) { status_error_ = true; }
+    void status_clear_warning() { status_warning_ = false; }
+    void status_clear_error() { status_error_ = false; }
 
     // Temporary states (auto-clear after timeout)
     void status_momentary_warning(const std::string& name, uint32_t length = 5000) {}
     void status_momentary_error(const std::string& name, uint32_t length = 5000) {}
 
     // Check current status
-    bool status_has_warning() const { return false; }
-    bool status_has_error() const { return false; }
+    bool status_has_warning() const { return status_warning_; }
+    bool status_has_error() const { return status_error_; }
 
     // Fatal - marks component as failed, removes from loop
     void mark_failed() {}
+
+private:
+    bool status_warning_{false};
+    bool status_error_{false};
 };
 
 } // namespace climate_ir
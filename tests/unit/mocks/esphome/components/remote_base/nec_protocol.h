@@ -2,6 +2,10 @@
 
 #include <cinttypes>
 
+#include "esphome/core/optional.h"
+
+#include "remote_base.h"
+
 namespace esphome {
 namespace remote_base {
 
@@ -17,10 +21,75 @@ struct NECData
     }
 };
 
+// Mirrors ESPHome's NEC encoder
 class NECProtocol
 {
 public:
     using ProtocolData = NECData;
+
+    static constexpr uint32_t HEADER_HIGH_US = 9000;
+    static constexpr uint32_t HEADER_LOW_US = 4500;
+    static constexpr uint32_t BIT_HIGH_US = 560;
+    static constexpr uint32_t BIT_ONE_LOW_US = 1690;
+    static constexpr uint32_t BIT_ZERO_LOW_US = 560;
+
+    void encode(RemoteTransmitData *dst, const NECData &data)
+    {
+        dst->reserve(2 + 32 + 32 * data.command_repeats + 2);
+        dst->set_carrier_frequency(38000);
+
+        dst->item(HEADER_HIGH_US, HEADER_LOW_US);
+
+        for (uint16_t mask = 1; mask; mask <<= 1)
+        {
+            dst->item(BIT_HIGH_US, (data.address & mask) ? BIT_ONE_LOW_US : BIT_ZERO_LOW_US);
+        }
+
+        for (uint16_t repeats = 0; repeats < data.command_repeats; repeats++)
+        {
+            for (uint16_t mask = 1; mask; mask <<= 1)
+            {
+                dst->item(BIT_HIGH_US, (data.command & mask) ? BIT_ONE_LOW_US : BIT_ZERO_LOW_US);
+            }
+        }
+
+        dst->mark(BIT_HIGH_US);
+    }
+
+    optional<NECData> decode(RemoteReceiveData src)
+    {
+        NECData data{0, 0, 0};
+        if (!src.expect_item(HEADER_HIGH_US, HEADER_LOW_US)) return {};
+
+        if (!decode_word_(src, data.address)) return {};
+        while (src.peek_item(BIT_HIGH_US, BIT_ONE_LOW_US) || src.peek_item(BIT_HIGH_US, BIT_ZERO_LOW_US))
+        {
+            uint16_t command = 0;
+            if (!decode_word_(src, command)) return {};
+            if (data.command_repeats > 0 && data.command != command) return {};
+            data.command = command;
+            data.command_repeats++;
+        }
+        if (data.command_repeats == 0 || !src.expect_mark(BIT_HIGH_US)) return {};
+        return data;
+    }
+
+private:
+    static bool decode_word_(RemoteReceiveData& src, uint16_t& word)
+    {
+        for (uint16_t mask = 1; mask; mask <<= 1)
+        {
+            if (src.expect_item(BIT_HIGH_US, BIT_ONE_LOW_US))
+            {
+                word |= mask;
+            }
+            else if (!src.expect_item(BIT_HIGH_US, BIT_ZERO_LOW_US))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
 };
 }  // namespace remote_base
 }  // namespace esphome
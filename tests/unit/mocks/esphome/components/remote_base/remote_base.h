@@ -1,24 +1,38 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
-#include "nec_protocol.h"
-
 namespace esphome {
 namespace remote_base {
 
+using RawTimings = std::vector<int32_t>;
+
+// Mock RemoteTransmitData: marks are stored positive, spaces negative
 class RemoteTransmitData {
 public:
   void set_carrier_frequency(uint32_t freq) { carrier_frequency_ = freq; }
-  void mark(uint32_t us) { data_.push_back(us); }
-  void space(uint32_t us) { data_.push_back(us); }
+  void mark(uint32_t length) { data_.push_back(static_cast<int32_t>(length)); }
+  void space(uint32_t length) { data_.push_back(-static_cast<int32_t>(length)); }
+  void item(uint32_t mark, uint32_t space)
+  {
+    this->mark(mark);
+    this->space(space);
+  }
+  void reserve(uint32_t len) { data_.reserve(len); }
+  void set_data(const RawTimings& data) { data_ = data; }
+  void reset()
+  {
+    data_.clear();
+    carrier_frequency_ = 0;
+  }
   
   uint32_t get_carrier_frequency() const { return carrier_frequency_; }
-  const std::vector<uint32_t>& get_data() const { return data_; }
+  const RawTimings& get_data() const { return data_; }
   
 private:
   uint32_t carrier_frequency_ = 0;
-  std::vector<uint32_t> data_;
+  RawTimings data_;
 };
 
 
@@ -27,21 +41,105 @@ class RemoteTransmitterBase
 {
 public:
   virtual ~RemoteTransmitterBase() = default;
-  
+
+  class TransmitCall
+  {
+  public:
+    explicit TransmitCall(RemoteTransmitterBase* parent) : parent_(parent) {}
+    RemoteTransmitData* get_data() { return &parent_->temp_; }
+    void set_send_times(uint32_t send_times) { send_times_ = send_times; }
+    void set_send_wait(uint32_t send_wait) { send_wait_ = send_wait; }
+    void perform() { parent_->send_internal(send_times_, send_wait_); }
+
+  protected:
+    RemoteTransmitterBase* parent_;
+    uint32_t send_times_{1};
+    uint32_t send_wait_{0};
+  };
+
+  TransmitCall transmit()
+  {
+    temp_.reset();
+    return TransmitCall(this);
+  }
+
   template<typename Protocol>
-  void transmit(const typename Protocol::ProtocolData &data, uint32_t send_times, uint32_t send_wait);
-  virtual void send_(const NECProtocol::ProtocolData& data, uint32_t send_times, uint32_t send_wait)
+  void transmit(const typename Protocol::ProtocolData &data, uint32_t send_times, uint32_t send_wait)
+  {
+    auto call = transmit();
+    Protocol().encode(call.get_data(), data);
+    call.set_send_times(send_times);
+    call.set_send_wait(send_wait);
+    call.perform();
+  }
+
+  // Last transmitted data, for inspection in tests
+  const RemoteTransmitData& get_temp() const { return temp_; }
+
+protected:
+  virtual void send_internal(uint32_t send_times, uint32_t send_wait)
   {
     // Mock implementation
   }
+
+  RemoteTransmitData temp_;
 };
 
+// Mock RemoteReceiveData: a cursor over received timings, matched with a tolerance in percent
+class RemoteReceiveData {
+public:
+  RemoteReceiveData(const RawTimings& data, uint32_t tolerance = 25) : data_(data), tolerance_(tolerance) {}
+
+  bool peek_mark(uint32_t length, uint32_t offset = 0) const
+  {
+    if (index_ + offset >= data_.size()) return false;
+    int32_t value = data_[index_ + offset];
+    return value >= 0 && matches_(static_cast<uint32_t>(value), length);
+  }
+  bool peek_space(uint32_t length, uint32_t offset = 0) const
+  {
+    if (index_ + offset >= data_.size()) return false;
+    int32_t value = data_[index_ + offset];
+    return value <= 0 && matches_(static_cast<uint32_t>(-value), length);
+  }
+  bool peek_item(uint32_t mark, uint32_t space, uint32_t offset = 0) const
+  {
+    return peek_mark(mark, offset) && peek_space(space, offset + 1);
+  }
+  bool expect_mark(uint32_t length)
+  {
+    if (!peek_mark(length)) return false;
+    index_++;
+    return true;
+  }
+  bool expect_item(uint32_t mark, uint32_t space)
+  {
+    if (!peek_item(mark, space)) return false;
+    index_ += 2;
+    return true;
+  }
+  void reset() { index_ = 0; }
+  const RawTimings& get_raw_data() const { return data_; }
+
+private:
+  bool matches_(uint32_t value, uint32_t length) const
+  {
+    uint32_t margin = length * tolerance_ / 100;
+    return value + margin >= length && value <= length + margin;
+  }
+
+  const RawTimings& data_;
+  uint32_t tolerance_;
+  uint32_t index_{0};
+};
 
-template<>
-inline void RemoteTransmitterBase::transmit<NECProtocol>(const NECProtocol::ProtocolData &data, uint32_t send_times, uint32_t send_wait)
+// Mock RemoteReceiverListener
+class RemoteReceiverListener
 {
-  send_(data, send_times, send_wait);
-}
+public:
+  virtual ~RemoteReceiverListener() = default;
+  virtual bool on_receive(RemoteReceiveData data) = 0;
+};
 
 // Mock class that can be used with GMock
 class RemoteTransmittable
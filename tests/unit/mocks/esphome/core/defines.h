@@ -0,0 +1,4 @@
+#pragma once
+
+// Mock of the defines header ESPHome generates for each build.
+// Empty: the component falls back to its default timing profile.
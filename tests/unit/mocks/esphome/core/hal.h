@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstdint>
+
 namespace esphome {
 
-// Mock HAL - empty for now as we don't use it directly in the component
-// This file exists to satisfy the include in climate_ir_woleix.cpp
+// Mock HAL - only the clock, set by the tests
+inline uint32_t mock_millis = 0;
+
+inline uint32_t millis() { return mock_millis; }
 
 } // namespace esphome
@@ -2,6 +2,8 @@
 #include <gmock/gmock.h>
 #include <memory>
 #include <stdexcept>
+#include <cstdlib>
+#include <new>
 
 #include "woleix_constants.h"
 #include "woleix_command.h"
@@ -14,6 +16,18 @@ using namespace esphome::climate_ir_woleix;
 using ::testing::_;
 using ::testing::AtLeast;
 
+// Global allocation counter, used to prove the queue hot path is heap-free
+static size_t allocation_count = 0;
+
+void* operator new(std::size_t size)
+{
+    allocation_count++;
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
 // Producer notification tests
 class MockWoleixCommandQueueProducer : public WoleixCommandQueueProducer
 {
@@ -190,6 +204,388 @@ TEST_F(WoleixCommandQueueTest, ConsumersNotifiedOnEnquedCommand)
     mock_queue->enqueue(cmd);
 }
 
+TEST_F(WoleixCommandQueueTest, RingBufferKeepsOrderAcrossWrapAround)
+{
+    // Push the head index around the ring a few times
+    for (int i = 0; i < 40; ++i)
+    {
+        mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::POWER, 0xFB04));
+        mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04));
+        mock_queue->dequeue();
+        ASSERT_EQ(mock_queue->get().value().get_type(), WoleixCommand::Type::MODE);
+        mock_queue->dequeue();
+    }
+
+    WoleixCommand::Type types[] = {
+        WoleixCommand::Type::POWER,
+        WoleixCommand::Type::TEMP_UP,
+        WoleixCommand::Type::TEMP_DOWN,
+        WoleixCommand::Type::MODE,
+        WoleixCommand::Type::FAN_SPEED
+    };
+    for (auto type : types) mock_queue->enqueue(WoleixCommand(type, 0xFB04));
+
+    for (size_t i = 0; i < std::size(types); ++i)
+    {
+        EXPECT_EQ(mock_queue->get(i).value().get_type(), types[i]);
+    }
+}
+
+TEST_F(WoleixCommandQueueTest, EnqueueFailsWhenFull)
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        ASSERT_TRUE(mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04)));
+    }
+
+    EXPECT_CALL(*mock_producer, on_queue_full).Times(1);
+    EXPECT_FALSE(mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04)));
+    EXPECT_EQ(mock_queue->length(), 16);
+}
+
+static WoleixCommand high_priority(WoleixCommand::Type type)
+{
+    WoleixCommand command(type, 0xFB04);
+    command.set_priority(WoleixCommand::Priority::HIGH);
+    return command;
+}
+
+TEST_F(WoleixCommandQueueTest, HighPriorityCommandsJumpAheadOfNormalOnes)
+{
+    mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04));
+    mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::TEMP_DOWN, 0xFB04));
+    mock_queue->enqueue(high_priority(WoleixCommand::Type::POWER));
+    mock_queue->enqueue(std::vector<WoleixCommand>{ high_priority(WoleixCommand::Type::MODE) });
+
+    ASSERT_EQ(mock_queue->length(), 4);
+    EXPECT_EQ(mock_queue->get(0)->get_type(), WoleixCommand::Type::POWER);
+    EXPECT_EQ(mock_queue->get(1)->get_type(), WoleixCommand::Type::MODE);
+    EXPECT_EQ(mock_queue->get(2)->get_type(), WoleixCommand::Type::TEMP_UP);
+    EXPECT_EQ(mock_queue->get(3)->get_type(), WoleixCommand::Type::TEMP_DOWN);
+}
+
+TEST_F(WoleixCommandQueueTest, PreemptDropsNormalPriorityCommands)
+{
+    for (int i = 0; i < 12; ++i) mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04));
+    mock_queue->enqueue(high_priority(WoleixCommand::Type::POWER));
+
+    EXPECT_CALL(*mock_producer, on_queue_at_low_watermark).Times(1);
+    EXPECT_CALL(*mock_producer, on_queue_empty).Times(0);
+
+    EXPECT_EQ(mock_queue->preempt(), 12);
+    ASSERT_EQ(mock_queue->length(), 1);
+    EXPECT_EQ(mock_queue->get()->get_type(), WoleixCommand::Type::POWER);
+    EXPECT_EQ(mock_queue->preempt(), 0);
+}
+
+TEST_F(WoleixCommandQueueTest, PreemptEmptyingQueueNotifiesProducers)
+{
+    mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04));
+
+    EXPECT_CALL(*mock_producer, on_queue_empty).Times(1);
+
+    EXPECT_EQ(mock_queue->preempt(), 1);
+    EXPECT_TRUE(mock_queue->is_empty());
+}
+
+TEST_F(WoleixCommandQueueTest, KeepsAddressesOfPackedCommands)
+{
+    mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::POWER, 0xFB04));
+    mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0x1234, 0, 3));
+
+    EXPECT_TRUE(mock_queue->get(0).value() == WoleixCommand(WoleixCommand::Type::POWER, 0xFB04));
+    EXPECT_TRUE(mock_queue->get(1).value() == WoleixCommand(WoleixCommand::Type::MODE, 0x1234, 0, 3));
+}
+
+TEST_F(WoleixCommandQueueTest, RejectsCommandsThatDoNotPack)
+{
+    for (uint16_t address = 0; address < WoleixPackedCommand::ADDRESS_SLOTS; ++address)
+    {
+        EXPECT_TRUE(mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::POWER, address)));
+    }
+    EXPECT_FALSE(mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::POWER, 0xFB04)));
+    EXPECT_FALSE(mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::POWER, 0, 0, WoleixPackedCommand::MAX_REPEAT_COUNT + 1)));
+
+    // A plan is accepted or rejected as a whole
+    std::vector<WoleixCommand> plan =
+    {
+        WoleixCommand(WoleixCommand::Type::MODE, 0),
+        WoleixCommand(WoleixCommand::Type::MODE, 0xFB04)
+    };
+    EXPECT_FALSE(mock_queue->enqueue(plan));
+    EXPECT_EQ(mock_queue->length(), WoleixPackedCommand::ADDRESS_SLOTS);
+}
+
+TEST_F(WoleixCommandQueueTest, RecyclesAddressesOnceEmpty)
+{
+    for (uint16_t address = 0; address < WoleixPackedCommand::ADDRESS_SLOTS; ++address)
+    {
+        mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::POWER, address));
+    }
+    while (mock_queue->dequeue()) {}
+
+    EXPECT_TRUE(mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::FAN_SPEED, 0xFB04)));
+    EXPECT_EQ(mock_queue->get()->get_address(), 0xFB04);
+}
+
+/**
+ * Test: Rejected commands and plans do not hold on to address slots
+ */
+TEST_F(WoleixCommandQueueTest, RejectionReleasesAddresses)
+{
+    mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::POWER, 0xFB04));
+    EXPECT_FALSE(mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::POWER, 1, 0, WoleixPackedCommand::MAX_REPEAT_COUNT + 1)));
+
+    std::vector<WoleixCommand> plan;
+    for (uint16_t address = 2; address < 2 + WoleixPackedCommand::ADDRESS_SLOTS; ++address)
+    {
+        plan.push_back(WoleixCommand(WoleixCommand::Type::MODE, address));
+    }
+    EXPECT_FALSE(mock_queue->enqueue(plan));
+    EXPECT_EQ(mock_queue->length(), 1);
+
+    {
+        auto abandoned = mock_queue->begin_plan();
+        abandoned.emit(WoleixCommand(WoleixCommand::Type::MODE, 0x10));
+    }
+
+    // Only 0xFB04 is still registered
+    for (uint16_t address = 0x20; address < 0x20 + WoleixPackedCommand::ADDRESS_SLOTS - 1; ++address)
+    {
+        EXPECT_TRUE(mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::FAN_SPEED, address)));
+    }
+}
+
+/**
+ * Test: Commands emitted into a plan stay invisible until it is committed
+ */
+TEST_F(WoleixCommandQueueTest, PlanIsPublishedOnCommit)
+{
+    mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04));
+
+    EXPECT_CALL(*mock_consumer, on_command_enqueued()).Times(0);
+    auto plan = mock_queue->begin_plan();
+    EXPECT_TRUE(plan.emit(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04)));
+    EXPECT_TRUE(plan.emit(high_priority(WoleixCommand::Type::POWER)));
+    EXPECT_EQ(plan.size(), 2);
+    EXPECT_EQ(mock_queue->length(), 1);
+
+    EXPECT_TRUE(plan.commit());
+    EXPECT_EQ(mock_queue->length(), 3);
+    EXPECT_EQ(mock_queue->get(0)->get_type(), WoleixCommand::Type::POWER);
+    EXPECT_EQ(mock_queue->get(1)->get_type(), WoleixCommand::Type::MODE);
+    EXPECT_EQ(mock_queue->get(2)->get_type(), WoleixCommand::Type::TEMP_UP);
+}
+
+/**
+ * Test: A plan that does not fit is rejected as a whole
+ */
+TEST_F(WoleixCommandQueueTest, PlanOverflowLeavesQueueUntouched)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04));
+    }
+
+    EXPECT_CALL(*mock_producer, on_queue_full()).Times(1);
+    auto plan = mock_queue->begin_plan();
+    for (int i = 0; i < 8; i++)
+    {
+        EXPECT_EQ(plan.emit(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04)), i < 6);
+    }
+    EXPECT_FALSE(plan.commit());
+
+    EXPECT_EQ(mock_queue->length(), 10);
+    EXPECT_EQ(mock_queue->count_command(WoleixCommand::Type::TEMP_UP), 0);
+
+    // The staged slots are reused by the next plan
+    auto retry = mock_queue->begin_plan();
+    EXPECT_TRUE(retry.emit(WoleixCommand(WoleixCommand::Type::FAN_SPEED, 0xFB04)));
+    EXPECT_TRUE(retry.commit());
+    EXPECT_EQ(mock_queue->length(), 11);
+    EXPECT_EQ(mock_queue->get(10)->get_type(), WoleixCommand::Type::FAN_SPEED);
+}
+
+/**
+ * Test: A replacing plan drops the pending normal-priority commands on commit, not before
+ */
+TEST_F(WoleixCommandQueueTest, ReplacingPlanDropsPendingCommandsOnCommit)
+{
+    mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04));
+    mock_queue->enqueue(high_priority(WoleixCommand::Type::POWER));
+    mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04));
+
+    EXPECT_CALL(*mock_consumer, on_command_enqueued()).Times(0);
+    auto plan = mock_queue->begin_plan(true);
+    EXPECT_TRUE(plan.emit(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04)));
+    EXPECT_EQ(mock_queue->length(), 3);
+
+    EXPECT_TRUE(plan.commit());
+    EXPECT_EQ(mock_queue->length(), 2);
+    EXPECT_EQ(mock_queue->get(0)->get_type(), WoleixCommand::Type::POWER);
+    EXPECT_EQ(mock_queue->get(1)->get_type(), WoleixCommand::Type::TEMP_UP);
+}
+
+/**
+ * Test: A replacing plan rejected before it runs out of free slots keeps the pending commands
+ */
+TEST_F(WoleixCommandQueueTest, RejectedReplacingPlanKeepsPendingCommands)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04));
+    }
+
+    auto plan = mock_queue->begin_plan(true);
+    EXPECT_TRUE(plan.emit(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04)));
+    EXPECT_FALSE(plan.emit(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04, 0, WoleixPackedCommand::MAX_REPEAT_COUNT + 1)));
+    EXPECT_FALSE(plan.commit());
+
+    EXPECT_EQ(mock_queue->length(), 10);
+    EXPECT_EQ(mock_queue->count_command(WoleixCommand::Type::MODE), 10);
+}
+
+/**
+ * Test: A replacing plan may use the room of the pending commands it replaces
+ */
+TEST_F(WoleixCommandQueueTest, ReplacingPlanReusesRoomOfPendingCommands)
+{
+    mock_queue->enqueue(high_priority(WoleixCommand::Type::POWER));
+    for (int i = 1; i < mock_queue->max_capacity(); i++)
+    {
+        mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04));
+    }
+
+    EXPECT_CALL(*mock_producer, on_queue_full()).Times(0);
+    auto plan = mock_queue->begin_plan(true);
+    for (int i = 1; i < mock_queue->max_capacity(); i++)
+    {
+        EXPECT_TRUE(plan.emit(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04)));
+    }
+    EXPECT_TRUE(plan.commit());
+
+    EXPECT_EQ(mock_queue->length(), mock_queue->max_capacity());
+    EXPECT_EQ(mock_queue->get(0)->get_type(), WoleixCommand::Type::POWER);
+    EXPECT_EQ(mock_queue->count_command(WoleixCommand::Type::MODE), 0);
+    EXPECT_EQ(mock_queue->count_command(WoleixCommand::Type::TEMP_UP), mock_queue->max_capacity() - 1);
+}
+
+/**
+ * Test: A replacing plan too large even for the room of the pending commands is rejected,
+ * and the pending commands it dropped to make room stay dropped
+ */
+TEST_F(WoleixCommandQueueTest, OversizedReplacingPlanDropsPendingCommands)
+{
+    mock_queue->enqueue(high_priority(WoleixCommand::Type::POWER));
+    for (int i = 0; i < 4; i++)
+    {
+        mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04));
+    }
+
+    EXPECT_CALL(*mock_producer, on_queue_full()).Times(1);
+    auto plan = mock_queue->begin_plan(true);
+    for (int i = 0; i < mock_queue->max_capacity(); i++)
+    {
+        plan.emit(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04));
+    }
+    EXPECT_EQ(plan.dropped(), 4);
+    EXPECT_FALSE(plan.commit());
+
+    EXPECT_EQ(mock_queue->length(), 1);
+    EXPECT_EQ(mock_queue->get(0)->get_type(), WoleixCommand::Type::POWER);
+}
+
+/**
+ * Test: An empty replacing plan drains the queue and notifies the producers
+ */
+TEST_F(WoleixCommandQueueTest, EmptyReplacingPlanEmptiesQueue)
+{
+    mock_queue->enqueue(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04));
+
+    EXPECT_CALL(*mock_producer, on_queue_empty()).Times(1);
+    auto plan = mock_queue->begin_plan(true);
+    EXPECT_TRUE(plan.commit());
+    EXPECT_TRUE(mock_queue->is_empty());
+}
+
+/**
+ * Test: A plan with a command that does not pack is rejected as a whole
+ */
+TEST_F(WoleixCommandQueueTest, PlanWithUnpackableCommandIsRejected)
+{
+    EXPECT_CALL(*mock_consumer, on_command_enqueued()).Times(0);
+    EXPECT_CALL(*mock_producer, on_queue_full()).Times(0);
+
+    auto plan = mock_queue->begin_plan();
+    EXPECT_TRUE(plan.emit(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04)));
+    EXPECT_FALSE(plan.emit(WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04, 0, WoleixPackedCommand::MAX_REPEAT_COUNT + 1)));
+    EXPECT_FALSE(plan.commit());
+
+    EXPECT_TRUE(mock_queue->is_empty());
+}
+
+// Plain (non-gmock) listeners: gmock records calls on the heap
+class CountingProducer : public WoleixCommandQueueProducer
+{
+public:
+    void on_queue_at_high_watermark() override { high++; }
+    void on_queue_at_low_watermark() override { low++; }
+    void on_queue_full() override { full++; }
+    void on_queue_empty() override { empty++; }
+    int high{0}, low{0}, full{0}, empty{0};
+};
+
+class CountingConsumer : public WoleixCommandQueueConsumer
+{
+public:
+    void on_command_enqueued() override { enqueued++; }
+    int enqueued{0};
+};
+
+TEST(WoleixStaticCommandQueueTest, HotPathDoesNotAllocate)
+{
+    WoleixStaticCommandQueue<QUEUE_MAX_CAPACITY> queue;
+    CountingProducer producer;
+    CountingConsumer consumer;
+    queue.register_producer(&producer);
+    queue.register_consumer(&consumer);
+
+    std::vector<WoleixCommand> plan(10, WoleixCommand(WoleixCommand::Type::TEMP_UP, 0xFB04));
+    WoleixCommand single(WoleixCommand::Type::MODE, 0xFB04);
+
+    size_t allocations_before = allocation_count;
+
+    for (int round = 0; round < 100; ++round)
+    {
+        // Fill up to (and beyond) capacity, triggering every notification
+        while (queue.enqueue(single)) {}
+        queue.enqueue(plan);
+        while (queue.get().has_value())
+        {
+            queue.dequeue();
+        }
+        queue.enqueue(plan);
+        queue.reset();
+
+        auto staged = queue.begin_plan();
+        for (const auto& command : plan) staged.emit(command);
+        staged.commit();
+        queue.reset();
+    }
+
+    EXPECT_EQ(allocation_count - allocations_before, 0);
+
+    // Sanity check that the loop actually exercised the queue and its listeners
+    EXPECT_GT(producer.high, 0);
+    EXPECT_GT(producer.low, 0);
+    EXPECT_GT(producer.full, 0);
+    EXPECT_GT(producer.empty, 0);
+    EXPECT_GT(consumer.enqueued, 0);
+
+    queue.unregister_producer(&producer);
+    queue.unregister_consumer(&consumer);
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
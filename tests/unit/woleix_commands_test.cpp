@@ -78,6 +78,24 @@ TEST(WoleixNecCommandTest, EqualityOperator)
     EXPECT_FALSE(cmd1 == cmd4);  // Different address
 }
 
+/**
+ * Test: Received NEC codes map back to the command types
+ * 
+ * Only the buttons the controller tracks are decoded; TIMER and codes of
+ * other devices are not.
+ */
+TEST(WoleixNecCommandTest, TypeOfReceivedCode)
+{
+    for (auto type : { WoleixCommand::Type::POWER, WoleixCommand::Type::TEMP_UP, WoleixCommand::Type::TEMP_DOWN,
+                       WoleixCommand::Type::MODE, WoleixCommand::Type::FAN_SPEED })
+    {
+        EXPECT_EQ(WoleixCommand::type_of(WoleixCommand(type, ADDRESS_NEC).get_command()), type);
+    }
+
+    EXPECT_FALSE(WoleixCommand::type_of(TIMER_NEC).has_value());
+    EXPECT_FALSE(WoleixCommand::type_of(0x1234).has_value());
+}
+
 
 // ============================================================================
 // Main
@@ -88,3 +106,39 @@ int main(int argc, char **argv)
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }
+
+// ============================================================================
+// Test: WoleixPackedCommand
+// ============================================================================
+
+/**
+ * Test: Packing and unpacking preserves every field
+ */
+TEST(WoleixPackedCommandTest, RoundTripPreservesCommand)
+{
+    for (auto type : WoleixPackedCommand::TYPES)
+    {
+        for (auto priority : { WoleixCommand::Priority::NORMAL, WoleixCommand::Priority::HIGH })
+        {
+            WoleixCommand cmd(type, 0xFB04, 0, WoleixPackedCommand::MAX_REPEAT_COUNT);
+            cmd.set_priority(priority);
+
+            auto packed = WoleixPackedCommand::pack(cmd, 3);
+            ASSERT_TRUE(packed.has_value());
+            EXPECT_EQ(packed->address_slot(), 3);
+            EXPECT_TRUE(packed->unpack(0xFB04) == cmd);
+        }
+    }
+}
+
+/**
+ * Test: Commands that do not fit into 2 bytes are rejected
+ */
+TEST(WoleixPackedCommandTest, RejectsOversizedFields)
+{
+    WoleixCommand cmd(WoleixCommand::Type::MODE, 0xFB04, 0, WoleixPackedCommand::MAX_REPEAT_COUNT + 1);
+
+    EXPECT_FALSE(WoleixPackedCommand::pack(cmd, 0).has_value());
+    EXPECT_FALSE(WoleixPackedCommand::pack(WoleixCommand(WoleixCommand::Type::MODE, 0xFB04), WoleixPackedCommand::ADDRESS_SLOTS).has_value());
+    EXPECT_EQ(sizeof(WoleixPackedCommand), 2u);
+}
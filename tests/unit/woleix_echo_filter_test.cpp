@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+
+#include "woleix_constants.h"
+#include "woleix_echo_filter.h"
+
+using namespace esphome::climate_ir_woleix;
+
+// ============================================================================
+// Test: Echoes
+// ============================================================================
+
+TEST(WoleixEchoFilterTest, NothingIsAnEchoBeforeSending)
+{
+    WoleixEchoFilter filter;
+
+    EXPECT_FALSE(filter.consume(TEMP_UP_NEC, 0));
+}
+
+TEST(WoleixEchoFilterTest, EachFrameIsConsumedOnce)
+{
+    WoleixEchoFilter filter;
+    filter.expect(TEMP_UP_NEC, 2, 1000);
+
+    EXPECT_TRUE(filter.consume(TEMP_UP_NEC, 100));
+    EXPECT_TRUE(filter.consume(TEMP_UP_NEC, 300));
+    EXPECT_FALSE(filter.consume(TEMP_UP_NEC, 400));
+}
+
+TEST(WoleixEchoFilterTest, OtherButtonsAreNotEchoes)
+{
+    WoleixEchoFilter filter;
+    filter.expect(TEMP_UP_NEC, 1, 1000);
+
+    EXPECT_FALSE(filter.consume(TEMP_DOWN_NEC, 100));
+    EXPECT_TRUE(filter.consume(TEMP_UP_NEC, 100));
+}
+
+/**
+ * Test: Echoes that never arrived do not swallow later remote presses
+ */
+TEST(WoleixEchoFilterTest, OverdueEchoesExpire)
+{
+    WoleixEchoFilter filter;
+    filter.expect(MODE_NEC, 1, 1000);
+
+    EXPECT_FALSE(filter.consume(MODE_NEC, 1001));
+    EXPECT_FALSE(filter.consume(MODE_NEC, 1002));
+}
+
+TEST(WoleixEchoFilterTest, SameButtonAccumulates)
+{
+    WoleixEchoFilter filter;
+    filter.expect(TEMP_UP_NEC, 1, 500);
+    filter.expect(TEMP_UP_NEC, 1, 800);
+
+    EXPECT_TRUE(filter.consume(TEMP_UP_NEC, 600));
+    EXPECT_TRUE(filter.consume(TEMP_UP_NEC, 700));
+    EXPECT_FALSE(filter.consume(TEMP_UP_NEC, 750));
+}
+
+/**
+ * Test: A late echo of the entry press survives the next transmission
+ */
+TEST(WoleixEchoFilterTest, ButtonsAreTrackedSeparately)
+{
+    WoleixEchoFilter filter;
+    filter.expect(TEMP_UP_NEC, 1, 400);
+    filter.expect(MODE_NEC, 1, 600);
+
+    EXPECT_TRUE(filter.consume(TEMP_UP_NEC, 350));
+    EXPECT_TRUE(filter.consume(MODE_NEC, 500));
+}
+
+TEST(WoleixEchoFilterTest, FullFilterGivesUpTheEchoDueFirst)
+{
+    WoleixEchoFilter filter;
+    const uint16_t commands[] = { POWER_NEC, MODE_NEC, TEMP_UP_NEC, TEMP_DOWN_NEC };
+    for (uint32_t i = 0; i < WoleixEchoFilter::SLOT_COUNT; i++)
+    {
+        filter.expect(commands[i], 1, 1000 + i);
+    }
+
+    filter.expect(SPEED_NEC, 1, 2000);
+
+    EXPECT_FALSE(filter.consume(POWER_NEC, 100));
+    EXPECT_TRUE(filter.consume(MODE_NEC, 100));
+    EXPECT_TRUE(filter.consume(SPEED_NEC, 100));
+}
+
+TEST(WoleixEchoFilterTest, HandlesClockWraparound)
+{
+    WoleixEchoFilter filter;
+    filter.expect(POWER_NEC, 1, 100);
+
+    EXPECT_TRUE(filter.consume(POWER_NEC, UINT32_MAX - 10));
+}
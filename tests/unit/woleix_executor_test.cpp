@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "woleix_constants.h"
+#include "woleix_command.h"
+#include "woleix_executor.h"
+#include "woleix_protocol_handler.h"
+
+using namespace esphome::climate_ir_woleix;
+using namespace esphome::remote_base;
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Wait until a condition, checked with the executor's mutex held, holds.
+ */
+template<typename Predicate>
+static bool wait_for(WoleixExecutor& executor, Predicate predicate, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000))
+{
+    auto deadline = Clock::now() + timeout;
+    while (Clock::now() < deadline)
+    {
+        {
+            std::lock_guard<std::recursive_mutex> lock(executor.mutex());
+            if (predicate()) return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+/**
+ * Median of the absolute deviations, in microseconds.
+ */
+static int64_t median_us(std::vector<int64_t> deviations)
+{
+    std::sort(deviations.begin(), deviations.end());
+    return deviations[deviations.size() / 2];
+}
+
+// ============================================================================
+// Test: Timer semantics
+// ============================================================================
+
+TEST(WoleixThreadExecutorTest, FiresTimersInDeadlineOrder)
+{
+    WoleixThreadExecutor executor;
+    std::vector<WoleixTimerId> fired;
+    auto* log = &fired;
+    ASSERT_TRUE(executor.start());
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(executor.mutex());
+        executor.schedule_timer(WoleixTimerId::READINGS, 30, [log]() { log->push_back(WoleixTimerId::READINGS); });
+        executor.schedule_timer(WoleixTimerId::METRICS, 10, [log]() { log->push_back(WoleixTimerId::METRICS); });
+        executor.schedule_timer(WoleixTimerId::DEBOUNCE, 20, [log]() { log->push_back(WoleixTimerId::DEBOUNCE); });
+    }
+
+    ASSERT_TRUE(wait_for(executor, [&]() { return fired.size() == 3; }));
+    EXPECT_EQ(fired, (std::vector<WoleixTimerId>{ WoleixTimerId::METRICS, WoleixTimerId::DEBOUNCE, WoleixTimerId::READINGS }));
+}
+
+TEST(WoleixThreadExecutorTest, RescheduleReplacesAndCancelDrops)
+{
+    WoleixThreadExecutor executor;
+    int first = 0, second = 0, cancelled = 0;
+    int* a = &first;
+    int* b = &second;
+    int* c = &cancelled;
+    ASSERT_TRUE(executor.start());
+
+    executor.schedule_timer(WoleixTimerId::NEXT_COMMAND, 10, [a]() { (*a)++; });
+    executor.schedule_timer(WoleixTimerId::NEXT_COMMAND, 20, [b]() { (*b)++; });
+    executor.schedule_timer(WoleixTimerId::SETTING_MODE, 10, [c]() { (*c)++; });
+    executor.cancel_timer(WoleixTimerId::SETTING_MODE);
+
+    ASSERT_TRUE(wait_for(executor, [&]() { return second == 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    std::lock_guard<std::recursive_mutex> lock(executor.mutex());
+    EXPECT_EQ(first, 0);
+    EXPECT_EQ(cancelled, 0);
+}
+
+/**
+ * Test: A timer cancelled while its callback waits for the mutex does not run
+ *
+ * The main loop may hold the mutex when a timer expires, and cancel that very
+ * timer, e.g. on reset. The expired callback must not run afterwards.
+ */
+TEST(WoleixThreadExecutorTest, CancelWhileHoldingMutexWins)
+{
+    WoleixThreadExecutor executor;
+    int count = 0;
+    int* counter = &count;
+    ASSERT_TRUE(executor.start());
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(executor.mutex());
+        executor.schedule_timer(WoleixTimerId::NEXT_COMMAND, 1, [counter]() { (*counter)++; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        executor.cancel_timer(WoleixTimerId::NEXT_COMMAND);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::lock_guard<std::recursive_mutex> lock(executor.mutex());
+    EXPECT_EQ(count, 0);
+}
+
+TEST(WoleixThreadExecutorTest, StopDropsPendingTimers)
+{
+    WoleixThreadExecutor executor;
+    int count = 0;
+    int* counter = &count;
+    ASSERT_TRUE(executor.start());
+
+    executor.schedule_timer(WoleixTimerId::NEXT_COMMAND, 10, [counter]() { (*counter)++; });
+    executor.stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    EXPECT_EQ(count, 0);
+}
+
+// ============================================================================
+// Test: Jitter
+// ============================================================================
+
+/**
+ * Test: Self-rescheduling timers fire within a millisecond of their deadline
+ *
+ * Chains timers the way the protocol handler does, each callback scheduling
+ * the next, and measures how late each one fires.
+ */
+TEST(WoleixThreadExecutorTest, ChainedTimersHaveSubMillisecondJitter)
+{
+    static constexpr uint32_t PERIOD_MS = 5;
+    static constexpr size_t COUNT = 100;
+
+    struct Chain
+    {
+        WoleixThreadExecutor* executor;
+        Clock::time_point deadline;
+        std::vector<int64_t> lateness_us;
+
+        void arm()
+        {
+            deadline = Clock::now() + std::chrono::milliseconds(PERIOD_MS);
+            executor->schedule_timer(WoleixTimerId::NEXT_COMMAND, PERIOD_MS, [this]() { fire(); });
+        }
+
+        void fire()
+        {
+            lateness_us.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - deadline).count());
+            if (lateness_us.size() < COUNT) arm();
+        }
+    };
+
+    WoleixThreadExecutor executor;
+    Chain chain{&executor, {}, {}};
+    ASSERT_TRUE(executor.start());
+    {
+        std::lock_guard<std::recursive_mutex> lock(executor.mutex());
+        chain.arm();
+    }
+
+    ASSERT_TRUE(wait_for(executor, [&]() { return chain.lateness_us.size() == COUNT; }));
+
+    int64_t median = median_us(chain.lateness_us);
+    int64_t max = *std::max_element(chain.lateness_us.begin(), chain.lateness_us.end());
+    RecordProperty("median_lateness_us", static_cast<int>(median));
+    RecordProperty("max_lateness_us", static_cast<int>(max));
+
+    EXPECT_GE(*std::min_element(chain.lateness_us.begin(), chain.lateness_us.end()), 0);
+    EXPECT_LT(median, 1000);
+}
+
+/**
+ * Transmitter recording when each frame is handed over.
+ */
+class TimestampingTransmitter : public RemoteTransmitterBase
+{
+public:
+    std::vector<Clock::time_point> sent_at;
+
+    void send_internal(uint32_t, uint32_t) override
+    {
+        sent_at.push_back(Clock::now());
+    }
+};
+
+/**
+ * Test: Command gaps driven by the executor are precise to the millisecond
+ *
+ * Runs the protocol handler on the thread executor, as WoleixClimate does
+ * with `executor: dedicated`, and measures the gaps between frames.
+ */
+TEST(WoleixThreadExecutorTest, ProtocolHandlerGapsHaveSubMillisecondJitter)
+{
+    static constexpr size_t PRESSES = 6;
+
+    WoleixThreadExecutor executor;
+    TimestampingTransmitter transmitter;
+    WoleixStaticCommandQueue<16> queue;
+    WoleixProtocolHandler handler(&executor);
+    handler.set_transmitter(&transmitter);
+    ASSERT_TRUE(executor.start());
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(executor.mutex());
+        handler.setup(&queue);
+        for (size_t i = 0; i < PRESSES; i++)
+        {
+            queue.enqueue(WoleixCommand(WoleixCommand::Type::FAN_SPEED, ADDRESS_NEC));
+        }
+    }
+
+    ASSERT_TRUE(wait_for(executor, [&]() { return transmitter.sent_at.size() == PRESSES; }, std::chrono::milliseconds(5000)));
+
+    std::vector<int64_t> deviations_us;
+    {
+        std::lock_guard<std::recursive_mutex> lock(executor.mutex());
+        for (size_t i = 1; i < transmitter.sent_at.size(); i++)
+        {
+            auto gap = std::chrono::duration_cast<std::chrono::microseconds>(transmitter.sent_at[i] - transmitter.sent_at[i - 1]);
+            deviations_us.push_back(std::abs(gap.count() - static_cast<int64_t>(WOLEIX_FAN_SPEED_GAP_MS) * 1000));
+        }
+    }
+    executor.stop();
+
+    int64_t median = median_us(deviations_us);
+    int64_t max = *std::max_element(deviations_us.begin(), deviations_us.end());
+    RecordProperty("median_gap_jitter_us", static_cast<int>(median));
+    RecordProperty("max_gap_jitter_us", static_cast<int>(max));
+
+    EXPECT_LT(median, 1000);
+}
+
+TEST(WoleixThreadExecutorTest, ClockIsMonotonic)
+{
+    WoleixThreadExecutor executor;
+
+    uint32_t before = executor.now_ms();
+    std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    uint32_t elapsed = executor.now_ms() - before;
+
+    EXPECT_GE(elapsed, 15u);
+    EXPECT_LT(elapsed, 1000u);
+}
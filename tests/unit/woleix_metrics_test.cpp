@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "woleix_constants.h"
+#include "woleix_metrics.h"
+
+using namespace esphome::climate_ir_woleix;
+
+// ============================================================================
+// Test: Counters
+// ============================================================================
+
+TEST(WoleixMetricsTest, StartsAtZero)
+{
+    WoleixMetrics metrics;
+    WoleixMetricsSnapshot snapshot = metrics.snapshot();
+
+    EXPECT_EQ(snapshot.queue_depth, 0u);
+    EXPECT_EQ(snapshot.peak_queue_depth, 0u);
+    EXPECT_EQ(snapshot.commands_transmitted, 0u);
+    EXPECT_EQ(snapshot.rejected_plans, 0u);
+    EXPECT_EQ(snapshot.setting_mode_entries, 0u);
+    EXPECT_EQ(snapshot.setting_mode_reuses, 0u);
+    EXPECT_EQ(snapshot.airtime_ms, 0u);
+}
+
+TEST(WoleixMetricsTest, QueueDepthKeepsPeak)
+{
+    WoleixMetrics metrics;
+
+    metrics.record_queue_depth(3);
+    metrics.record_queue_depth(12);
+    metrics.record_queue_depth(5);
+
+    EXPECT_EQ(metrics.snapshot().queue_depth, 5u);
+    EXPECT_EQ(metrics.snapshot().peak_queue_depth, 12u);
+}
+
+TEST(WoleixMetricsTest, FramesAddAirtime)
+{
+    WoleixMetrics metrics;
+
+    metrics.record_frames(1);
+    metrics.record_frames(4);
+
+    EXPECT_EQ(metrics.snapshot().commands_transmitted, 5u);
+    EXPECT_EQ(metrics.snapshot().airtime_ms, 5 * NEC_FRAME_DURATION_MS);
+}
+
+TEST(WoleixMetricsTest, CountsEvents)
+{
+    WoleixMetrics metrics;
+
+    metrics.record_rejected_plan();
+    metrics.record_setting_mode_entry();
+    metrics.record_setting_mode_reuse();
+    metrics.record_setting_mode_reuse();
+
+    WoleixMetricsSnapshot snapshot = metrics.snapshot();
+    EXPECT_EQ(snapshot.rejected_plans, 1u);
+    EXPECT_EQ(snapshot.setting_mode_entries, 1u);
+    EXPECT_EQ(snapshot.setting_mode_reuses, 2u);
+}
+
+TEST(WoleixMetricsTest, PerMinuteScalesInterval)
+{
+    EXPECT_FLOAT_EQ(WoleixMetrics::per_minute(10, 60000), 10.0f);
+    EXPECT_FLOAT_EQ(WoleixMetrics::per_minute(10, 30000), 20.0f);
+    EXPECT_FLOAT_EQ(WoleixMetrics::per_minute(10, 0), 0.0f);
+
+    // Differences of wrapped counters stay correct
+    uint32_t before = 0xFFFFFFFEu;
+    uint32_t after = 3;
+    EXPECT_FLOAT_EQ(WoleixMetrics::per_minute(after - before, 60000), 5.0f);
+}
+
+// ============================================================================
+// Test: Latency histogram
+// ============================================================================
+
+TEST(WoleixLatencyHistogramTest, BucketsAreLogScale)
+{
+    // Linear below 4 ms
+    for (uint32_t ms = 0; ms < 4; ms++)
+    {
+        EXPECT_EQ(WoleixLatencyHistogram::bucket_of(ms), ms);
+    }
+
+    // Four buckets per power of two, each value below its bucket's upper bound
+    for (uint32_t ms : { 4u, 5u, 7u, 8u, 100u, 999u, 1000u, 65535u, 100000u })
+    {
+        size_t bucket = WoleixLatencyHistogram::bucket_of(ms);
+        EXPECT_LT(ms, WoleixLatencyHistogram::upper_bound_of(bucket));
+        EXPECT_LE(WoleixLatencyHistogram::upper_bound_of(bucket), ms + ms / 4 + 1);
+        if (bucket > 0)
+        {
+            EXPECT_GE(ms, WoleixLatencyHistogram::upper_bound_of(bucket - 1));
+        }
+    }
+
+    // Everything too large lands in the last bucket
+    EXPECT_EQ(WoleixLatencyHistogram::bucket_of(UINT32_MAX), WoleixLatencyHistogram::BUCKET_COUNT - 1);
+}
+
+TEST(WoleixLatencyHistogramTest, EmptyHistogramReportsZero)
+{
+    WoleixLatencyHistogram histogram;
+
+    EXPECT_EQ(histogram.percentile(0.5f), 0u);
+    EXPECT_EQ(histogram.max(), 0u);
+}
+
+TEST(WoleixLatencyHistogramTest, PercentilesFollowDistribution)
+{
+    WoleixLatencyHistogram histogram;
+    for (int i = 0; i < 90; i++) histogram.record(400);
+    for (int i = 0; i < 10; i++) histogram.record(3000);
+
+    // 400 lies in [384, 448), 3000 in [2560, 3072)
+    EXPECT_EQ(histogram.percentile(0.50f), 448u);
+    EXPECT_EQ(histogram.percentile(0.90f), 448u);
+    EXPECT_EQ(histogram.percentile(0.95f), 3000u);  // capped at the maximum
+    EXPECT_EQ(histogram.max(), 3000u);
+    EXPECT_EQ(histogram.count(), 100u);
+}
+
+// ============================================================================
+// Test: Concurrent updates
+// ============================================================================
+
+/**
+ * Test: Updates from several tasks are never lost
+ *
+ * Meant to run under ThreadSanitizer as well (-DENABLE_TSAN=ON).
+ */
+TEST(WoleixMetricsTest, ConcurrentUpdatesAreNotLost)
+{
+    static constexpr uint32_t THREADS = 4;
+    static constexpr uint32_t ITERATIONS = 50000;
+
+    WoleixMetrics metrics;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREADS; t++)
+    {
+        threads.emplace_back([&metrics, t]()
+        {
+            for (uint32_t i = 0; i < ITERATIONS; i++)
+            {
+                metrics.record_frames(1);
+                metrics.record_setting_mode_reuse();
+                metrics.record_queue_depth(t * ITERATIONS + i);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    WoleixMetricsSnapshot snapshot = metrics.snapshot();
+    EXPECT_EQ(snapshot.commands_transmitted, THREADS * ITERATIONS);
+    EXPECT_EQ(snapshot.setting_mode_reuses, THREADS * ITERATIONS);
+    EXPECT_EQ(snapshot.airtime_ms, THREADS * ITERATIONS * NEC_FRAME_DURATION_MS);
+    EXPECT_EQ(snapshot.peak_queue_depth, THREADS * ITERATIONS - 1);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "esphome/components/remote_base/remote_base.h"
+#include "esphome/components/remote_base/nec_protocol.h"
+
+#include "woleix_constants.h"
+#include "woleix_nec_pulse_cache.h"
+
+using namespace esphome::climate_ir_woleix;
+using namespace esphome::remote_base;
+
+// Encode a frame with the NEC protocol encoder
+static RawTimings encode_with_protocol(uint16_t address, uint16_t command)
+{
+    RemoteTransmitData data;
+    NECProtocol().encode(&data, NECData{ address, command, 1 });
+    return data.get_data();
+}
+
+// ============================================================================
+// Test: Encoding
+// ============================================================================
+
+/**
+ * Test: The cached frames are identical to the NEC encoder output
+ *
+ * Covers every button of the remote, including TIMER.
+ */
+TEST(WoleixNecPulseCacheTest, MatchesNecEncoderForAllButtons)
+{
+    WoleixNecPulseCache cache;
+    cache.build();
+
+    for (uint16_t command : WoleixNecPulseCache::COMMANDS)
+    {
+        const RawTimings* timings = cache.get(ADDRESS_NEC, command);
+
+        ASSERT_NE(timings, nullptr);
+        EXPECT_EQ(*timings, encode_with_protocol(ADDRESS_NEC, command)) << "command " << command;
+        EXPECT_EQ(timings->size(), WoleixNecPulseCache::FRAME_TIMING_COUNT);
+    }
+}
+
+TEST(WoleixNecPulseCacheTest, EncodeMatchesNecEncoderForArbitraryWords)
+{
+    for (uint32_t word : { 0x00000000u, 0xFFFFFFFFu, 0x12345678u, 0xA5A55A5Au })
+    {
+        auto address = static_cast<uint16_t>(word & 0xFFFF);
+        auto command = static_cast<uint16_t>(word >> 16);
+        RawTimings timings;
+
+        WoleixNecPulseCache::encode(address, command, timings);
+
+        EXPECT_EQ(timings, encode_with_protocol(address, command));
+    }
+}
+
+TEST(WoleixNecPulseCacheTest, FrameTimingConstantsMatchProtocol)
+{
+    EXPECT_EQ(WoleixNecPulseCache::HEADER_MARK_US, NECProtocol::HEADER_HIGH_US);
+    EXPECT_EQ(WoleixNecPulseCache::HEADER_SPACE_US, NECProtocol::HEADER_LOW_US);
+    EXPECT_EQ(WoleixNecPulseCache::BIT_MARK_US, NECProtocol::BIT_HIGH_US);
+    EXPECT_EQ(WoleixNecPulseCache::ONE_SPACE_US, NECProtocol::BIT_ONE_LOW_US);
+    EXPECT_EQ(WoleixNecPulseCache::ZERO_SPACE_US, NECProtocol::BIT_ZERO_LOW_US);
+}
+
+// ============================================================================
+// Test: Lookup
+// ============================================================================
+
+TEST(WoleixNecPulseCacheTest, EmptyUntilBuilt)
+{
+    WoleixNecPulseCache cache;
+
+    EXPECT_FALSE(cache.is_built());
+    EXPECT_EQ(cache.get(ADDRESS_NEC, POWER_NEC), nullptr);
+
+    cache.build();
+    EXPECT_TRUE(cache.is_built());
+    EXPECT_NE(cache.get(ADDRESS_NEC, POWER_NEC), nullptr);
+}
+
+TEST(WoleixNecPulseCacheTest, UnknownCommandOrAddressIsNotCached)
+{
+    WoleixNecPulseCache cache;
+    cache.build();
+
+    EXPECT_EQ(cache.get(ADDRESS_NEC, 0x1234), nullptr);
+    EXPECT_EQ(cache.get(0x1234, POWER_NEC), nullptr);
+}
+
+TEST(WoleixNecPulseCacheTest, BuildsForCustomAddress)
+{
+    WoleixNecPulseCache cache;
+    cache.build(0x1234);
+
+    const RawTimings* timings = cache.get(0x1234, MODE_NEC);
+    ASSERT_NE(timings, nullptr);
+    EXPECT_EQ(*timings, encode_with_protocol(0x1234, MODE_NEC));
+    EXPECT_EQ(cache.get(ADDRESS_NEC, MODE_NEC), nullptr);
+}
@@ -0,0 +1,462 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "woleix_constants.h"
+#include "woleix_command.h"
+#include "woleix_state_manager.h"
+#include "woleix_path_planner.h"
+
+using namespace esphome::climate_ir_woleix;
+
+using Type = WoleixCommand::Type;
+
+static const std::vector<Type> ALL_BUTTONS =
+{
+    Type::POWER, Type::MODE, Type::TEMP_UP, Type::TEMP_DOWN, Type::FAN_SPEED
+};
+
+/**
+ * Brute-force oracle: breadth-first search over all press sequences, layer by
+ * layer, keeping the cheapest way to reach each (state, setting mode) node.
+ * Every button is tried in every state, so it does not share the planner's
+ * pruning, and press costs are derived from the protocol timing directly.
+ */
+static uint32_t oracle_cost
+(
+    const WoleixInternalState& from,
+    const WoleixInternalState& to,
+    bool setting_mode_active,
+    size_t max_presses = 24
+)
+{
+    using Key = std::tuple<int, int, int, int, bool>;
+    auto key = [](const WoleixInternalState& s, bool active)
+    {
+        return Key(static_cast<int>(s.power), static_cast<int>(s.mode),
+                   static_cast<int>(s.temperature), static_cast<int>(s.fan_speed), active);
+    };
+
+    const WoleixInternalState goal = WoleixPathPlanner::normalize(from, to);
+    uint32_t best = std::numeric_limits<uint32_t>::max();
+
+    std::map<Key, std::pair<WoleixInternalState, uint32_t>> layer;
+    std::map<Key, uint32_t> seen;
+    layer[key(from, setting_mode_active)] = { from, 0 };
+
+    for (size_t depth = 0; depth <= max_presses && !layer.empty(); depth++)
+    {
+        std::map<Key, std::pair<WoleixInternalState, uint32_t>> next_layer;
+        for (const auto& [k, entry] : layer)
+        {
+            const auto& [state, cost] = entry;
+            if (!WoleixStateManager::next_command(state, goal).has_value())
+            {
+                best = std::min(best, cost);
+            }
+
+            for (auto type : ALL_BUTTONS)
+            {
+                bool active = std::get<4>(k);
+                bool is_temp = type == Type::TEMP_UP || type == Type::TEMP_DOWN;
+                uint32_t step = NEC_FRAME_DURATION_MS + command_gap_ms(static_cast<uint16_t>(type));
+                if (is_temp && !active)
+                {
+                    step += NEC_FRAME_DURATION_MS + TEMP_ENTER_DELAY_MS;
+                    active = true;
+                }
+
+                WoleixInternalState next = state;
+                WoleixStateManager::apply(next, type);
+                Key next_key = key(next, active);
+                uint32_t next_cost = cost + step;
+
+                auto it = seen.find(next_key);
+                if (it != seen.end() && it->second <= next_cost) continue;
+                seen[next_key] = next_cost;
+                next_layer[next_key] = { next, next_cost };
+            }
+        }
+        layer = std::move(next_layer);
+    }
+    return best;
+}
+
+/**
+ * Brute-force oracle starting into a setting mode window of known length.
+ *
+ * Same search, but the exact end of the window is part of each node, and
+ * the wait for a window closing within the guard margin is derived from the
+ * protocol timing directly. Temperature presses that change nothing are not
+ * tried: they would only keep the window open, and nothing sends them.
+ * Paths costing more than @p bound are dropped to keep the search small.
+ */
+static uint32_t oracle_cost_in_window
+(
+    const WoleixInternalState& from,
+    const WoleixInternalState& to,
+    uint32_t closes_at_ms,
+    uint32_t bound,
+    size_t max_presses = 24
+)
+{
+    using Key = std::tuple<int, int, int, int, uint32_t>;
+    auto key = [](const WoleixInternalState& s, uint32_t closes_at)
+    {
+        return Key(static_cast<int>(s.power), static_cast<int>(s.mode),
+                   static_cast<int>(s.temperature), static_cast<int>(s.fan_speed), closes_at);
+    };
+
+    const WoleixInternalState goal = WoleixPathPlanner::normalize(from, to);
+    uint32_t best = std::numeric_limits<uint32_t>::max();
+
+    std::map<Key, std::pair<WoleixInternalState, uint32_t>> layer;
+    std::map<Key, uint32_t> seen;
+    layer[key(from, closes_at_ms)] = { from, 0 };
+
+    for (size_t depth = 0; depth <= max_presses && !layer.empty(); depth++)
+    {
+        std::map<Key, std::pair<WoleixInternalState, uint32_t>> next_layer;
+        for (const auto& [k, entry] : layer)
+        {
+            const auto& [state, cost] = entry;
+            if (!WoleixStateManager::next_command(state, goal).has_value())
+            {
+                best = std::min(best, cost);
+            }
+
+            for (auto type : ALL_BUTTONS)
+            {
+                uint32_t closes_at = std::get<4>(k);
+                bool is_temp = type == Type::TEMP_UP || type == Type::TEMP_DOWN;
+                WoleixInternalState next = state;
+                WoleixStateManager::apply(next, type);
+                if (is_temp && next == state) continue;
+
+                uint32_t step = NEC_FRAME_DURATION_MS + command_gap_ms(static_cast<uint16_t>(type));
+                if (is_temp)
+                {
+                    uint32_t sent_at = cost;
+                    if (closes_at < cost + TEMP_SETTING_MODE_GUARD_MS)
+                    {
+                        uint32_t wait = closes_at > cost ? closes_at - cost : 0;
+                        step += wait + NEC_FRAME_DURATION_MS + TEMP_ENTER_DELAY_MS;
+                        sent_at += wait + NEC_FRAME_DURATION_MS + TEMP_ENTER_DELAY_MS;
+                    }
+                    closes_at = std::max(closes_at, sent_at + TEMP_SETTING_MODE_TIMEOUT_MS);
+                }
+
+                Key next_key = key(next, closes_at);
+                uint32_t next_cost = cost + step;
+                if (next_cost > bound) continue;
+
+                auto it = seen.find(next_key);
+                if (it != seen.end() && it->second <= next_cost) continue;
+                seen[next_key] = next_cost;
+                next_layer[next_key] = { next, next_cost };
+            }
+        }
+        layer = std::move(next_layer);
+    }
+    return best;
+}
+
+static std::vector<WoleixInternalState> all_states()
+{
+    std::vector<WoleixInternalState> states;
+    for (auto power : { WoleixPowerState::OFF, WoleixPowerState::ON })
+        for (auto mode : { WoleixMode::COOL, WoleixMode::DEHUM, WoleixMode::FAN })
+            for (float temp = WOLEIX_TEMP_MIN; temp <= WOLEIX_TEMP_MAX; temp += 1.0f)
+                for (auto fan : { WoleixFanSpeed::LOW, WoleixFanSpeed::HIGH })
+                    states.emplace_back(power, mode, temp, fan);
+    return states;
+}
+
+// State manager starting from an arbitrary state
+class TestWoleixStateManager : public WoleixStateManager
+{
+public:
+    explicit TestWoleixStateManager(const WoleixInternalState& state) { current_state_ = state; }
+};
+
+static std::vector<Type> move_to_types(const WoleixInternalState& from, const WoleixInternalState& to, WoleixInternalState& reached)
+{
+    TestWoleixStateManager manager(from);
+    std::vector<Type> types;
+    for (const auto& cmd : manager.move_to(to))
+    {
+        types.push_back(cmd.get_type());
+    }
+    reached = manager.get_state();
+    return types;
+}
+
+// ============================================================================
+// Test: Edge Costs
+// ============================================================================
+
+TEST(WoleixPathPlannerTest, RegularPressCostsFrameAndGap)
+{
+    EXPECT_EQ(WoleixPathPlanner::cost({ Type::MODE }), NEC_FRAME_DURATION_MS + INTER_COMMAND_DELAY_MS);
+}
+
+TEST(WoleixPathPlannerTest, FirstTemperaturePressPaysSettingModeEntry)
+{
+    std::vector<Type> three_up = { Type::TEMP_UP, Type::TEMP_UP, Type::TEMP_UP };
+
+    EXPECT_EQ(WoleixPathPlanner::cost(three_up),
+        WoleixPathPlanner::SETTING_MODE_ENTRY_COST_MS + 3 * WoleixPathPlanner::press_cost_ms(Type::TEMP_UP));
+    EXPECT_EQ(WoleixPathPlanner::cost(three_up, true), 3 * WoleixPathPlanner::press_cost_ms(Type::TEMP_UP));
+}
+
+// ============================================================================
+// Test: Setting Mode Window
+// ============================================================================
+
+TEST(WoleixPathPlannerTest, TemperaturePressesReuseOpenWindow)
+{
+    WoleixInternalState from(WoleixPowerState::ON, WoleixMode::COOL, 25.0f, WoleixFanSpeed::LOW);
+    WoleixInternalState to(WoleixPowerState::ON, WoleixMode::COOL, 27.0f, WoleixFanSpeed::LOW);
+
+    WoleixPlan plan = WoleixPathPlanner::plan(from, to, WoleixSettingModeWindow::open_for(1000));
+
+    EXPECT_EQ(plan.commands, (std::vector<Type>{ Type::TEMP_UP, Type::TEMP_UP }));
+    EXPECT_EQ(plan.cost_ms, 2 * WoleixPathPlanner::press_cost_ms(Type::TEMP_UP));
+}
+
+/**
+ * Test: A window closing within the guard margin is waited out, then reopened
+ */
+TEST(WoleixPathPlannerTest, WindowClosingWithinGuardIsWaitedOut)
+{
+    WoleixInternalState from(WoleixPowerState::ON, WoleixMode::COOL, 25.0f, WoleixFanSpeed::LOW);
+    WoleixInternalState to(WoleixPowerState::ON, WoleixMode::COOL, 24.0f, WoleixFanSpeed::LOW);
+    const uint32_t remaining = TEMP_SETTING_MODE_GUARD_MS - 1;
+
+    WoleixPlan plan = WoleixPathPlanner::plan(from, to, WoleixSettingModeWindow::open_for(remaining));
+
+    EXPECT_EQ(plan.commands, (std::vector<Type>{ Type::TEMP_DOWN }));
+    EXPECT_EQ(plan.cost_ms,
+        remaining + WoleixPathPlanner::SETTING_MODE_ENTRY_COST_MS + WoleixPathPlanner::press_cost_ms(Type::TEMP_DOWN));
+}
+
+/**
+ * Test: The window is judged at the time the first temperature press goes out
+ *
+ * From DEHUM, two MODE presses come first; the window has to last until
+ * they are through, plus the guard margin.
+ */
+TEST(WoleixPathPlannerTest, WindowIsJudgedWhenTemperaturePressGoesOut)
+{
+    WoleixInternalState from(WoleixPowerState::ON, WoleixMode::DEHUM, 25.0f, WoleixFanSpeed::LOW);
+    WoleixInternalState to(WoleixPowerState::ON, WoleixMode::COOL, 26.0f, WoleixFanSpeed::LOW);
+    const uint32_t modes = 2 * WoleixPathPlanner::press_cost_ms(Type::MODE);
+    const uint32_t up = WoleixPathPlanner::press_cost_ms(Type::TEMP_UP);
+
+    WoleixPlan lasting = WoleixPathPlanner::plan(from, to, WoleixSettingModeWindow::open_for(modes + TEMP_SETTING_MODE_GUARD_MS));
+    EXPECT_EQ(lasting.commands, (std::vector<Type>{ Type::MODE, Type::MODE, Type::TEMP_UP }));
+    EXPECT_EQ(lasting.cost_ms, modes + up);
+
+    WoleixPlan expiring = WoleixPathPlanner::plan(from, to, WoleixSettingModeWindow::open_for(modes + 10));
+    EXPECT_EQ(expiring.commands, lasting.commands);
+    EXPECT_EQ(expiring.cost_ms, modes + 10 + WoleixPathPlanner::SETTING_MODE_ENTRY_COST_MS + up);
+
+    WoleixPlan expired = WoleixPathPlanner::plan(from, to, WoleixSettingModeWindow::open_for(modes / 2));
+    EXPECT_EQ(expired.cost_ms, modes + WoleixPathPlanner::SETTING_MODE_ENTRY_COST_MS + up);
+}
+
+TEST(WoleixPathPlannerTest, WindowRebasesOnLaterStart)
+{
+    auto window = WoleixSettingModeWindow::open_for(1000);
+
+    EXPECT_EQ(window.after(400).closes_at_ms, 600u);
+    EXPECT_EQ(window.after(1200).closes_at_ms, 0u);
+    EXPECT_EQ(WoleixSettingModeWindow::unbounded().after(1200).closes_at_ms, WoleixSettingModeWindow::UNBOUNDED);
+
+    // A temperature press keeps it open from the time it goes out
+    window.extend(300);
+    EXPECT_EQ(window.closes_at_ms, 300 + TEMP_SETTING_MODE_TIMEOUT_MS);
+}
+
+/**
+ * Test: Plans into a window of any length are the cheapest, as confirmed by the oracle
+ *
+ * The oracle tracks the exact end of the window in every node, so this also
+ * checks that carrying it along the cheapest path loses nothing.
+ */
+TEST(WoleixPathPlannerTest, MatchesWindowOracle)
+{
+    const std::vector<WoleixInternalState> sources =
+    {
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 22.0f, WoleixFanSpeed::LOW),
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::DEHUM, 20.0f, WoleixFanSpeed::LOW),
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::FAN, 27.0f, WoleixFanSpeed::HIGH),
+    };
+    const std::vector<uint32_t> windows = { 0, 150, 400, 700, 2000 };
+
+    for (const auto& from : sources)
+    {
+        for (const auto& to : all_states())
+        {
+            for (uint32_t remaining : windows)
+            {
+                auto window = WoleixSettingModeWindow::open_for(remaining);
+                WoleixPlan plan = WoleixPathPlanner::plan(from, to, window);
+
+                ASSERT_EQ(plan.cost_ms, oracle_cost_in_window(from, to, remaining, plan.cost_ms));
+                ASSERT_EQ(plan.cost_ms, WoleixPathPlanner::cost(plan.commands, window));
+            }
+        }
+    }
+}
+
+// ============================================================================
+// Test: Planning
+// ============================================================================
+
+TEST(WoleixPathPlannerTest, EmptyPlanWhenTargetReached)
+{
+    WoleixInternalState state(WoleixPowerState::ON, WoleixMode::FAN, 22.0f, WoleixFanSpeed::HIGH);
+
+    WoleixPlan plan = WoleixPathPlanner::plan(state, state);
+
+    EXPECT_TRUE(plan.commands.empty());
+    EXPECT_EQ(plan.cost_ms, 0u);
+}
+
+TEST(WoleixPathPlannerTest, PlansFullTransition)
+{
+    WoleixInternalState from(WoleixPowerState::OFF, WoleixMode::DEHUM, 25.0f, WoleixFanSpeed::LOW);
+    WoleixInternalState to(WoleixPowerState::ON, WoleixMode::COOL, 22.0f, WoleixFanSpeed::LOW);
+
+    WoleixPlan plan = WoleixPathPlanner::plan(from, to);
+
+    std::vector<Type> expected =
+    {
+        Type::POWER, Type::MODE, Type::MODE, Type::TEMP_DOWN, Type::TEMP_DOWN, Type::TEMP_DOWN
+    };
+    EXPECT_EQ(plan.commands, expected);
+    EXPECT_EQ(plan.cost_ms, WoleixPathPlanner::cost(expected));
+    EXPECT_FLOAT_EQ(plan.state.temperature, 22.0f);
+    EXPECT_EQ(plan.state.mode, WoleixMode::COOL);
+}
+
+TEST(WoleixPathPlannerTest, ClampsAndRoundsTargetTemperature)
+{
+    WoleixInternalState from(WoleixPowerState::ON, WoleixMode::COOL, 25.0f, WoleixFanSpeed::LOW);
+
+    EXPECT_FLOAT_EQ(WoleixPathPlanner::plan(from, WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 35.0f, WoleixFanSpeed::LOW)).state.temperature, 30.0f);
+    EXPECT_FLOAT_EQ(WoleixPathPlanner::plan(from, WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 27.5f, WoleixFanSpeed::LOW)).state.temperature, 28.0f);
+}
+
+/**
+ * Test: The planner finds the cheapest plan, as confirmed by the BFS oracle
+ *
+ * All targets are checked from a set of representative starting states,
+ * with and without setting mode already active.
+ */
+TEST(WoleixPathPlannerTest, MatchesBruteForceOracle)
+{
+    const std::vector<WoleixInternalState> sources =
+    {
+        WoleixInternalState(),
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, WOLEIX_TEMP_MIN, WoleixFanSpeed::LOW),
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, WOLEIX_TEMP_MAX, WoleixFanSpeed::HIGH),
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::DEHUM, 20.0f, WoleixFanSpeed::LOW),
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::FAN, 27.0f, WoleixFanSpeed::HIGH),
+    };
+
+    for (const auto& from : sources)
+    {
+        for (const auto& to : all_states())
+        {
+            for (bool active : { false, true })
+            {
+                WoleixPlan plan = WoleixPathPlanner::plan(from, to, active);
+
+                ASSERT_EQ(plan.cost_ms, oracle_cost(from, to, active));
+                ASSERT_EQ(plan.cost_ms, WoleixPathPlanner::cost(plan.commands, active));
+                ASSERT_FALSE(WoleixStateManager::next_command(plan.state, WoleixPathPlanner::normalize(from, to)).has_value());
+            }
+        }
+    }
+}
+
+/**
+ * Test: The fixed move_to() order is never cheaper than the planner
+ *
+ * Over all pairs of whole-degree states, the planner reaches the same state
+ * as move_to(), at the same or lower cost.
+ */
+TEST(WoleixPathPlannerTest, NeverWorseThanMoveTo)
+{
+    const auto states = all_states();
+    for (const auto& from : states)
+    {
+        for (const auto& to : states)
+        {
+            WoleixInternalState reached;
+            auto fixed = move_to_types(from, to, reached);
+            WoleixPlan plan = WoleixPathPlanner::plan(from, to);
+
+            ASSERT_LE(plan.cost_ms, WoleixPathPlanner::cost(fixed));
+            ASSERT_TRUE(plan.state == reached);
+        }
+    }
+}
+
+/**
+ * Test: move_to() uses the planner when shortest-path planning is enabled
+ */
+TEST(WoleixPathPlannerTest, StateManagerUsesPlannerWhenEnabled)
+{
+    WoleixStateManager manager;
+    manager.set_shortest_path_planning(true);
+
+    const auto& commands = manager.move_to(WoleixInternalState(WoleixPowerState::ON, WoleixMode::FAN, 25.0f, WoleixFanSpeed::HIGH));
+
+    std::vector<Type> types;
+    for (const auto& cmd : commands) types.push_back(cmd.get_type());
+    EXPECT_EQ(types, (std::vector<Type>{ Type::POWER, Type::MODE, Type::MODE, Type::FAN_SPEED }));
+    EXPECT_EQ(manager.get_state().mode, WoleixMode::FAN);
+    EXPECT_EQ(manager.get_state().fan_speed, WoleixFanSpeed::HIGH);
+}
+
+// State manager reporting a setting mode window, like WoleixClimate does
+class WindowedStateManager : public TestWoleixStateManager
+{
+public:
+    using TestWoleixStateManager::TestWoleixStateManager;
+
+    WoleixSettingModeWindow setting_mode_window() const override
+    {
+        queries++;
+        return window;
+    }
+
+    WoleixSettingModeWindow window;
+    mutable int queries{0};
+};
+
+/**
+ * Test: move_to() asks for the setting mode window only when it plans by cost
+ */
+TEST(WoleixPathPlannerTest, StateManagerPlansIntoReportedWindow)
+{
+    const WoleixInternalState from(WoleixPowerState::ON, WoleixMode::COOL, 25.0f, WoleixFanSpeed::LOW);
+    const WoleixInternalState to(WoleixPowerState::ON, WoleixMode::COOL, 23.0f, WoleixFanSpeed::LOW);
+
+    WindowedStateManager fixed(from);
+    fixed.move_to(to);
+    EXPECT_EQ(fixed.queries, 0);
+
+    WindowedStateManager planned(from);
+    planned.set_shortest_path_planning(true);
+    planned.window = WoleixSettingModeWindow::open_for(3000);
+    EXPECT_EQ(planned.move_to(to).size(), 2u);
+    EXPECT_EQ(planned.queries, 1);
+}
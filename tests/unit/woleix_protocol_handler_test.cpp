@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <functional>
 
 #include "woleix_constants.h"
 #include "woleix_command.h"
@@ -24,13 +25,36 @@ public:
         uint16_t address;
         uint16_t command;
         uint32_t repeats;
+        uint32_t wait;
     };
     
     std::vector<TransmittedCommand> transmitted;
+    RawTimings last_timings;
     
-    void send_(const NECProtocol::ProtocolData& data, uint32_t repeats, uint32_t wait) override
+    void send_internal(uint32_t repeats, uint32_t wait) override
     {
-        transmitted.push_back({data.address, data.command, repeats});
+        // Decode the NEC frame from the raw timings: bit value is in the space length
+        const auto& timings = temp_.get_data();
+        last_timings = timings;
+        uint32_t word = 0;
+        for (size_t bit = 0; bit < 32; bit++)
+        {
+            if (-timings.at(3 + 2 * bit) > 1000) word |= 1u << bit;
+        }
+        transmitted.push_back({static_cast<uint16_t>(word & 0xFFFF), static_cast<uint16_t>(word >> 16), repeats, wait});
+        in_flight++;
+    }
+
+    // Non-blocking transmitter double: transmissions stay in flight until
+    // complete() reports their end, like remote_transmitter's on_complete
+    size_t in_flight{0};
+    std::function<void()> on_complete;
+
+    void complete()
+    {
+        if (in_flight == 0) return;
+        in_flight--;
+        if (on_complete) on_complete();
     }
     
     size_t transmit_count() const { return transmitted.size(); }
@@ -54,7 +78,7 @@ class MockWoleixProtocolHandler : public WoleixProtocolHandler
 {
 public:
     MockWoleixProtocolHandler(RemoteTransmitterBase* transmitter, MockWoleixCommandQueue* command_queue, MockScheduler* mock_scheduler)
-        : WoleixProtocolHandler(mock_scheduler->get_setter(), mock_scheduler->get_canceller())
+        : WoleixProtocolHandler(mock_scheduler)
     {
         set_transmitter(transmitter);
         setup(command_queue);
@@ -69,7 +93,21 @@ public:
         transmit_(cmd);
     }
 
+    void call_transmit_burst(const WoleixCommand& cmd, uint32_t presses)
+    {
+        transmit_burst_(cmd, presses);
+    }
+
     MOCK_METHOD(void, report, (const WoleixStatus&));
+
+    // Runs reported as transmitted, as (type, presses)
+    std::vector<std::pair<WoleixCommand::Type, uint32_t>> transmitted_runs;
+
+protected:
+    void on_commands_transmitted_(const WoleixCommand& command, uint32_t presses) override
+    {
+        transmitted_runs.emplace_back(command.get_type(), presses);
+    }
 };
 
 
@@ -107,7 +145,7 @@ protected:
     // Helper to process one command timeout
     void process_one()
     {
-        mock_scheduler->fire_timeout("proto_next_cmd");
+        mock_scheduler->fire_timeout(WoleixTimerId::NEXT_COMMAND);
     }
     
     // Helper to drain queue without triggering setting mode timeout
@@ -180,7 +218,7 @@ TEST_F(ProtocolHandlerTest, TempCommandEntersSettingMode)
     EXPECT_EQ(mock_transmitter->transmit_count(), 1);
     
     // Setting mode timeout should be scheduled
-    EXPECT_TRUE(mock_scheduler->has_timeout("proto_setting_mode"));
+    EXPECT_TRUE(mock_scheduler->has_timeout(WoleixTimerId::SETTING_MODE));
     
     // Command should still be in queue (will be sent again to actually change temp)
     EXPECT_FALSE(mock_command_queue->is_empty());
@@ -216,7 +254,7 @@ TEST_F(ProtocolHandlerTest, MultipleTempCommandsFollowNPlusOneRule)
     EXPECT_EQ(mock_transmitter->transmit_count(), 6);
     EXPECT_TRUE(mock_command_queue->is_empty());
     EXPECT_TRUE(mock_protocol_handler->is_in_setting_mode());
-    EXPECT_TRUE(mock_scheduler->has_timeout("proto_setting_mode"));
+    EXPECT_TRUE(mock_scheduler->has_timeout(WoleixTimerId::SETTING_MODE));
 }
 
 TEST_F(ProtocolHandlerTest, SettingModeTimeoutExitsSettingMode)
@@ -237,7 +275,7 @@ TEST_F(ProtocolHandlerTest, SettingModeTimeoutIsExtendedByEachTempCommand)
     enqueue(WoleixCommand::Type::TEMP_UP);
     process_one();  // Enter setting mode
     
-    uint64_t first_timeout = mock_scheduler->get_timeout_time("proto_setting_mode");
+    uint64_t first_timeout = mock_scheduler->get_timeout_time(WoleixTimerId::SETTING_MODE);
     
     // Advance 2 seconds
     mock_scheduler->advance_time(2000);
@@ -246,7 +284,7 @@ TEST_F(ProtocolHandlerTest, SettingModeTimeoutIsExtendedByEachTempCommand)
     process_one();
     
     // Timeout should have been extended
-    uint64_t second_timeout = mock_scheduler->get_timeout_time("proto_setting_mode");
+    uint64_t second_timeout = mock_scheduler->get_timeout_time(WoleixTimerId::SETTING_MODE);
     EXPECT_GT(second_timeout, first_timeout);
     
     // Should still be in setting mode
@@ -274,6 +312,133 @@ TEST_F(ProtocolHandlerTest, TempCommandAfterTimeoutReEntersSettingMode)
     EXPECT_EQ(mock_transmitter->transmit_count(), 4);  // 2 from before + 2 new (n+1)
 }
 
+TEST_F(ProtocolHandlerTest, ReportsSettingModeAndNextCommandTimes)
+{
+    EXPECT_EQ(mock_protocol_handler->setting_mode_remaining_ms(), 0u);
+
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    process_one();  // Enter setting mode
+
+    EXPECT_EQ(mock_protocol_handler->setting_mode_remaining_ms(), TEMP_SETTING_MODE_TIMEOUT_MS);
+    EXPECT_EQ(mock_protocol_handler->next_command_in_ms(), mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND));
+
+    mock_scheduler->advance_time(1000);
+
+    EXPECT_EQ(mock_protocol_handler->setting_mode_remaining_ms(), mock_scheduler->time_until(WoleixTimerId::SETTING_MODE));
+    EXPECT_EQ(mock_protocol_handler->next_command_in_ms(), 0u);
+}
+
+/**
+ * Test: A temperature command never goes out into a closing setting mode window
+ *
+ * Sent less than TEMP_SETTING_MODE_GUARD_MS before the unit leaves setting
+ * mode, it could arrive too late and only reopen it. The handler waits for
+ * the window to close and enters setting mode again instead.
+ */
+TEST_F(ProtocolHandlerTest, TempCommandWaitsOutExpiringSettingMode)
+{
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    drain_queue_fast();
+    ASSERT_EQ(mock_transmitter->transmit_count(), 2);
+
+    const uint32_t remaining = TEMP_SETTING_MODE_GUARD_MS - 1;
+    mock_scheduler->advance_time(mock_protocol_handler->setting_mode_remaining_ms() - remaining);
+    ASSERT_TRUE(mock_protocol_handler->is_in_setting_mode());
+
+    enqueue(WoleixCommand::Type::TEMP_DOWN);
+    process_one();
+
+    EXPECT_EQ(mock_transmitter->transmit_count(), 2);
+    EXPECT_FALSE(mock_protocol_handler->is_in_setting_mode());
+    EXPECT_FALSE(mock_scheduler->has_timeout(WoleixTimerId::SETTING_MODE));
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND), remaining);
+
+    drain_queue_fast();
+
+    // n+1 rule again
+    EXPECT_EQ(mock_transmitter->transmit_count(), 4);
+    EXPECT_TRUE(mock_protocol_handler->is_in_setting_mode());
+}
+
+TEST_F(ProtocolHandlerTest, SettingModeOutsideGuardIsReused)
+{
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    drain_queue_fast();
+
+    mock_scheduler->advance_time(mock_protocol_handler->setting_mode_remaining_ms() - TEMP_SETTING_MODE_GUARD_MS);
+
+    enqueue(WoleixCommand::Type::TEMP_DOWN);
+    process_one();
+
+    EXPECT_EQ(mock_transmitter->transmit_count(), 3);
+    EXPECT_TRUE(mock_protocol_handler->is_in_setting_mode());
+}
+
+/**
+ * Test: A temperature press on the remote is subject to the same quirk
+ *
+ * The first one only opens setting mode; after it, our own presses go out
+ * without an entry press.
+ */
+TEST_F(ProtocolHandlerTest, RemoteTemperaturePressOpensSettingMode)
+{
+    EXPECT_FALSE(mock_protocol_handler->on_remote_temperature_press());
+    EXPECT_TRUE(mock_protocol_handler->is_in_setting_mode());
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::SETTING_MODE), TEMP_SETTING_MODE_TIMEOUT_MS);
+
+    EXPECT_TRUE(mock_protocol_handler->on_remote_temperature_press());
+
+    enqueue(WoleixCommand::Type::TEMP_DOWN);
+    drain_queue_fast();
+    EXPECT_EQ(mock_transmitter->transmit_count(), 1);
+}
+
+// ============================================================================
+// Echo Tests
+// ============================================================================
+
+TEST_F(ProtocolHandlerTest, TransmittedFramesAreEchoes)
+{
+    EXPECT_FALSE(mock_protocol_handler->is_echo(MODE_NEC));
+
+    enqueue(WoleixCommand::Type::MODE);
+    process_one();
+    mock_scheduler->advance_time(NEC_FRAME_DURATION_MS);
+
+    EXPECT_FALSE(mock_protocol_handler->is_echo(POWER_NEC));
+    EXPECT_TRUE(mock_protocol_handler->is_echo(MODE_NEC));
+    EXPECT_FALSE(mock_protocol_handler->is_echo(MODE_NEC));
+}
+
+TEST_F(ProtocolHandlerTest, SettingModeEntryPressIsAnEcho)
+{
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    drain_queue_fast();
+
+    EXPECT_TRUE(mock_protocol_handler->is_echo(TEMP_UP_NEC));
+    EXPECT_TRUE(mock_protocol_handler->is_echo(TEMP_UP_NEC));
+    EXPECT_FALSE(mock_protocol_handler->is_echo(TEMP_UP_NEC));
+}
+
+TEST_F(ProtocolHandlerTest, EchoesOfBurstFramesAreExpectedUntilTheLastOne)
+{
+    mock_protocol_handler->set_max_burst_presses(3);
+    for (int i = 0; i < 3; i++) enqueue(WoleixCommand::Type::FAN_SPEED);
+    process_one();
+
+    mock_scheduler->advance_time(2 * command_gap_ms(SPEED_NEC) + ECHO_WINDOW_MS);
+    EXPECT_TRUE(mock_protocol_handler->is_echo(SPEED_NEC));
+}
+
+TEST_F(ProtocolHandlerTest, LateFramesAreNotEchoes)
+{
+    enqueue(WoleixCommand::Type::POWER);
+    process_one();
+
+    mock_scheduler->advance_time(ECHO_WINDOW_MS + 1);
+    EXPECT_FALSE(mock_protocol_handler->is_echo(POWER_NEC));
+}
+
 // ============================================================================
 // Mixed Command Sequence Tests
 // ============================================================================
@@ -352,10 +517,10 @@ TEST_F(ProtocolHandlerTest, CommandDelaysAreRespected)
     EXPECT_EQ(mock_transmitter->transmit_count(), 1);
     
     // Next command should be scheduled with inter-command delay
-    EXPECT_TRUE(mock_scheduler->has_timeout("proto_next_cmd"));
+    EXPECT_TRUE(mock_scheduler->has_timeout(WoleixTimerId::NEXT_COMMAND));
     
     // The second command shouldn't fire until the delay passes
-    uint32_t remaining = mock_scheduler->time_until("proto_next_cmd");
+    uint32_t remaining = mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND);
     EXPECT_GT(remaining, 0);  // There should be some delay
 }
 
@@ -370,7 +535,7 @@ TEST_F(ProtocolHandlerTest, SettingModeEnterDelayIsRespected)
     
     // The next command timeout should have the enter delay
     // (TEMP_ENTER_DELAY_MS = 150ms in protocol handler)
-    EXPECT_TRUE(mock_scheduler->has_timeout("proto_next_cmd"));
+    EXPECT_TRUE(mock_scheduler->has_timeout(WoleixTimerId::NEXT_COMMAND));
 }
 
 // ============================================================================
@@ -435,6 +600,349 @@ TEST_F(ProtocolHandlerTest, MixedTempUpAndDown)
     EXPECT_EQ(mock_transmitter->count_type(WoleixCommand::Type::TEMP_DOWN), 1);
 }
 
+// ============================================================================
+// Speculative Setting Mode Tests
+// ============================================================================
+
+TEST_F(ProtocolHandlerTest, PreEnterSettingModeSendsEntryPress)
+{
+    EXPECT_TRUE(mock_protocol_handler->pre_enter_setting_mode());
+
+    EXPECT_EQ(mock_transmitter->transmit_count(), 1);
+    EXPECT_TRUE(mock_protocol_handler->is_in_setting_mode());
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND), TEMP_ENTER_DELAY_MS);
+    EXPECT_TRUE(mock_scheduler->has_timeout(WoleixTimerId::SETTING_MODE));
+
+    // The following temperature command changes the temperature directly
+    enqueue(WoleixCommand::Type::TEMP_DOWN);
+    drain_queue_fast();
+
+    EXPECT_EQ(mock_transmitter->transmit_count(), 2);
+    EXPECT_EQ(mock_transmitter->count_type(WoleixCommand::Type::TEMP_DOWN), 1);
+}
+
+TEST_F(ProtocolHandlerTest, PreEnterSettingModeSkippedWhileBusy)
+{
+    enqueue(WoleixCommand::Type::POWER);
+    process_one();
+
+    EXPECT_FALSE(mock_protocol_handler->pre_enter_setting_mode());
+    EXPECT_EQ(mock_transmitter->transmit_count(), 1);
+}
+
+TEST_F(ProtocolHandlerTest, PreEnterSettingModeSkippedWhenAlreadyActive)
+{
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    drain_queue_fast();
+    process_one();  // Queue empty, handler idle again
+    size_t sent = mock_transmitter->transmit_count();
+
+    EXPECT_FALSE(mock_protocol_handler->pre_enter_setting_mode());
+    EXPECT_EQ(mock_transmitter->transmit_count(), sent);
+}
+
+TEST_F(ProtocolHandlerTest, CommandEnqueuedDuringGapWaitsForGap)
+{
+    enqueue(WoleixCommand::Type::MODE);
+    process_one();
+    enqueue(WoleixCommand::Type::POWER);
+
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND), command_gap_ms(MODE_NEC));
+}
+
+// ============================================================================
+// Multi-Send Burst Tests
+// ============================================================================
+
+TEST_F(ProtocolHandlerTest, BurstsAreDisabledByDefault)
+{
+    enqueue(WoleixCommand::Type::MODE);
+    enqueue(WoleixCommand::Type::MODE);
+
+    drain_queue_fast();
+
+    ASSERT_EQ(mock_transmitter->transmit_count(), 2);
+    EXPECT_EQ(mock_transmitter->transmitted.at(0).repeats, 1);
+    EXPECT_EQ(mock_transmitter->transmitted.at(1).repeats, 1);
+}
+
+TEST_F(ProtocolHandlerTest, MergesTempRunIntoSingleTransmit)
+{
+    mock_protocol_handler->set_max_burst_presses(BURST_MAX_PRESSES);
+    for (int i = 0; i < 4; i++) enqueue(WoleixCommand::Type::TEMP_UP);
+
+    process_one();  // Enter setting mode, not merged
+    EXPECT_EQ(mock_transmitter->transmit_count(), 1);
+    EXPECT_EQ(mock_command_queue->count_command(WoleixCommand::Type::TEMP_UP), 4);
+
+    process_one();  // All four presses in one call
+    ASSERT_EQ(mock_transmitter->transmit_count(), 2);
+    EXPECT_EQ(mock_transmitter->transmitted.at(1).repeats, 4);
+    EXPECT_EQ(mock_transmitter->transmitted.at(1).wait, burst_send_wait_us(TEMP_UP_NEC));
+    EXPECT_TRUE(mock_command_queue->is_empty());
+
+    // Follow-up timers account for the frames still being sent
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND), 4 * command_gap_ms(TEMP_UP_NEC));
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::SETTING_MODE), TEMP_SETTING_MODE_TIMEOUT_MS + 3 * command_gap_ms(TEMP_UP_NEC));
+}
+
+TEST_F(ProtocolHandlerTest, BurstIsLimitedToMaxPresses)
+{
+    mock_protocol_handler->set_max_burst_presses(2);
+    for (int i = 0; i < 3; i++) enqueue(WoleixCommand::Type::MODE);
+
+    drain_queue_fast();
+
+    ASSERT_EQ(mock_transmitter->transmit_count(), 2);
+    EXPECT_EQ(mock_transmitter->transmitted.at(0).repeats, 2);
+    EXPECT_EQ(mock_transmitter->transmitted.at(1).repeats, 1);
+}
+
+TEST_F(ProtocolHandlerTest, BurstStopsAtDifferentCommand)
+{
+    mock_protocol_handler->set_max_burst_presses(4);
+    enqueue(WoleixCommand::Type::MODE);
+    enqueue(WoleixCommand::Type::MODE);
+    enqueue(WoleixCommand::Type::FAN_SPEED);
+    enqueue(WoleixCommand::Type::MODE);
+
+    drain_queue_fast();
+
+    ASSERT_EQ(mock_transmitter->transmit_count(), 3);
+    EXPECT_EQ(mock_transmitter->transmitted.at(0).repeats, 2);
+    EXPECT_TRUE(mock_transmitter->transmitted.at(1).command == static_cast<uint16_t>(WoleixCommand::Type::FAN_SPEED));
+    EXPECT_EQ(mock_transmitter->transmitted.at(2).repeats, 1);
+}
+
+/**
+ * Test: Transmitted runs are reported, the setting mode entry press is not
+ */
+TEST_F(ProtocolHandlerTest, ReportsTransmittedRuns)
+{
+    mock_protocol_handler->set_max_burst_presses(4);
+    enqueue(WoleixCommand::Type::MODE);
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    enqueue(WoleixCommand::Type::TEMP_UP);
+
+    drain_queue_fast();
+
+    using Run = std::pair<WoleixCommand::Type, uint32_t>;
+    EXPECT_EQ(mock_protocol_handler->transmitted_runs,
+        (std::vector<Run>{ { WoleixCommand::Type::MODE, 1 }, { WoleixCommand::Type::TEMP_UP, 3 } }));
+}
+
+/**
+ * Test: Frames, airtime and setting mode use are counted in the metrics
+ */
+TEST_F(ProtocolHandlerTest, RecordsFramesAndSettingModeUse)
+{
+    mock_protocol_handler->set_max_burst_presses(4);
+    enqueue(WoleixCommand::Type::MODE);
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    drain_queue_fast();
+
+    enqueue(WoleixCommand::Type::TEMP_DOWN);
+    drain_queue_fast();
+
+    // MODE, entry press, burst of three, TEMP_DOWN
+    WoleixMetricsSnapshot snapshot = mock_protocol_handler->get_metrics().snapshot();
+    EXPECT_EQ(snapshot.commands_transmitted, 6u);
+    EXPECT_EQ(snapshot.airtime_ms, 6 * NEC_FRAME_DURATION_MS);
+    EXPECT_EQ(snapshot.setting_mode_entries, 1u);
+    EXPECT_EQ(snapshot.setting_mode_reuses, 2u);
+}
+
+TEST_F(ProtocolHandlerTest, PreEnterSettingModeCountsAsEntry)
+{
+    EXPECT_TRUE(mock_protocol_handler->pre_enter_setting_mode());
+
+    EXPECT_EQ(mock_protocol_handler->get_metrics().snapshot().setting_mode_entries, 1u);
+    EXPECT_EQ(mock_protocol_handler->get_metrics().snapshot().commands_transmitted, 1u);
+}
+
+TEST_F(ProtocolHandlerTest, CommandsWithRepeatCountAreNotMerged)
+{
+    mock_protocol_handler->set_max_burst_presses(4);
+    enqueue(WoleixCommand::Type::POWER, 3);
+    enqueue(WoleixCommand::Type::POWER, 3);
+
+    drain_queue_fast();
+
+    ASSERT_EQ(mock_transmitter->transmit_count(), 2);
+    EXPECT_EQ(mock_transmitter->transmitted.at(0).repeats, 3);
+    EXPECT_EQ(mock_transmitter->transmitted.at(0).wait, 0);
+}
+
+TEST_F(ProtocolHandlerTest, BurstWithoutTransmitterReportsError)
+{
+    mock_protocol_handler->set_transmitter(nullptr);
+
+    EXPECT_CALL(*mock_protocol_handler, report(_)).Times(1);
+    mock_protocol_handler->call_transmit_burst(WoleixCommand(WoleixCommand::Type::TEMP_UP, ADDRESS_NEC), 3);
+}
+
+// ============================================================================
+// Transmit Complete Tests
+// ============================================================================
+
+class TransmitCompleteTest : public ProtocolHandlerTest
+{
+protected:
+    void SetUp() override
+    {
+        ProtocolHandlerTest::SetUp();
+        mock_protocol_handler->set_wait_for_transmit_complete(true);
+        mock_transmitter->on_complete = [this]() { mock_protocol_handler->on_transmit_complete(); };
+    }
+};
+
+TEST_F(TransmitCompleteTest, NextCommandWaitsForEndOfFrame)
+{
+    enqueue(WoleixCommand::Type::POWER);
+    enqueue(WoleixCommand::Type::MODE);
+
+    process_one();
+    EXPECT_EQ(mock_transmitter->in_flight, 1u);
+
+    // Only the fallback is pending while the frame is on air
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND), command_gap_ms(POWER_NEC) + NEC_FRAME_DURATION_MS);
+
+    // After the frame, only the quiet gap remains
+    mock_scheduler->advance_time(50);
+    mock_transmitter->complete();
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND), command_gap_ms(POWER_NEC) - NEC_FRAME_DURATION_MS);
+
+    mock_scheduler->advance_time(command_gap_ms(POWER_NEC) - NEC_FRAME_DURATION_MS);
+    EXPECT_TRUE(mock_transmitter->last_was(WoleixCommand::Type::MODE));
+}
+
+TEST_F(TransmitCompleteTest, SettingModeEntryWaitsForEndOfFrame)
+{
+    enqueue(WoleixCommand::Type::TEMP_UP);
+
+    process_one();
+    mock_transmitter->complete();
+
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND), TEMP_ENTER_DELAY_MS - NEC_FRAME_DURATION_MS);
+}
+
+TEST_F(TransmitCompleteTest, BurstWaitsForEndOfLastFrame)
+{
+    mock_protocol_handler->set_max_burst_presses(3);
+    enqueue(WoleixCommand::Type::MODE);
+    enqueue(WoleixCommand::Type::MODE);
+    enqueue(WoleixCommand::Type::MODE);
+    enqueue(WoleixCommand::Type::POWER);
+
+    process_one();
+    EXPECT_EQ(mock_transmitter->transmit_count(), 1u);
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND),
+        3 * command_gap_ms(MODE_NEC) + NEC_FRAME_DURATION_MS);
+
+    mock_transmitter->complete();
+    EXPECT_EQ(mock_scheduler->time_until(WoleixTimerId::NEXT_COMMAND), command_gap_ms(MODE_NEC) - NEC_FRAME_DURATION_MS);
+}
+
+/**
+ * Test: Without the signal, the queue keeps moving and a warning is reported
+ */
+TEST_F(TransmitCompleteTest, MissingSignalFallsBackAndWarns)
+{
+    enqueue(WoleixCommand::Type::POWER);
+    enqueue(WoleixCommand::Type::MODE);
+
+    EXPECT_CALL(*mock_protocol_handler, report(_))
+        .WillOnce(Invoke([](const WoleixStatus& status)
+        {
+            EXPECT_EQ(status.get_severity(), WoleixStatus::Severity::WX_SEVERITY_WARNING);
+            EXPECT_EQ(status.get_category(), WoleixCategory::ProtocolHandler::WX_CATEGORY_TRANSMIT_COMPLETE_MISSING);
+        }));
+
+    process_one();
+    mock_scheduler->advance_time(command_gap_ms(POWER_NEC) + NEC_FRAME_DURATION_MS);
+    EXPECT_TRUE(mock_transmitter->last_was(WoleixCommand::Type::MODE));
+}
+
+TEST_F(TransmitCompleteTest, SignalIsIgnoredWhenIdle)
+{
+    mock_protocol_handler->on_transmit_complete();
+
+    EXPECT_FALSE(mock_scheduler->has_timeout(WoleixTimerId::NEXT_COMMAND));
+}
+
+// ============================================================================
+// Pulse Cache Tests
+// ============================================================================
+
+TEST_F(ProtocolHandlerTest, TransmitsPreEncodedFrame)
+{
+    enqueue(WoleixCommand::Type::MODE);
+    process_one();
+
+    RawTimings expected;
+    WoleixNecPulseCache::encode(ADDRESS_NEC, MODE_NEC, expected);
+    EXPECT_EQ(mock_transmitter->last_timings, expected);
+    EXPECT_EQ(mock_transmitter->get_temp().get_carrier_frequency(), WoleixNecPulseCache::CARRIER_FREQUENCY_HZ);
+}
+
+TEST_F(ProtocolHandlerTest, FallsBackToEncoderForUncachedAddress)
+{
+    enqueue(WoleixCommand(WoleixCommand::Type::POWER, 0x1234));
+    process_one();
+
+    ASSERT_EQ(mock_transmitter->transmit_count(), 1);
+    EXPECT_EQ(mock_transmitter->transmitted.at(0).address, 0x1234);
+    EXPECT_EQ(mock_transmitter->transmitted.at(0).command, POWER_NEC);
+}
+
+// ============================================================================
+// Timer Callback Tests
+// ============================================================================
+
+TEST(WoleixTimerCallbackTest, InvokesStoredCallable)
+{
+    int calls = 0;
+    int* counter = &calls;
+    WoleixTimerCallback callback([counter]() { (*counter)++; });
+
+    WoleixTimerCallback copy = callback;
+    copy();
+    callback();
+
+    EXPECT_TRUE(static_cast<bool>(callback));
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(WoleixTimerCallbackTest, EmptyCallbackDoesNothing)
+{
+    WoleixTimerCallback callback;
+
+    EXPECT_FALSE(static_cast<bool>(callback));
+    callback();
+}
+
+TEST(WoleixTimerCallbackTest, StoresCallableInline)
+{
+    // Fixed size and trivially copyable: passing it by value never allocates
+    static_assert(std::is_trivially_copyable_v<WoleixTimerCallback>);
+    static_assert(sizeof(WoleixTimerCallback) <= WoleixTimerCallback::STORAGE_SIZE + sizeof(void*));
+    SUCCEED();
+}
+
+TEST_F(ProtocolHandlerTest, TimersAreKeyedById)
+{
+    enqueue(WoleixCommand::Type::TEMP_UP);
+    process_one();
+
+    auto ids = mock_scheduler->pending_ids();
+    EXPECT_EQ(ids.size(), 2u);
+    EXPECT_TRUE(mock_scheduler->has_timeout(WoleixTimerId::NEXT_COMMAND));
+    EXPECT_TRUE(mock_scheduler->has_timeout(WoleixTimerId::SETTING_MODE));
+}
+
 // ============================================================================
 // Main
 // ============================================================================
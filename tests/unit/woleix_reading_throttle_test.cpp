@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <optional>
+
+#include "woleix_reading_throttle.h"
+
+using namespace esphome::climate_ir_woleix;
+
+static constexpr WoleixReading TEMPERATURE = WoleixReading::CURRENT_TEMPERATURE;
+static constexpr WoleixReading HUMIDITY = WoleixReading::CURRENT_HUMIDITY;
+
+// ============================================================================
+// Test: Default policy
+// ============================================================================
+
+TEST(WoleixReadingThrottleTest, DefaultPublishesEveryReading)
+{
+    WoleixReadingThrottle throttle;
+
+    for (uint32_t now = 0; now < 5; now++)
+    {
+        EXPECT_EQ(throttle.offer(HUMIDITY, 50.0f, now), std::optional<uint32_t>(0));
+        throttle.published(now);
+    }
+}
+
+// ============================================================================
+// Test: Configured policy
+// ============================================================================
+
+TEST(WoleixReadingThrottleTest, FirstReadingIsPublishedRightAway)
+{
+    WoleixReadingThrottle throttle;
+    throttle.configure(10000, 0);
+    throttle.set_delta(TEMPERATURE, 0.5f);
+
+    EXPECT_EQ(throttle.offer(TEMPERATURE, 21.0f, 1234), std::optional<uint32_t>(0));
+}
+
+TEST(WoleixReadingThrottleTest, SmallChangesAreSkipped)
+{
+    WoleixReadingThrottle throttle;
+    throttle.configure(0, 0);
+    throttle.set_delta(TEMPERATURE, 0.5f);
+
+    throttle.offer(TEMPERATURE, 21.0f, 0);
+    throttle.published(0);
+
+    EXPECT_FALSE(throttle.offer(TEMPERATURE, 21.2f, 100).has_value());
+    EXPECT_FALSE(throttle.offer(TEMPERATURE, 20.6f, 200).has_value());
+    EXPECT_EQ(throttle.offer(TEMPERATURE, 21.5f, 300), std::optional<uint32_t>(0));
+    EXPECT_TRUE(throttle.is_pending());
+}
+
+TEST(WoleixReadingThrottleTest, SignificantChangeWaitsForMinimumInterval)
+{
+    WoleixReadingThrottle throttle;
+    throttle.configure(10000, 0);
+    throttle.set_delta(HUMIDITY, 1.0f);
+
+    throttle.offer(HUMIDITY, 50.0f, 0);
+    throttle.published(0);
+
+    EXPECT_EQ(throttle.offer(HUMIDITY, 55.0f, 4000), std::optional<uint32_t>(6000));
+    EXPECT_EQ(throttle.offer(HUMIDITY, 56.0f, 9000), std::optional<uint32_t>(1000));
+    EXPECT_EQ(throttle.offer(HUMIDITY, 56.0f, 10000), std::optional<uint32_t>(0));
+}
+
+/**
+ * Test: Once a publication is pending, every reading joins it
+ */
+TEST(WoleixReadingThrottleTest, PendingPublicationCoalescesBothReadings)
+{
+    WoleixReadingThrottle throttle;
+    throttle.configure(10000, 0);
+    throttle.set_delta(TEMPERATURE, 0.5f);
+    throttle.set_delta(HUMIDITY, 1.0f);
+
+    throttle.offer(TEMPERATURE, 21.0f, 0);
+    throttle.offer(HUMIDITY, 50.0f, 0);
+    throttle.published(0);
+
+    EXPECT_EQ(throttle.offer(TEMPERATURE, 22.0f, 2000), std::optional<uint32_t>(8000));
+    EXPECT_EQ(throttle.offer(HUMIDITY, 50.2f, 3000), std::optional<uint32_t>(7000));
+    throttle.published(10000);
+
+    // The humidity published with the temperature is the new reference
+    EXPECT_FALSE(throttle.offer(HUMIDITY, 50.9f, 20000).has_value());
+    EXPECT_EQ(throttle.offer(HUMIDITY, 51.2f, 20000), std::optional<uint32_t>(0));
+}
+
+TEST(WoleixReadingThrottleTest, StaleStateIsPublishedAnyway)
+{
+    WoleixReadingThrottle throttle;
+    throttle.configure(1000, 60000);
+    throttle.set_delta(TEMPERATURE, 0.5f);
+
+    throttle.offer(TEMPERATURE, 21.0f, 0);
+    throttle.published(0);
+
+    EXPECT_FALSE(throttle.offer(TEMPERATURE, 21.1f, 59999).has_value());
+    EXPECT_EQ(throttle.offer(TEMPERATURE, 21.1f, 60000), std::optional<uint32_t>(0));
+}
+
+TEST(WoleixReadingThrottleTest, HandlesClockWrapAround)
+{
+    WoleixReadingThrottle throttle;
+    throttle.configure(10000, 0);
+    throttle.set_delta(TEMPERATURE, 0.5f);
+
+    throttle.offer(TEMPERATURE, 21.0f, 0xFFFFF000u);
+    throttle.published(0xFFFFF000u);
+
+    // 4096 ms elapsed across the wrap
+    EXPECT_EQ(throttle.offer(TEMPERATURE, 23.0f, 0), std::optional<uint32_t>(10000 - 4096));
+}
@@ -0,0 +1,280 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "woleix_constants.h"
+#include "woleix_command.h"
+#include "woleix_spsc_queue.h"
+
+using namespace esphome::climate_ir_woleix;
+
+using Type = WoleixCommand::Type;
+
+// The stress tests are meant to run under ThreadSanitizer (-DENABLE_TSAN=ON),
+// which reports any access the acquire/release protocol fails to order.
+static constexpr uint32_t STRESS_ITEMS = 200000;
+
+class MockWoleixCommandQueueConsumer : public WoleixCommandQueueConsumer
+{
+public:
+    MOCK_METHOD(void, on_command_enqueued, (), (override));
+};
+
+// ============================================================================
+// Test: Single-threaded behaviour
+// ============================================================================
+
+TEST(WoleixSpscRingBufferTest, KeepsFifoOrderAcrossWrapAround)
+{
+    WoleixSpscRingBuffer<uint32_t, 4> buffer;
+
+    for (uint32_t round = 0; round < 10; round++)
+    {
+        EXPECT_TRUE(buffer.push(round * 2));
+        EXPECT_TRUE(buffer.push(round * 2 + 1));
+        EXPECT_EQ(buffer.size(), 2u);
+
+        ASSERT_NE(buffer.front(), nullptr);
+        EXPECT_EQ(*buffer.front(), round * 2);
+        EXPECT_TRUE(buffer.pop());
+        EXPECT_EQ(*buffer.front(), round * 2 + 1);
+        EXPECT_TRUE(buffer.pop());
+        EXPECT_TRUE(buffer.empty());
+    }
+}
+
+TEST(WoleixSpscRingBufferTest, UsesAllSlotsAndRejectsWhenFull)
+{
+    WoleixSpscRingBuffer<uint32_t, 4> buffer;
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(buffer.push(i));
+    }
+    EXPECT_FALSE(buffer.push(4));
+    EXPECT_EQ(buffer.size(), 4u);
+
+    EXPECT_TRUE(buffer.pop());
+    EXPECT_TRUE(buffer.push(4));
+    EXPECT_EQ(*buffer.front(), 1u);
+}
+
+TEST(WoleixSpscRingBufferTest, EmptyBufferHasNothingToPop)
+{
+    WoleixSpscRingBuffer<uint32_t, 2> buffer;
+
+    EXPECT_EQ(buffer.front(), nullptr);
+    EXPECT_FALSE(buffer.pop());
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(WoleixSpscCommandQueueTest, ActsAsCommandSource)
+{
+    WoleixSpscCommandQueue<4> queue;
+    WoleixCommandSource& source = queue;
+
+    EXPECT_TRUE(source.is_empty());
+    EXPECT_FALSE(source.get().has_value());
+    EXPECT_FALSE(source.dequeue());
+
+    EXPECT_TRUE(queue.enqueue(WoleixCommand(Type::POWER, ADDRESS_NEC)));
+    EXPECT_TRUE(queue.enqueue(WoleixCommand(Type::MODE, ADDRESS_NEC)));
+
+    EXPECT_EQ(source.get()->get_type(), Type::POWER);
+    EXPECT_TRUE(source.dequeue());
+    EXPECT_EQ(source.get()->get_type(), Type::MODE);
+    EXPECT_TRUE(source.dequeue());
+    EXPECT_TRUE(source.is_empty());
+}
+
+TEST(WoleixSpscCommandQueueTest, EnqueueFailsWhenFull)
+{
+    WoleixSpscCommandQueue<2> queue;
+
+    EXPECT_TRUE(queue.enqueue(WoleixCommand(Type::TEMP_UP, ADDRESS_NEC)));
+    EXPECT_TRUE(queue.enqueue(WoleixCommand(Type::TEMP_UP, ADDRESS_NEC)));
+    EXPECT_FALSE(queue.enqueue(WoleixCommand(Type::TEMP_UP, ADDRESS_NEC)));
+    EXPECT_EQ(queue.length(), queue.max_capacity());
+}
+
+/**
+ * Test: poll() notifies once per transition from drained to non-empty
+ */
+TEST(WoleixSpscCommandQueueTest, PollNotifiesConsumersOncePerBatch)
+{
+    WoleixSpscCommandQueue<4> queue;
+    MockWoleixCommandQueueConsumer consumer;
+    queue.register_consumer(&consumer);
+
+    EXPECT_CALL(consumer, on_command_enqueued()).Times(0);
+    EXPECT_FALSE(queue.poll());
+    ::testing::Mock::VerifyAndClearExpectations(&consumer);
+
+    EXPECT_CALL(consumer, on_command_enqueued()).Times(1);
+    queue.enqueue(WoleixCommand(Type::POWER, ADDRESS_NEC));
+    EXPECT_TRUE(queue.poll());
+    queue.enqueue(WoleixCommand(Type::MODE, ADDRESS_NEC));
+    EXPECT_FALSE(queue.poll());
+    ::testing::Mock::VerifyAndClearExpectations(&consumer);
+
+    // Still busy with the batch: no notification
+    EXPECT_CALL(consumer, on_command_enqueued()).Times(0);
+    queue.dequeue();
+    EXPECT_FALSE(queue.poll());
+    ::testing::Mock::VerifyAndClearExpectations(&consumer);
+
+    // Drained: the next command is announced again
+    EXPECT_CALL(consumer, on_command_enqueued()).Times(1);
+    queue.dequeue();
+    queue.enqueue(WoleixCommand(Type::FAN_SPEED, ADDRESS_NEC));
+    EXPECT_TRUE(queue.poll());
+}
+
+// ============================================================================
+// Test: Producer/consumer stress
+// ============================================================================
+
+/**
+ * Test: Every value crosses the buffer exactly once and in order
+ *
+ * A small capacity keeps the buffer alternating between full and empty,
+ * exercising both index checks from both sides.
+ */
+TEST(WoleixSpscRingBufferTest, StressPreservesOrderAcrossThreads)
+{
+    WoleixSpscRingBuffer<uint32_t, 8> buffer;
+
+    std::thread producer([&buffer]()
+    {
+        for (uint32_t i = 0; i < STRESS_ITEMS; i++)
+        {
+            while (!buffer.push(i)) std::this_thread::yield();
+        }
+    });
+
+    uint32_t expected = 0;
+    bool in_order = true;
+    std::thread consumer([&]()
+    {
+        while (expected < STRESS_ITEMS)
+        {
+            const uint32_t* value = buffer.front();
+            if (!value)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            in_order = in_order && *value == expected;
+            buffer.pop();
+            expected++;
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    EXPECT_TRUE(in_order);
+    EXPECT_EQ(expected, STRESS_ITEMS);
+    EXPECT_TRUE(buffer.empty());
+}
+
+/**
+ * Test: Commands handed over by a producer task arrive intact
+ *
+ * The sequence number travels in the repeat count, so a torn or stale slot
+ * shows up as a gap, and the type/address pair catches partial writes.
+ */
+TEST(WoleixSpscCommandQueueTest, StressHandsOverCommandsIntact)
+{
+    static const Type TYPES[] = { Type::POWER, Type::MODE, Type::TEMP_UP, Type::TEMP_DOWN, Type::FAN_SPEED };
+
+    WoleixSpscCommandQueue<16> queue;
+
+    std::thread producer([&queue]()
+    {
+        for (uint32_t i = 0; i < STRESS_ITEMS; i++)
+        {
+            WoleixCommand command(TYPES[i % 5], static_cast<uint16_t>(ADDRESS_NEC + i % 5), 0, i);
+            while (!queue.enqueue(command)) std::this_thread::yield();
+        }
+    });
+
+    uint32_t received = 0;
+    bool intact = true;
+    std::thread consumer([&]()
+    {
+        while (received < STRESS_ITEMS)
+        {
+            auto command = queue.get();
+            if (!command)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            intact = intact
+                && command->get_repeat_count() == received
+                && command->get_type() == TYPES[received % 5]
+                && command->get_address() == ADDRESS_NEC + received % 5;
+            queue.dequeue();
+            received++;
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    EXPECT_TRUE(intact);
+    EXPECT_EQ(received, STRESS_ITEMS);
+    EXPECT_TRUE(queue.is_empty());
+}
+
+/**
+ * Test: Several independent producer/consumer pairs run side by side
+ */
+TEST(WoleixSpscCommandQueueTest, StressIndependentPairs)
+{
+    static constexpr size_t PAIRS = 4;
+    static constexpr uint32_t ITEMS = STRESS_ITEMS / PAIRS;
+
+    std::vector<WoleixSpscCommandQueue<4>> queues(PAIRS);
+    std::vector<uint32_t> received(PAIRS, 0);
+    std::vector<char> in_order(PAIRS, true);
+    std::vector<std::thread> threads;
+
+    for (size_t p = 0; p < PAIRS; p++)
+    {
+        threads.emplace_back([&queue = queues[p]]()
+        {
+            for (uint32_t i = 0; i < ITEMS; i++)
+            {
+                while (!queue.enqueue(WoleixCommand(Type::TEMP_UP, ADDRESS_NEC, 0, i))) std::this_thread::yield();
+            }
+        });
+        threads.emplace_back([&queue = queues[p], &count = received[p], &ok = in_order[p]]()
+        {
+            while (count < ITEMS)
+            {
+                auto command = queue.get();
+                if (!command)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                ok = ok && command->get_repeat_count() == count;
+                queue.dequeue();
+                count++;
+            }
+        });
+    }
+
+    for (auto& thread : threads) thread.join();
+
+    for (size_t p = 0; p < PAIRS; p++)
+    {
+        EXPECT_EQ(received[p], ITEMS);
+        EXPECT_TRUE(in_order[p]);
+        EXPECT_TRUE(queues[p].is_empty());
+    }
+}
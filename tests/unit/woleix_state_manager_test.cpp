@@ -49,6 +49,26 @@ public:
 
 };
 
+// Sink recording the commands it is given
+class RecordingSink : public WoleixCommandSink
+{
+public:
+    bool emit(const WoleixCommand& command) override
+    {
+        types.push_back(command.get_type());
+        return true;
+    }
+    bool commit() override
+    {
+        commits++;
+        return accept;
+    }
+
+    std::vector<WoleixCommand::Type> types;
+    int commits{0};
+    bool accept{true};
+};
+
 // Test fixture for WoleixStateManager
 class WoleixStateManagerTest : public testing::Test
 {
@@ -991,7 +1011,8 @@ TEST_F(WoleixStateManagerTest, TransitionToInvalidModeHandling)
         {
             EXPECT_EQ(s.get_severity(), WoleixStatus::Severity::WX_SEVERITY_ERROR);
             EXPECT_EQ(s.get_category(), WoleixCategory::StateManager::WX_CATEGORY_INVALID_MODE);
-            EXPECT_THAT(s.get_message().c_str(), testing::HasSubstr(std::to_string(mode_val)));
+            char text[WoleixStatus::MAX_TEXT_LENGTH];
+            EXPECT_THAT(s.format(text, sizeof(text)), testing::HasSubstr(std::to_string(mode_val)));
         }));
 
     // Test from each valid mode to the invalid mode
@@ -1012,7 +1033,8 @@ TEST_F(WoleixStateManagerTest, TransitionFromInvalidModeHandling)
         {
             EXPECT_EQ(s.get_severity(), WoleixStatus::Severity::WX_SEVERITY_ERROR);
             EXPECT_EQ(s.get_category(), WoleixCategory::StateManager::WX_CATEGORY_INVALID_MODE);
-            EXPECT_THAT(s.get_message().c_str(), testing::HasSubstr(std::to_string(mode_val)));
+            char text[WoleixStatus::MAX_TEXT_LENGTH];
+            EXPECT_THAT(s.format(text, sizeof(text)), testing::HasSubstr(std::to_string(mode_val)));
         }));
 
     // Test from each valid mode to the invalid mode
@@ -1056,6 +1078,218 @@ TEST_F(WoleixStateManagerTest, TemperatureRoundingHandled)
     EXPECT_EQ(count_command(queue, TEMP_UP_COMMAND), 3);
 }
 
+// ============================================================================
+// Test: Single-Step Planning
+// ============================================================================
+
+/**
+ * Test: next_command() is empty once the target is reached
+ */
+TEST_F(WoleixStateManagerTest, NextCommandEmptyWhenTargetReached)
+{
+    WoleixInternalState state(WoleixPowerState::ON, WoleixMode::FAN, 25.0f, WoleixFanSpeed::HIGH);
+
+    EXPECT_FALSE(WoleixStateManager::next_command(state, state).has_value());
+
+    // Temperature and fan speed are irrelevant while the unit is OFF
+    WoleixInternalState off(WoleixPowerState::OFF, WoleixMode::COOL, 25.0f, WoleixFanSpeed::LOW);
+    WoleixInternalState off_target(WoleixPowerState::OFF, WoleixMode::FAN, 18.0f, WoleixFanSpeed::HIGH);
+    EXPECT_FALSE(WoleixStateManager::next_command(off, off_target).has_value());
+}
+
+/**
+ * Test: Stepping with next_command()/apply() reproduces move_to()
+ * 
+ * OFF/COOL/25 -> ON/COOL/28: POWER, then three TEMP_UP presses.
+ */
+TEST_F(WoleixStateManagerTest, NextCommandAndApplyReproduceMoveTo)
+{
+    WoleixInternalState from = mock_state_manager->get_state();
+    WoleixInternalState target(WoleixPowerState::ON, WoleixMode::COOL, 27.5f, WoleixFanSpeed::LOW);
+
+    const std::vector<WoleixCommand>& queue = mock_state_manager->move_to(target);
+
+    std::vector<WoleixCommand::Type> stepped;
+    while (auto type = WoleixStateManager::next_command(from, mock_state_manager->get_state()))
+    {
+        stepped.push_back(type.value());
+        WoleixStateManager::apply(from, type.value());
+    }
+
+    ASSERT_EQ(stepped.size(), queue.size());
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+        EXPECT_EQ(stepped[i], queue[i].get_type());
+    }
+    EXPECT_TRUE(from == mock_state_manager->get_state());
+}
+
+/**
+ * Test: apply() ignores buttons other than POWER while the unit is OFF
+ */
+TEST_F(WoleixStateManagerTest, ApplyIgnoresButtonsWhileOff)
+{
+    WoleixInternalState state(WoleixPowerState::OFF, WoleixMode::COOL, 25.0f, WoleixFanSpeed::LOW);
+
+    WoleixStateManager::apply(state, MODE_COMMAND);
+    WoleixStateManager::apply(state, TEMP_UP_COMMAND);
+    WoleixStateManager::apply(state, SPEED_COMMAND);
+
+    EXPECT_EQ(state.mode, WoleixMode::COOL);
+    EXPECT_FLOAT_EQ(state.temperature, 25.0f);
+    EXPECT_EQ(state.fan_speed, WoleixFanSpeed::LOW);
+
+    WoleixStateManager::apply(state, POWER_COMMAND);
+    EXPECT_EQ(state.power, WoleixPowerState::ON);
+}
+
+// ============================================================================
+// Test: Priorities and Transmitted State
+// ============================================================================
+
+/**
+ * Test: Turning the unit off is tagged high priority, other changes are not
+ */
+TEST_F(WoleixStateManagerTest, PowerOffCommandsAreHighPriority)
+{
+    mock_state_manager->set_current_state(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 25.0f, WoleixFanSpeed::LOW));
+
+    auto queue = mock_state_manager->move_to(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 27.0f, WoleixFanSpeed::LOW));
+    ASSERT_EQ(queue.size(), 2u);
+    for (const auto& cmd : queue)
+    {
+        EXPECT_EQ(cmd.get_priority(), WoleixCommand::Priority::NORMAL);
+    }
+
+    queue = mock_state_manager->move_to(WoleixInternalState(WoleixPowerState::OFF, WoleixMode::COOL, 27.0f, WoleixFanSpeed::LOW));
+    ASSERT_EQ(queue.size(), 1u);
+    EXPECT_EQ(queue[0].get_type(), POWER_COMMAND);
+    EXPECT_EQ(queue[0].get_priority(), WoleixCommand::Priority::HIGH);
+
+    // Turning on again is a regular change
+    queue = mock_state_manager->move_to(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 27.0f, WoleixFanSpeed::LOW));
+    ASSERT_FALSE(queue.empty());
+    EXPECT_EQ(queue[0].get_priority(), WoleixCommand::Priority::NORMAL);
+}
+
+/**
+ * Test: The transmitted state follows reported presses, not generated commands
+ */
+TEST_F(WoleixStateManagerTest, TransmittedStateAdvancesOnTransmission)
+{
+    mock_state_manager->move_to(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 28.0f, WoleixFanSpeed::LOW));
+    EXPECT_EQ(mock_state_manager->get_transmitted_state().power, WoleixPowerState::OFF);
+    EXPECT_FLOAT_EQ(mock_state_manager->get_transmitted_state().temperature, 25.0f);
+
+    mock_state_manager->on_command_transmitted(POWER_COMMAND);
+    mock_state_manager->on_command_transmitted(TEMP_UP_COMMAND, 2);
+    EXPECT_EQ(mock_state_manager->get_transmitted_state().power, WoleixPowerState::ON);
+    EXPECT_FLOAT_EQ(mock_state_manager->get_transmitted_state().temperature, 27.0f);
+    EXPECT_FLOAT_EQ(mock_state_manager->get_state().temperature, 28.0f);
+}
+
+/**
+ * Test: After rebasing, move_to() plans from the transmitted state
+ */
+TEST_F(WoleixStateManagerTest, RebaseOnTransmittedReplansFromTransmittedState)
+{
+    mock_state_manager->move_to(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 30.0f, WoleixFanSpeed::LOW));
+    mock_state_manager->on_command_transmitted(POWER_COMMAND);
+    mock_state_manager->on_command_transmitted(TEMP_UP_COMMAND);
+
+    mock_state_manager->rebase_on_transmitted();
+    EXPECT_FLOAT_EQ(mock_state_manager->get_state().temperature, 26.0f);
+
+    auto queue = mock_state_manager->move_to(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 24.0f, WoleixFanSpeed::LOW));
+    EXPECT_EQ(count_command(queue, TEMP_DOWN_COMMAND), 2);
+    EXPECT_EQ(count_command(queue, TEMP_UP_COMMAND), 0);
+}
+
+/**
+ * Test: Desired, planned and transmitted states are tracked separately
+ */
+TEST_F(WoleixStateManagerTest, TracksDesiredPlannedAndTransmittedStates)
+{
+    WoleixInternalState target(WoleixPowerState::ON, WoleixMode::COOL, 33.0f, WoleixFanSpeed::LOW);
+
+    mock_state_manager->move_to(target);
+
+    EXPECT_TRUE(mock_state_manager->get_desired_state() == target);
+    EXPECT_FLOAT_EQ(mock_state_manager->get_planned_state().temperature, 30.0f);
+    EXPECT_EQ(mock_state_manager->get_transmitted_state().power, WoleixPowerState::OFF);
+
+    mock_state_manager->reset();
+    EXPECT_TRUE(mock_state_manager->get_desired_state() == WoleixInternalState());
+    EXPECT_TRUE(mock_state_manager->get_planned_state() == WoleixInternalState());
+    EXPECT_TRUE(mock_state_manager->get_transmitted_state() == WoleixInternalState());
+}
+
+/**
+ * Test: A press on the physical remote moves every tracked state
+ */
+TEST_F(WoleixStateManagerTest, RemotePressMovesAllStates)
+{
+    mock_state_manager->on_command_transmitted(POWER_COMMAND);
+    mock_state_manager->rebase_on_transmitted();
+
+    mock_state_manager->on_remote_press(MODE_COMMAND);
+
+    WoleixInternalState expected(WoleixPowerState::ON, WoleixMode::DEHUM, 25.0f, WoleixFanSpeed::LOW);
+    EXPECT_TRUE(mock_state_manager->get_transmitted_state() == expected);
+    EXPECT_TRUE(mock_state_manager->get_planned_state() == expected);
+    EXPECT_TRUE(mock_state_manager->get_desired_state() == expected);
+
+    auto queue = mock_state_manager->move_to(expected);
+    EXPECT_TRUE(queue.empty());
+}
+
+/**
+ * Test: Commands staying queued are replayed onto the rebased state
+ */
+TEST_F(WoleixStateManagerTest, ReplayPendingAppliesRepeatCount)
+{
+    mock_state_manager->move_to(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 25.0f, WoleixFanSpeed::LOW));
+    mock_state_manager->rebase_on_transmitted();
+    ASSERT_EQ(mock_state_manager->get_state().power, WoleixPowerState::OFF);
+
+    mock_state_manager->replay_pending(WoleixCommand(POWER_COMMAND, ADDRESS_NEC));
+    mock_state_manager->replay_pending(WoleixCommand(MODE_COMMAND, ADDRESS_NEC, 0, 2));
+
+    EXPECT_EQ(mock_state_manager->get_state().power, WoleixPowerState::ON);
+    EXPECT_EQ(mock_state_manager->get_state().mode, WoleixMode::FAN);
+}
+
+/**
+ * Test: move_to() with a sink emits the same commands as move_to() without
+ */
+TEST_F(WoleixStateManagerTest, MoveToSinkEmitsPlannedCommands)
+{
+    RecordingSink sink;
+    WoleixInternalState target(WoleixPowerState::ON, WoleixMode::FAN, 25.0f, WoleixFanSpeed::HIGH);
+
+    EXPECT_TRUE(mock_state_manager->move_to(target, sink));
+
+    std::vector<WoleixCommand::Type> expected = { POWER_COMMAND, MODE_COMMAND, MODE_COMMAND, SPEED_COMMAND };
+    EXPECT_EQ(sink.types, expected);
+    EXPECT_EQ(sink.commits, 1);
+    EXPECT_EQ(mock_state_manager->get_state().mode, WoleixMode::FAN);
+}
+
+/**
+ * Test: A plan rejected by the sink leaves the planned and desired states unchanged
+ */
+TEST_F(WoleixStateManagerTest, MoveToSinkRollsBackRejectedPlan)
+{
+    RecordingSink sink;
+    sink.accept = false;
+    WoleixInternalState before = mock_state_manager->get_state();
+
+    EXPECT_FALSE(mock_state_manager->move_to(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 28.0f, WoleixFanSpeed::LOW), sink));
+
+    EXPECT_TRUE(mock_state_manager->get_planned_state() == before);
+    EXPECT_TRUE(mock_state_manager->get_desired_state() == before);
+}
+
 // ============================================================================
 // Main
 // ============================================================================
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <cstring>
+#include <type_traits>
 
 #include "woleix_status.h"
 
@@ -10,6 +12,19 @@ using testing::Return;
 using testing::AtLeast;
 using testing::Invoke;
 
+// Test message catalogue
+namespace TestMessages
+{
+    inline constexpr auto CATEGORY_1 = Category::make(1, 2, "TestCategory1");
+    inline constexpr auto CATEGORY_2 = Category::make(1, 3, "TestCategory2");
+
+    inline constexpr WoleixMessage ERROR_1{ WoleixSeverity::WX_SEVERITY_ERROR, CATEGORY_1, "Message 1" };
+    inline constexpr WoleixMessage ERROR_1_AGAIN{ WoleixSeverity::WX_SEVERITY_ERROR, CATEGORY_1, "Message 2" };
+    inline constexpr WoleixMessage WARNING_1{ WoleixSeverity::WX_SEVERITY_WARNING, CATEGORY_1, "Message 1" };
+    inline constexpr WoleixMessage ERROR_2{ WoleixSeverity::WX_SEVERITY_ERROR, CATEGORY_2, "Message 1" };
+    inline constexpr WoleixMessage WITH_ARGS{ WoleixSeverity::WX_SEVERITY_INFO, CATEGORY_2, "from=%d, to=%d, 100%%" };
+}
+
 // Test Category Creation and Comparison
 TEST(WoleixStatusTest, CategoryCreationAndComparison)
 {
@@ -31,24 +46,23 @@ TEST(WoleixStatusTest, CategoryCreationAndComparison)
 // Test WoleixStatus Construction and Accessors
 TEST(WoleixStatusTest, ConstructionAndAccessors)
 {
-    auto category = Category::make(1, 2, "TestCategory");
-    WoleixStatus status(WoleixStatus::Severity::WX_SEVERITY_ERROR, category, "Test message");
+    WoleixStatus status(TestMessages::ERROR_1);
 
     EXPECT_EQ(status.get_severity(), WoleixStatus::Severity::WX_SEVERITY_ERROR);
-    EXPECT_EQ(status.get_category(), category);
-    EXPECT_EQ(status.get_message(), "Test message");
+    EXPECT_EQ(status.get_category(), TestMessages::CATEGORY_1);
+    EXPECT_EQ(&status.get_message(), &TestMessages::ERROR_1);
+
+    char text[WoleixStatus::MAX_TEXT_LENGTH];
+    EXPECT_STREQ(status.format(text, sizeof(text)), "Message 1");
 }
 
 // Test WoleixStatus Equality
 TEST(WoleixStatusTest, Equality)
 {
-    auto category1 = Category::make(1, 2, "TestCategory1");
-    auto category2 = Category::make(1, 3, "TestCategory2");
-
-    WoleixStatus status1(WoleixStatus::Severity::WX_SEVERITY_ERROR, category1, "Message 1");
-    WoleixStatus status2(WoleixStatus::Severity::WX_SEVERITY_ERROR, category1, "Message 2");
-    WoleixStatus status3(WoleixStatus::Severity::WX_SEVERITY_WARNING, category1, "Message 1");
-    WoleixStatus status4(WoleixStatus::Severity::WX_SEVERITY_ERROR, category2, "Message 1");
+    WoleixStatus status1(TestMessages::ERROR_1);
+    WoleixStatus status2(TestMessages::ERROR_1_AGAIN);
+    WoleixStatus status3(TestMessages::WARNING_1);
+    WoleixStatus status4(TestMessages::ERROR_2);
 
     EXPECT_EQ(status1, status2);  // Same severity and category, different message
     EXPECT_NE(status1, status3);  // Different severity
@@ -66,12 +80,21 @@ namespace NewCategoryId
 // Test Category Extensibility
 TEST(WoleixStatusTest, CategoryExtensibility)
 {
-
-    auto new_category1 = Category::make(NewCategoryId::NewModule, NewCategoryId::NewLocal1, "NewCategory1");
-    auto new_category2 = Category::make(NewCategoryId::NewModule, NewCategoryId::NewLocal2, "NewCategory2");
-
-    WoleixStatus status1(WoleixStatus::Severity::WX_SEVERITY_INFO, new_category1, "New category test 1");
-    WoleixStatus status2(WoleixStatus::Severity::WX_SEVERITY_DEBUG, new_category2, "New category test 2");
+    static constexpr WoleixMessage MESSAGE_1
+    {
+        WoleixSeverity::WX_SEVERITY_INFO,
+        Category::make(NewCategoryId::NewModule, NewCategoryId::NewLocal1, "NewCategory1"),
+        "New category test 1"
+    };
+    static constexpr WoleixMessage MESSAGE_2
+    {
+        WoleixSeverity::WX_SEVERITY_DEBUG,
+        Category::make(NewCategoryId::NewModule, NewCategoryId::NewLocal2, "NewCategory2"),
+        "New category test 2"
+    };
+
+    WoleixStatus status1(MESSAGE_1);
+    WoleixStatus status2(MESSAGE_2);
 
     EXPECT_NE(status1, status2);
     EXPECT_EQ(status1.get_category().module_id(), NewCategoryId::NewModule);
@@ -83,12 +106,16 @@ TEST(WoleixStatusTest, CategoryExtensibility)
 // Test Severity Enum
 TEST(WoleixStatusTest, SeverityEnum)
 {
-    auto category = Category::make(1, 1, "TestCategory");
+    static constexpr auto CATEGORY = Category::make(1, 1, "TestCategory");
+    static constexpr WoleixMessage ERROR{ WoleixSeverity::WX_SEVERITY_ERROR, CATEGORY, "Error" };
+    static constexpr WoleixMessage WARNING{ WoleixSeverity::WX_SEVERITY_WARNING, CATEGORY, "Warning" };
+    static constexpr WoleixMessage INFO{ WoleixSeverity::WX_SEVERITY_INFO, CATEGORY, "Info" };
+    static constexpr WoleixMessage DEBUG{ WoleixSeverity::WX_SEVERITY_DEBUG, CATEGORY, "Debug" };
 
-    WoleixStatus error_status(WoleixStatus::Severity::WX_SEVERITY_ERROR, category, "Error");
-    WoleixStatus warning_status(WoleixStatus::Severity::WX_SEVERITY_WARNING, category, "Warning");
-    WoleixStatus info_status(WoleixStatus::Severity::WX_SEVERITY_INFO, category, "Info");
-    WoleixStatus debug_status(WoleixStatus::Severity::WX_SEVERITY_DEBUG, category, "Debug");
+    WoleixStatus error_status(ERROR);
+    WoleixStatus warning_status(WARNING);
+    WoleixStatus info_status(INFO);
+    WoleixStatus debug_status(DEBUG);
 
     EXPECT_EQ(error_status.get_severity(), WoleixStatus::Severity::WX_SEVERITY_ERROR);
     EXPECT_EQ(warning_status.get_severity(), WoleixStatus::Severity::WX_SEVERITY_WARNING);
@@ -100,6 +127,34 @@ TEST(WoleixStatusTest, SeverityEnum)
     EXPECT_NE(info_status, debug_status);
 }
 
+// Test integer arguments and rendering
+TEST(WoleixStatusTest, FormatsIntegerArguments)
+{
+    WoleixStatus status(TestMessages::WITH_ARGS, 3, -1);
+
+    EXPECT_EQ(status.get_arg(0), 3);
+    EXPECT_EQ(status.get_arg(1), -1);
+
+    char text[WoleixStatus::MAX_TEXT_LENGTH];
+    EXPECT_STREQ(status.format(text, sizeof(text)), "from=3, to=-1, 100%");
+
+    // Truncated, but always terminated
+    char small[8];
+    EXPECT_STREQ(status.format(small, sizeof(small)), "from=3,");
+}
+
+// A status is a plain value: reporting it never allocates
+TEST(WoleixStatusTest, StatusIsTriviallyCopyable)
+{
+    static_assert(std::is_trivially_copyable_v<WoleixStatus>);
+    static_assert(std::is_trivially_destructible_v<WoleixStatus>);
+    static_assert(sizeof(WoleixStatus) <= sizeof(void*) + WoleixMessage::MAX_ARGS * sizeof(int));
+
+    constexpr WoleixStatus status(TestMessages::ERROR_1, 1, 2);
+    static_assert(status.get_severity() == WoleixSeverity::WX_SEVERITY_ERROR);
+    static_assert(status.get_arg(1) == 2);
+}
+
 // Mock classes for WoleixListener and WoleixReporter
 class MockWoleixStatusObserver : public WoleixStatusObserver
 {
@@ -107,33 +162,68 @@ public:
     MOCK_METHOD(void, observe, (const WoleixStatusReporter&, const WoleixStatus&), (override));
 };
 
-class MockWoleixStatusReporter : public WoleixStatusReporter
+class TestWoleixStatusReporter : public WoleixStatusReporter
 {
-public:
-    MOCK_METHOD(void, register_observer, (WoleixStatusObserver*), (override));
-    MOCK_METHOD(void, unregister_observer, (WoleixStatusObserver*), (override));
 };
 
 // Test WoleixStatusObserver and WoleixStatusReporter
 TEST(WoleixStatusTest, StatusObserverAndStatusReporter)
 {
-    MockWoleixStatusReporter reporter;
+    WoleixStatusBus bus;
+    TestWoleixStatusReporter reporter;
     MockWoleixStatusObserver observer1, observer2;
 
-    EXPECT_CALL(reporter, register_observer(&observer1));
-    EXPECT_CALL(reporter, register_observer(&observer2));
-    EXPECT_CALL(reporter, unregister_observer(&observer1));
+    reporter.set_status_bus(&bus);
+    EXPECT_TRUE(bus.subscribe(&observer1));
+    EXPECT_TRUE(bus.subscribe(&observer2));
+    bus.unsubscribe(&observer1);
+    EXPECT_EQ(bus.observer_count(), 1u);
 
-    reporter.register_observer(&observer1);
-    reporter.register_observer(&observer2);
-    reporter.unregister_observer(&observer1);
-
-    auto category = Category::make(1, 1, "TestCategory");
-    WoleixStatus status(WoleixStatus::Severity::WX_SEVERITY_INFO, category, "Test notification");
+    WoleixStatus status(TestMessages::ERROR_1);
 
+    EXPECT_CALL(observer1, observe(_, _)).Times(0);
     EXPECT_CALL(observer2, observe(testing::Ref(reporter), testing::Eq(status)));
 
-    observer2.observe(reporter, status);
+    reporter.report(status);
+}
+
+// Test several reporters sharing one bus
+TEST(WoleixStatusTest, ReportersShareOneBus)
+{
+    WoleixStatusBus bus;
+    TestWoleixStatusReporter reporter1, reporter2;
+    MockWoleixStatusObserver observer;
+
+    reporter1.set_status_bus(&bus);
+    reporter2.set_status_bus(&bus);
+    bus.subscribe(&observer);
+
+    EXPECT_CALL(observer, observe(testing::Ref(reporter1), _));
+    EXPECT_CALL(observer, observe(testing::Ref(reporter2), _));
+
+    reporter1.report(WoleixStatus(TestMessages::ERROR_1));
+    reporter2.report(WoleixStatus(TestMessages::ERROR_2));
+}
+
+// Test the fixed observer capacity and detached reporters
+TEST(WoleixStatusTest, BusCapacityIsFixed)
+{
+    WoleixStatusBus bus;
+    MockWoleixStatusObserver observers[WoleixStatusBus::MAX_OBSERVERS + 1];
+
+    for (size_t i = 0; i < WoleixStatusBus::MAX_OBSERVERS; i++)
+    {
+        EXPECT_TRUE(bus.subscribe(&observers[i]));
+    }
+    EXPECT_FALSE(bus.subscribe(&observers[WoleixStatusBus::MAX_OBSERVERS]));
+
+    // Unsubscribing an unknown observer changes nothing
+    bus.unsubscribe(&observers[WoleixStatusBus::MAX_OBSERVERS]);
+    EXPECT_EQ(bus.observer_count(), WoleixStatusBus::MAX_OBSERVERS);
+
+    // Without a bus, statuses are dropped
+    TestWoleixStatusReporter reporter;
+    EXPECT_NO_THROW(reporter.report(WoleixStatus(TestMessages::ERROR_1)));
 }
 
 int main(int argc, char **argv)
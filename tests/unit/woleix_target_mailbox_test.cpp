@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <vector>
+
+#include "woleix_constants.h"
+#include "woleix_command.h"
+#include "woleix_state_manager.h"
+#include "woleix_target_mailbox.h"
+
+using namespace esphome::climate_ir_woleix;
+
+using ::testing::_;
+
+// Consumer notification tests
+class MockWoleixCommandQueueConsumer : public WoleixCommandQueueConsumer
+{
+public:
+    MOCK_METHOD(void, on_command_enqueued, (), (override));
+};
+
+class WoleixTargetMailboxTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        mailbox.reset(state_manager.get_state());
+        mailbox.register_consumer(&mock_consumer);
+    }
+
+    void TearDown() override
+    {
+        mailbox.unregister_consumer(&mock_consumer);
+    }
+
+    // Resolve a target the way WoleixClimate does and hand it to the mailbox
+    void post(const WoleixInternalState& target)
+    {
+        state_manager.move_to(target);
+        mailbox.post(state_manager.get_state());
+    }
+
+    // Drain the mailbox, collecting the planned command types
+    std::vector<WoleixCommand::Type> drain()
+    {
+        std::vector<WoleixCommand::Type> types;
+        while (!mailbox.is_empty())
+        {
+            types.push_back(mailbox.get().value().get_type());
+            mailbox.dequeue();
+        }
+        return types;
+    }
+
+    WoleixStateManager state_manager;
+    WoleixTargetMailbox mailbox;
+    testing::NiceMock<MockWoleixCommandQueueConsumer> mock_consumer;
+};
+
+TEST_F(WoleixTargetMailboxTest, StartsEmpty)
+{
+    EXPECT_TRUE(mailbox.is_empty());
+    EXPECT_FALSE(mailbox.get().has_value());
+    EXPECT_FALSE(mailbox.dequeue());
+}
+
+TEST_F(WoleixTargetMailboxTest, PostNotifiesConsumerOnce)
+{
+    EXPECT_CALL(mock_consumer, on_command_enqueued()).Times(1);
+
+    post(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 25.0f, WoleixFanSpeed::LOW));
+    post(WoleixInternalState(WoleixPowerState::ON, WoleixMode::FAN, 25.0f, WoleixFanSpeed::HIGH));
+}
+
+TEST_F(WoleixTargetMailboxTest, PostingCurrentStateDoesNotNotify)
+{
+    EXPECT_CALL(mock_consumer, on_command_enqueued()).Times(0);
+
+    mailbox.post(mailbox.get_transmitted());
+
+    EXPECT_TRUE(mailbox.is_empty());
+}
+
+TEST_F(WoleixTargetMailboxTest, PlansSameCommandsAsMoveTo)
+{
+    mailbox.reset(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 20.0f, WoleixFanSpeed::LOW));
+    WoleixStateManager reference;
+    reference.move_to(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 20.0f, WoleixFanSpeed::LOW));
+
+    const std::vector<WoleixInternalState> targets =
+    {
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 24.0f, WoleixFanSpeed::LOW),
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::FAN, 24.0f, WoleixFanSpeed::HIGH),
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::DEHUM, 24.0f, WoleixFanSpeed::HIGH),
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 17.5f, WoleixFanSpeed::HIGH),
+        WoleixInternalState(WoleixPowerState::OFF, WoleixMode::COOL, 17.5f, WoleixFanSpeed::HIGH),
+        WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 35.0f, WoleixFanSpeed::LOW),
+    };
+
+    for (const auto& target : targets)
+    {
+        std::vector<WoleixCommand::Type> expected;
+        for (const auto& cmd : reference.move_to(target))
+        {
+            expected.push_back(cmd.get_type());
+        }
+        mailbox.post(reference.get_state());
+
+        EXPECT_EQ(drain(), expected);
+    }
+}
+
+TEST_F(WoleixTargetMailboxTest, LastWriterWins)
+{
+    mailbox.reset(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 20.0f, WoleixFanSpeed::LOW));
+    state_manager.move_to(mailbox.get_transmitted());
+
+    post(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 30.0f, WoleixFanSpeed::LOW));
+    mailbox.dequeue();
+    mailbox.dequeue();
+    post(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 21.0f, WoleixFanSpeed::LOW));
+
+    // At 22°C already, one step back is all that is left
+    EXPECT_EQ(drain(), std::vector<WoleixCommand::Type>{ WoleixCommand::Type::TEMP_DOWN });
+    EXPECT_FLOAT_EQ(mailbox.get_transmitted().temperature, 21.0f);
+}
+
+TEST_F(WoleixTargetMailboxTest, ResetDropsPendingTarget)
+{
+    post(WoleixInternalState(WoleixPowerState::ON, WoleixMode::FAN, 25.0f, WoleixFanSpeed::HIGH));
+    ASSERT_FALSE(mailbox.is_empty());
+
+    mailbox.reset(WoleixInternalState());
+
+    EXPECT_TRUE(mailbox.is_empty());
+}
+
+TEST_F(WoleixTargetMailboxTest, UsesConfiguredAddress)
+{
+    WoleixTargetMailbox other(0x1234);
+    other.post(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 25.0f, WoleixFanSpeed::LOW));
+
+    ASSERT_TRUE(other.get().has_value());
+    EXPECT_EQ(other.get().value().get_address(), 0x1234);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "woleix_constants.h"
+#include "woleix_command.h"
+#include "woleix_protocol_handler.h"
+#include "woleix_path_planner.h"
+
+#include "mock_scheduler.h"
+#include "mock_queue.h"
+
+// Built with a custom timing profile, as emitted by the `timing:` YAML block
+// (see the compile definitions of this target in CMakeLists.txt)
+
+using namespace esphome::climate_ir_woleix;
+using namespace esphome::remote_base;
+
+using Type = WoleixCommand::Type;
+
+class TimingProfileHandler : public WoleixProtocolHandler
+{
+public:
+    TimingProfileHandler(RemoteTransmitterBase* transmitter, MockWoleixCommandQueue* command_queue, MockScheduler* scheduler)
+        : WoleixProtocolHandler(scheduler)
+    {
+        set_transmitter(transmitter);
+        setup(command_queue);
+    }
+
+    MOCK_METHOD(void, report, (const WoleixStatus&));
+};
+
+class TimingProfileTest : public testing::Test
+{
+protected:
+    TimingProfileTest()
+      : handler(&transmitter, &queue, &scheduler)
+    {}
+
+    void enqueue(Type type) { queue.enqueue(WoleixCommand(type, ADDRESS_NEC)); }
+
+    MockScheduler scheduler;
+    RemoteTransmitterBase transmitter;
+    MockWoleixCommandQueue queue;
+    TimingProfileHandler handler;
+};
+
+// ============================================================================
+// Test: Compile-time Constants
+// ============================================================================
+
+TEST(TimingProfileConstantsTest, DefinesOverrideDefaults)
+{
+    static_assert(TEMP_SETTING_MODE_TIMEOUT_MS == 4000);
+    static_assert(TEMP_ENTER_DELAY_MS == 90);
+    static_assert(INTER_COMMAND_DELAY_MS == 120);
+    static_assert(command_gap_ms(POWER_NEC) == 300);
+    SUCCEED();
+}
+
+TEST(TimingProfileConstantsTest, UnsetGapsFallBackToCommandGap)
+{
+    static_assert(command_gap_ms(MODE_NEC) == INTER_COMMAND_DELAY_MS);
+    static_assert(command_gap_ms(TEMP_UP_NEC) == INTER_COMMAND_DELAY_MS);
+    static_assert(command_gap_ms(TIMER_NEC) == INTER_COMMAND_DELAY_MS);
+    static_assert(burst_send_wait_us(TEMP_UP_NEC) == (120 - NEC_FRAME_DURATION_MS) * 1000);
+    SUCCEED();
+}
+
+TEST(TimingProfileConstantsTest, PlannerUsesPerCommandGaps)
+{
+    EXPECT_EQ(WoleixPathPlanner::press_cost_ms(Type::POWER), NEC_FRAME_DURATION_MS + 300);
+    EXPECT_EQ(WoleixPathPlanner::press_cost_ms(Type::MODE), NEC_FRAME_DURATION_MS + 120);
+}
+
+// ============================================================================
+// Test: Protocol Handler
+// ============================================================================
+
+TEST_F(TimingProfileTest, UsesPerCommandGap)
+{
+    enqueue(Type::POWER);
+    enqueue(Type::MODE);
+
+    scheduler.fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    EXPECT_EQ(scheduler.time_until(WoleixTimerId::NEXT_COMMAND), 300u);
+
+    scheduler.fire_timeout(WoleixTimerId::NEXT_COMMAND);
+    EXPECT_EQ(scheduler.time_until(WoleixTimerId::NEXT_COMMAND), 120u);
+}
+
+TEST_F(TimingProfileTest, UsesSettingModeTiming)
+{
+    enqueue(Type::TEMP_UP);
+
+    scheduler.fire_timeout(WoleixTimerId::NEXT_COMMAND);
+
+    EXPECT_EQ(scheduler.time_until(WoleixTimerId::NEXT_COMMAND), 90u);
+    EXPECT_EQ(scheduler.time_until(WoleixTimerId::SETTING_MODE), 4000u);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <vector>
+
+#include "woleix_constants.h"
+#include "woleix_command.h"
+#include "woleix_state_manager.h"
+#include "woleix_transition_table.h"
+
+using namespace esphome::climate_ir_woleix;
+
+using Type = WoleixCommand::Type;
+
+// State manager exposing the step-by-step reference implementation
+class TestWoleixStateManager : public WoleixStateManager
+{
+public:
+    explicit TestWoleixStateManager(const WoleixInternalState& state) { current_state_ = state; }
+
+    const std::vector<WoleixCommand>& move_incrementally(const WoleixInternalState& target)
+    {
+        commands_.clear();
+        generate_commands_incrementally_(target);
+        return commands_;
+    }
+};
+
+static std::vector<Type> types_of(const std::vector<WoleixCommand>& commands)
+{
+    std::vector<Type> types;
+    for (const auto& cmd : commands) types.push_back(cmd.get_type());
+    return types;
+}
+
+// ============================================================================
+// Test: Packing
+// ============================================================================
+
+TEST(WoleixTransitionTableTest, PackUnpackRoundTrip)
+{
+    for (size_t i = 0; i < WoleixTransitionTable::STATE_COUNT; i++)
+    {
+        auto packed = static_cast<WoleixPackedState>(i);
+        auto repacked = WoleixTransitionTable::pack(WoleixTransitionTable::unpack(packed));
+
+        ASSERT_TRUE(repacked.has_value());
+        EXPECT_EQ(repacked.value(), packed);
+    }
+}
+
+TEST(WoleixTransitionTableTest, PackRejectsStatesOutsideTable)
+{
+    EXPECT_FALSE(WoleixTransitionTable::pack(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 22.5f, WoleixFanSpeed::LOW)).has_value());
+    EXPECT_FALSE(WoleixTransitionTable::pack(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 31.0f, WoleixFanSpeed::LOW)).has_value());
+    EXPECT_FALSE(WoleixTransitionTable::pack(WoleixInternalState(WoleixPowerState::ON, static_cast<WoleixMode>(99), 25.0f, WoleixFanSpeed::LOW)).has_value());
+}
+
+TEST(WoleixTransitionTableTest, DescriptorEncoding)
+{
+    auto from = WoleixTransitionTable::pack(WoleixPowerState::OFF, WoleixMode::DEHUM, 10, WoleixFanSpeed::LOW);
+    auto cool = WoleixTransitionTable::pack(WoleixPowerState::ON, WoleixMode::COOL, 7, WoleixFanSpeed::LOW);
+    auto fan = WoleixTransitionTable::pack(WoleixPowerState::ON, WoleixMode::FAN, 10, WoleixFanSpeed::HIGH);
+
+    uint8_t to_cool = WoleixTransitionTable::lookup(from, cool);
+    EXPECT_TRUE(WoleixTransitionTable::toggles_power(to_cool));
+    EXPECT_EQ(WoleixTransitionTable::mode_steps(to_cool), 2);
+    EXPECT_EQ(WoleixTransitionTable::temp_steps(to_cool), -3);
+    EXPECT_FALSE(WoleixTransitionTable::toggles_fan(to_cool));
+
+    uint8_t to_fan = WoleixTransitionTable::lookup(from, fan);
+    EXPECT_EQ(WoleixTransitionTable::mode_steps(to_fan), 1);
+    EXPECT_EQ(WoleixTransitionTable::temp_steps(to_fan), 0);
+    EXPECT_TRUE(WoleixTransitionTable::toggles_fan(to_fan));
+}
+
+TEST(WoleixTransitionTableTest, DescriptorCoversFullTemperatureRange)
+{
+    auto min = WoleixTransitionTable::pack(WoleixPowerState::ON, WoleixMode::COOL, 0, WoleixFanSpeed::LOW);
+    auto max = WoleixTransitionTable::pack(WoleixPowerState::ON, WoleixMode::COOL, 15, WoleixFanSpeed::LOW);
+
+    EXPECT_EQ(WoleixTransitionTable::temp_steps(WoleixTransitionTable::lookup(min, max)), 15);
+    EXPECT_EQ(WoleixTransitionTable::temp_steps(WoleixTransitionTable::lookup(max, min)), -15);
+}
+
+// ============================================================================
+// Test: Equivalence with move_to()
+// ============================================================================
+
+/**
+ * Test: The table reproduces the step-by-step move_to() for every state pair
+ *
+ * Covers all 192 packed start states against every target, including
+ * fractional and out-of-range target temperatures, comparing both the
+ * generated commands and the resulting state.
+ */
+TEST(WoleixTransitionTableTest, ExhaustivelyEquivalentToMoveTo)
+{
+    std::vector<float> temperatures = { 14.0f, 22.5f, 27.5f, 31.0f };
+    for (float temp = WOLEIX_TEMP_MIN; temp <= WOLEIX_TEMP_MAX; temp += 1.0f)
+    {
+        temperatures.push_back(temp);
+    }
+
+    size_t checked = 0;
+    for (size_t i = 0; i < WoleixTransitionTable::STATE_COUNT; i++)
+    {
+        WoleixInternalState from = WoleixTransitionTable::unpack(static_cast<WoleixPackedState>(i));
+
+        for (auto power : { WoleixPowerState::OFF, WoleixPowerState::ON })
+            for (auto mode : { WoleixMode::COOL, WoleixMode::DEHUM, WoleixMode::FAN })
+                for (float temp : temperatures)
+                    for (auto fan : { WoleixFanSpeed::LOW, WoleixFanSpeed::HIGH })
+                    {
+                        WoleixInternalState to(power, mode, temp, fan);
+
+                        TestWoleixStateManager table(from);
+                        TestWoleixStateManager reference(from);
+
+                        ASSERT_EQ(types_of(table.move_to(to)), types_of(reference.move_incrementally(to)));
+                        ASSERT_TRUE(table.get_state() == reference.get_state());
+                        checked++;
+                    }
+    }
+    EXPECT_EQ(checked, WoleixTransitionTable::STATE_COUNT * 2 * 3 * 20 * 2);
+}
+
+/**
+ * Test: States outside the table fall back to the step-by-step path
+ */
+TEST(WoleixTransitionTableTest, FallsBackForStatesOutsideTable)
+{
+    TestWoleixStateManager manager(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 25.5f, WoleixFanSpeed::LOW));
+
+    const auto& commands = manager.move_to(WoleixInternalState(WoleixPowerState::ON, WoleixMode::COOL, 23.5f, WoleixFanSpeed::LOW));
+
+    EXPECT_EQ(types_of(commands), (std::vector<Type>{ Type::TEMP_DOWN, Type::TEMP_DOWN }));
+    EXPECT_FLOAT_EQ(manager.get_state().temperature, 23.5f);
+}